@@ -0,0 +1,9 @@
+#include "AccelSensor.h"
+
+#include <SensorDrivers.h>
+
+bool accelSensorRead(HalI2c &i2c, int16_t raw[3]){
+  // the template driver on the virtual interface
+  Mpu6050Driver<HalI2c> driver(i2c);
+  return driver.readRaw(raw);
+}
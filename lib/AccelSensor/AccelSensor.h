@@ -0,0 +1,18 @@
+#pragma once
+
+#ifndef ACCEL_SENSOR_H
+#define ACCEL_SENSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <Hal.h>
+
+#define MPU6050_ADDRESS 0x68            // AD0 low
+#define MPU6050_ACCEL_XOUT_H 0x3B       // ax, ay, az, big endian, back to back
+#define MPU6050_ACCEL_LSB_PER_G 2048.0f // ±16 g range, set up by the MPU6050 library at boot
+
+/*  Raw acceleration in one burst read, same registers the MPU6050 library's getAcceleration() reads.
+ *  Mpu6050Driver in lib/SensorDrivers does the same without the virtual call  */
+bool accelSensorRead(HalI2c &i2c, int16_t raw[3]);
+
+#endif
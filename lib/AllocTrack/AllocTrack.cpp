@@ -0,0 +1,232 @@
+#include "AllocTrack.h"
+
+#include <string.h>
+
+uint8_t allocTrackByTask(const AllocSiteStats *sites, uint8_t siteCount, AllocTaskStats *tasks, uint8_t maxTasks){
+  uint8_t taskCount = 0;
+  for(uint8_t i = 0; i < siteCount; i++){
+    AllocTaskStats *task = NULL;
+    for(uint8_t j = 0; j < taskCount; j++){
+      if(strncmp(tasks[j].task, sites[i].task, ALLOC_TRACK_NAME_LENGTH) == 0){
+        task = &tasks[j];
+        break;
+      }
+    }
+    if(task == NULL){
+      if(taskCount == maxTasks){
+        continue;
+      }
+      task = &tasks[taskCount++];
+      memcpy(task->task, sites[i].task, ALLOC_TRACK_NAME_LENGTH);
+      task->allocations = 0;
+      task->bytes = 0;
+    }
+    task->allocations += sites[i].allocations;
+    task->bytes += sites[i].bytes;
+  }
+
+  for(uint8_t i = 1; i < taskCount; i++){
+    AllocTaskStats task = tasks[i];
+    uint8_t j = i;
+    for(; j > 0 && tasks[j - 1].bytes < task.bytes; j--){
+      tasks[j] = tasks[j - 1];
+    }
+    tasks[j] = task;
+  }
+  return taskCount;
+}
+
+#ifdef ALLOC_TRACK_ENABLE
+
+#include <Arduino.h>
+
+/*  The linker points every malloc call at __wrap_malloc and the real one at __real_malloc  */
+extern "C"{
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void __real_free(void *pointer);
+}
+
+typedef struct{
+  TaskHandle_t task;
+  const char *site;     // NULL: slot is free
+}SiteScope;
+
+/*  Everything below is guarded by lock. Nothing in here may allocate  */
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static AllocSiteStats sites[ALLOC_TRACK_MAX_SITES];
+static TaskHandle_t siteTasks[ALLOC_TRACK_MAX_SITES];
+static uint8_t siteCount = 0;
+static AllocTrackTotals totals;
+static uint32_t windowStartMs = 0;
+static SiteScope scopes[ALLOC_TRACK_MAX_SCOPES];
+
+// global constructors allocate before there is a current task
+static TaskHandle_t currentTask(){
+  return xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED ? NULL : xTaskGetCurrentTaskHandle();
+}
+
+static void book(void *pointer, size_t size, void *caller){
+  TaskHandle_t task = currentTask();
+
+  portENTER_CRITICAL(&lock);
+  if(pointer == NULL){
+    totals.failed++;
+    portEXIT_CRITICAL(&lock);
+    return;
+  }
+  totals.allocations++;
+  totals.bytes += size;
+
+  const char *site = NULL;
+  for(uint8_t i = 0; i < ALLOC_TRACK_MAX_SCOPES; i++){
+    if(scopes[i].site != NULL && scopes[i].task == task){
+      site = scopes[i].site;
+      caller = NULL;
+      break;
+    }
+  }
+
+  AllocSiteStats *entry = NULL;
+  for(uint8_t i = 0; i < siteCount; i++){
+    if(sites[i].site == site && sites[i].caller == caller && siteTasks[i] == task){
+      entry = &sites[i];
+      break;
+    }
+  }
+  if(entry == NULL && siteCount < ALLOC_TRACK_MAX_SITES){
+    siteTasks[siteCount] = task;
+    entry = &sites[siteCount++];
+    entry->site = site;
+    entry->caller = caller;
+    strlcpy(entry->task, task == NULL ? "init" : pcTaskGetName(task), sizeof(entry->task));
+    entry->allocations = 0;
+    entry->bytes = 0;
+  }
+  if(entry == NULL){
+    totals.overflow++;
+  }else{
+    entry->allocations++;
+    entry->bytes += size;
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+static void bookFree(){
+  portENTER_CRITICAL(&lock);
+  totals.frees++;
+  portEXIT_CRITICAL(&lock);
+}
+
+extern "C" void *__wrap_malloc(size_t size){
+  void *pointer = __real_malloc(size);
+  book(pointer, size, __builtin_return_address(0));
+  return pointer;
+}
+
+extern "C" void *__wrap_calloc(size_t count, size_t size){
+  void *pointer = __real_calloc(count, size);
+  book(pointer, count * size, __builtin_return_address(0));
+  return pointer;
+}
+
+// String grows through realloc, so every resize counts as an allocation of the new size
+extern "C" void *__wrap_realloc(void *pointer, size_t size){
+  void *resized = __real_realloc(pointer, size);
+  if(size > 0){
+    book(resized, size, __builtin_return_address(0));
+  }else if(pointer != NULL){
+    bookFree();
+  }
+  return resized;
+}
+
+extern "C" void __wrap_free(void *pointer){
+  __real_free(pointer);
+  if(pointer != NULL){
+    bookFree();
+  }
+}
+
+const char *allocSiteEnter(const char *name){
+  TaskHandle_t task = currentTask();
+  const char *previous = NULL;
+  SiteScope *slot = NULL;
+
+  portENTER_CRITICAL(&lock);
+  for(uint8_t i = 0; i < ALLOC_TRACK_MAX_SCOPES; i++){
+    if(scopes[i].site != NULL && scopes[i].task == task){
+      slot = &scopes[i];
+      previous = slot->site;
+      break;
+    }
+    if(scopes[i].site == NULL && slot == NULL){
+      slot = &scopes[i];
+    }
+  }
+  // no slot left: the allocations stay untagged
+  if(slot != NULL){
+    slot->task = task;
+    slot->site = name;
+  }
+  portEXIT_CRITICAL(&lock);
+  return previous;
+}
+
+void allocSiteLeave(const char *previous){
+  TaskHandle_t task = currentTask();
+
+  portENTER_CRITICAL(&lock);
+  for(uint8_t i = 0; i < ALLOC_TRACK_MAX_SCOPES; i++){
+    if(scopes[i].site != NULL && scopes[i].task == task){
+      scopes[i].site = previous;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+}
+
+uint8_t allocTrackSnapshot(AllocSiteStats *out, uint8_t maxSites, AllocTrackTotals *windowTotals, bool reset){
+  // one caller at a time, the stats report
+  static AllocSiteStats copy[ALLOC_TRACK_MAX_SITES];
+
+  portENTER_CRITICAL(&lock);
+  uint8_t count = siteCount;
+  memcpy(copy, sites, count * sizeof(AllocSiteStats));
+  *windowTotals = totals;
+  windowTotals->windowMs = millis() - windowStartMs;
+  if(reset){
+    siteCount = 0;
+    memset(&totals, 0, sizeof(totals));
+    windowStartMs = millis();
+  }
+  portEXIT_CRITICAL(&lock);
+
+  for(uint8_t i = 1; i < count; i++){
+    AllocSiteStats site = copy[i];
+    uint8_t j = i;
+    for(; j > 0 && copy[j - 1].bytes < site.bytes; j--){
+      copy[j] = copy[j - 1];
+    }
+    copy[j] = site;
+  }
+
+  if(count > maxSites){
+    count = maxSites;
+  }
+  memcpy(out, copy, count * sizeof(AllocSiteStats));
+  return count;
+}
+
+#else
+
+const char *allocSiteEnter(const char *name){ return NULL; }
+void allocSiteLeave(const char *previous){}
+
+uint8_t allocTrackSnapshot(AllocSiteStats *out, uint8_t maxSites, AllocTrackTotals *windowTotals, bool reset){
+  memset(windowTotals, 0, sizeof(*windowTotals));
+  return 0;
+}
+
+#endif
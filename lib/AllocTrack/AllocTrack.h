@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*  Counts heap allocations per call site and task, built only with -DALLOC_TRACK_ENABLE plus
+ *  -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free (the alloctrack environment in platformio.ini).
+ *  Without it ALLOC_SITE is empty and the functions report nothing.
+ *  Only malloc / calloc / realloc / free are seen: new, String and the C library go through them,
+ *  IDF code that calls heap_caps_malloc() directly does not  */
+#define ALLOC_TRACK_MAX_SITES 32      // distinct site / task pairs per window, the rest is counted as overflow
+#define ALLOC_TRACK_MAX_SCOPES 16     // tasks inside an ALLOC_SITE at once
+#define ALLOC_TRACK_NAME_LENGTH 16    // configMAX_TASK_NAME_LEN
+
+#ifdef ALLOC_TRACK_ENABLE
+
+/*  Allocations until the end of the enclosing block are booked on `name`, a string literal.
+ *  Untagged allocations are booked on the address that called malloc  */
+#define ALLOC_SITE(name) AllocSiteScope ALLOC_CONCAT(allocSite, __LINE__)(name)
+
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_CONCAT_INNER(a, b) a##b
+
+#else
+
+#define ALLOC_SITE(name) do{}while(0)
+
+#endif
+
+typedef struct{
+  const char *site;                     // ALLOC_SITE name, NULL when untagged
+  void *caller;                         // return address into the caller of malloc, when untagged
+  char task[ALLOC_TRACK_NAME_LENGTH];   // "init" before the scheduler started
+  uint32_t allocations;                 // reallocs count too
+  uint32_t bytes;
+}AllocSiteStats;
+
+typedef struct{
+  char task[ALLOC_TRACK_NAME_LENGTH];
+  uint32_t allocations;
+  uint32_t bytes;
+}AllocTaskStats;
+
+typedef struct{
+  uint32_t windowMs;
+  uint32_t allocations;
+  uint32_t bytes;
+  uint32_t frees;
+  uint32_t failed;          // malloc returned NULL
+  uint32_t overflow;        // allocations that found no free site slot
+}AllocTrackTotals;
+
+/*  Copies the window's sites, most bytes first, returns how many. reset starts a new window  */
+uint8_t allocTrackSnapshot(AllocSiteStats *sites, uint8_t maxSites, AllocTrackTotals *totals, bool reset);
+
+/*  Sums sites per task, most bytes first, returns how many tasks  */
+uint8_t allocTrackByTask(const AllocSiteStats *sites, uint8_t siteCount, AllocTaskStats *tasks, uint8_t maxTasks);
+
+const char *allocSiteEnter(const char *name);
+void allocSiteLeave(const char *previous);
+
+class AllocSiteScope{
+public:
+  explicit AllocSiteScope(const char *name) : previous(allocSiteEnter(name)){}
+  ~AllocSiteScope(){
+    allocSiteLeave(previous);
+  }
+private:
+  const char *previous;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "BeatDetector.h"
+
+#include <string.h>
+
+void beatDetectorInit(BeatDetector *detector, const BeatDetectorConfig *config){
+  memset(detector, 0, sizeof(BeatDetector));
+  detector->config = config;
+}
+
+bool beatDetectorUpdate(BeatDetector *detector, uint16_t signal, uint32_t nowMs){
+  const BeatDetectorConfig *config = detector->config;
+  if((uint32_t)signal + BEAT_HYSTERESIS < config->threshold){
+    detector->inPulse = false;
+    return false;
+  }
+  if(signal <= config->threshold || detector->inPulse){
+    return false;
+  }
+
+  // inside the refractory time the pulse isn't marked, so the average is refreshed until it ends
+  uint32_t interval = nowMs - detector->lastPeakMs;
+  if(interval > config->refractoryMs){
+    uint16_t bpm = 60000 / interval;
+    if(bpm > BEAT_MIN_BPM && bpm < BEAT_MAX_BPM){
+      detector->recent[detector->recentIndex] = bpm;
+      detector->recentIndex = (detector->recentIndex + 1) % BEAT_HISTORY;
+    }
+    detector->lastPeakMs = nowMs;
+    detector->inPulse = true;
+  }
+
+  uint16_t sum = 0;
+  uint8_t valid = 0;
+  for(uint8_t i = 0; i < BEAT_HISTORY; i++){
+    if(detector->recent[i] > 0){
+      sum += detector->recent[i];
+      valid++;
+    }
+  }
+  if(valid > 0){
+    detector->bpm = sum / valid;
+  }
+  return true;
+}
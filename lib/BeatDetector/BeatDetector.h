@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef BEAT_DETECTOR_H
+#define BEAT_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BEAT_THRESHOLD 2450         // ADC counts, a beat starts above it
+#define BEAT_HYSTERESIS 100         // and the next one can start once the signal fell this far below it
+#define BEAT_REFRACTORY 450         // ms after a beat in which no new one is timed
+#define BEAT_MIN_BPM 40             // beat intervals outside (BEAT_MIN_BPM, BEAT_MAX_BPM) are not averaged
+#define BEAT_MAX_BPM 120
+#define BEAT_HISTORY 10             // intervals in the average
+
+/*  Read on every sample, so it can be changed while the detector runs  */
+typedef struct{
+  uint32_t threshold;       // ADC counts
+  uint32_t refractoryMs;
+}BeatDetectorConfig;
+
+#define BEAT_DETECTOR_DEFAULTS {BEAT_THRESHOLD, BEAT_REFRACTORY}
+
+typedef struct{
+  const BeatDetectorConfig *config;
+  uint16_t recent[BEAT_HISTORY];    // bpm of the last intervals, 0 while unfilled
+  uint8_t recentIndex;
+  bool inPulse;
+  uint32_t lastPeakMs;
+  uint16_t bpm;                     // average of recent, 0 until the first valid interval
+}BeatDetector;
+
+void beatDetectorInit(BeatDetector *detector, const BeatDetectorConfig *config);
+
+/*  Feeds one ADC sample. Returns true while the signal is above config->threshold at the start of a pulse,
+ *  bpm is refreshed then  */
+bool beatDetectorUpdate(BeatDetector *detector, uint16_t signal, uint32_t nowMs);
+
+#endif
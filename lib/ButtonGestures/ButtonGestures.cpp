@@ -0,0 +1,100 @@
+#include "ButtonGestures.h"
+
+#include <string.h>
+
+void buttonGestureInit(ButtonGesture *button, const GestureConfig *config){
+  memset(button, 0, sizeof(ButtonGesture));
+  button->config = config;
+  button->state = GESTURE_STATE_IDLE;
+}
+
+static bool debounce(ButtonGesture *button, bool pressed, uint32_t nowMs){
+  if(pressed == button->stablePressed){
+    button->candidatePressed = pressed;
+    return false;
+  }
+  if(pressed != button->candidatePressed){
+    button->candidatePressed = pressed;
+    button->candidateSinceMs = nowMs;
+  }
+  if(nowMs - button->candidateSinceMs < button->config->debounceMs){
+    return false;
+  }
+
+  button->stablePressed = pressed;
+  button->transitions++;
+  return true;
+}
+
+static GestureType onPress(ButtonGesture *button, uint32_t nowMs){
+  const GestureConfig *config = button->config;
+
+  if(button->state == GESTURE_STATE_WAIT_SECOND){
+    button->state = GESTURE_STATE_HELD;
+    return GESTURE_DOUBLE_PRESS;
+  }
+
+  button->state = GESTURE_STATE_DOWN;
+  button->pressStartMs = nowMs;
+  button->repeats = 0;
+  button->nextRepeatMs = nowMs + config->repeatDelayMs;
+
+  // with no long or double press to tell apart, report the press on the down edge
+  button->pressEmitted = (config->doublePressMs == 0 && config->longPressMs == 0);
+  return button->pressEmitted ? GESTURE_PRESS : GESTURE_NONE;
+}
+
+static GestureType onRelease(ButtonGesture *button, uint32_t nowMs){
+  if(button->state == GESTURE_STATE_DOWN && !button->pressEmitted){
+    if(button->config->doublePressMs != 0){
+      button->state = GESTURE_STATE_WAIT_SECOND;
+      button->releaseMs = nowMs;
+      return GESTURE_NONE;
+    }
+    // released before longPressMs
+    button->state = GESTURE_STATE_IDLE;
+    return GESTURE_PRESS;
+  }
+
+  button->state = GESTURE_STATE_IDLE;
+  return GESTURE_NONE;
+}
+
+static GestureType onTick(ButtonGesture *button, uint32_t nowMs){
+  const GestureConfig *config = button->config;
+
+  if(button->state == GESTURE_STATE_WAIT_SECOND){
+    if(nowMs - button->releaseMs >= config->doublePressMs){
+      button->state = GESTURE_STATE_IDLE;
+      return GESTURE_PRESS;
+    }
+    return GESTURE_NONE;
+  }
+
+  if(button->state == GESTURE_STATE_DOWN && config->longPressMs != 0 && nowMs - button->pressStartMs >= config->longPressMs){
+    button->state = GESTURE_STATE_HELD;
+    return GESTURE_LONG_PRESS;
+  }
+
+  // auto repeat keeps going for as long as the button is held
+  if((button->state == GESTURE_STATE_DOWN || button->state == GESTURE_STATE_HELD) && config->repeatDelayMs != 0 &&
+     (int32_t)(nowMs - button->nextRepeatMs) >= 0){
+    button->repeats++;
+    button->nextRepeatMs = nowMs + ((config->repeatFastAfter != 0 && button->repeats >= config->repeatFastAfter)
+                                    ? config->repeatFastIntervalMs : config->repeatIntervalMs);
+    return GESTURE_REPEAT;
+  }
+
+  return GESTURE_NONE;
+}
+
+GestureType buttonGestureUpdate(ButtonGesture *button, bool pressed, uint32_t nowMs){
+  if(debounce(button, pressed, nowMs)){
+    return button->stablePressed ? onPress(button, nowMs) : onRelease(button, nowMs);
+  }
+  return onTick(button, nowMs);
+}
+
+bool buttonGestureIdle(const ButtonGesture *button){
+  return button->state == GESTURE_STATE_IDLE && !button->stablePressed && button->candidatePressed == button->stablePressed;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef BUTTON_GESTURES_H
+#define BUTTON_GESTURES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum : uint8_t{
+  GESTURE_NONE,
+  GESTURE_PRESS,          // short press (on the down edge when double press is disabled)
+  GESTURE_LONG_PRESS,     // held for longPressMs
+  GESTURE_DOUBLE_PRESS,   // second press within doublePressMs of the first release
+  GESTURE_REPEAT          // held for repeatDelayMs, then every repeat interval
+}GestureType;
+
+/*  All times in ms, 0 disables the feature  */
+typedef struct{
+  uint16_t debounceMs;            // level must be stable this long to count as an edge
+  uint16_t longPressMs;
+  uint16_t doublePressMs;         // enabling it delays GESTURE_PRESS until the window closed
+  uint16_t repeatDelayMs;
+  uint16_t repeatIntervalMs;
+  uint16_t repeatFastIntervalMs;  // interval once repeatFastAfter repeats were emitted
+  uint8_t repeatFastAfter;
+}GestureConfig;
+
+typedef enum : uint8_t{
+  GESTURE_STATE_IDLE,
+  GESTURE_STATE_DOWN,             // pressed, nothing decided yet
+  GESTURE_STATE_WAIT_SECOND,      // released after a short press, waiting for a double press
+  GESTURE_STATE_HELD              // gesture already emitted for this press, ignore until release
+}GestureState;
+
+typedef struct{
+  const GestureConfig *config;
+  GestureState state;
+  bool stablePressed;
+  bool candidatePressed;
+  uint32_t candidateSinceMs;
+  uint32_t pressStartMs;
+  uint32_t releaseMs;
+  uint32_t nextRepeatMs;
+  uint16_t repeats;
+  bool pressEmitted;
+  uint32_t transitions;           // debounced edges, raw edges minus this is the bounce count
+}ButtonGesture;
+
+void buttonGestureInit(ButtonGesture *button, const GestureConfig *config);
+
+/*  Feed one level sample, call at a fixed period. Returns at most one gesture per sample  */
+GestureType buttonGestureUpdate(ButtonGesture *button, bool pressed, uint32_t nowMs);
+
+/*  True when the button is released and no gesture is pending, sampling may stop  */
+bool buttonGestureIdle(const ButtonGesture *button);
+
+#endif
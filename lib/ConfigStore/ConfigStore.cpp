@@ -0,0 +1,255 @@
+#include "ConfigStore.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Preferences.h>
+
+typedef struct{
+  ConfigListener listener;
+  void *context;
+}ConfigListenerSlot;
+
+static const ConfigEntry *configEntries = NULL;
+static uint8_t configEntryCount = 0;
+static ConfigListenerSlot listeners[CONFIG_MAX_LISTENERS];
+static uint8_t listenerCount = 0;
+static SemaphoreHandle_t configMutex = NULL;
+static StaticSemaphore_t configMutexBuffer;
+
+static bool inRange(const ConfigEntry *entry, double number){
+  return number >= entry->minimum && number <= entry->maximum;
+}
+
+// writes the cached value, false if the text doesn't make a valid one
+static bool parseInto(const ConfigEntry *entry, const char *text){
+  char *end;
+  switch(entry->type){
+  case CONFIG_UINT32:{
+    if(*text == '-'){
+      return false;
+    }
+    unsigned long number = strtoul(text, &end, 10);
+    if(end == text || *end != '\0' || !inRange(entry, number)){
+      return false;
+    }
+    *(uint32_t *)entry->value = number;
+    return true;
+  }
+  case CONFIG_FLOAT:{
+    float number = strtof(text, &end);
+    if(end == text || *end != '\0' || !inRange(entry, number)){
+      return false;
+    }
+    *(float *)entry->value = number;
+    return true;
+  }
+  case CONFIG_STRING:
+    if(strlen(text) >= entry->size){
+      return false;
+    }
+    configLock();
+    strlcpy((char *)entry->value, text, entry->size);
+    configUnlock();
+    return true;
+  }
+  return false;
+}
+
+static void applyDefault(const ConfigEntry *entry){
+  switch(entry->type){
+  case CONFIG_UINT32:
+    *(uint32_t *)entry->value = (uint32_t)entry->defaultNumber;
+    break;
+  case CONFIG_FLOAT:
+    *(float *)entry->value = (float)entry->defaultNumber;
+    break;
+  case CONFIG_STRING:
+    configLock();
+    strlcpy((char *)entry->value, entry->defaultText, entry->size);
+    configUnlock();
+    break;
+  }
+}
+
+static void loadStored(Preferences &prefs, const ConfigEntry *entry){
+  if(!prefs.isKey(entry->key)){
+    return;
+  }
+  // NVS keeps the type, a key stored as another type than the entry has now reads back as the sentinel
+  switch(entry->type){
+  case CONFIG_UINT32:{
+    uint32_t number = prefs.getUInt(entry->key, (uint32_t)entry->defaultNumber);
+    if(inRange(entry, number)){
+      *(uint32_t *)entry->value = number;
+    }
+    break;
+  }
+  case CONFIG_FLOAT:{
+    float number = prefs.getFloat(entry->key, NAN);
+    if(!isnan(number) && inRange(entry, number)){
+      *(float *)entry->value = number;
+    }
+    break;
+  }
+  case CONFIG_STRING:{
+    char text[CONFIG_TEXT_LENGTH];
+    size_t length = prefs.getString(entry->key, text, sizeof(text));
+    if(length > 0 && strlen(text) < entry->size){
+      configLock();
+      strlcpy((char *)entry->value, text, entry->size);
+      configUnlock();
+    }
+    break;
+  }
+  }
+}
+
+static bool store(const ConfigEntry *entry){
+  Preferences prefs;
+  if(!prefs.begin(CONFIG_NAMESPACE, false)){
+    return false;
+  }
+  bool stored = false;
+  switch(entry->type){
+  case CONFIG_UINT32:
+    stored = prefs.putUInt(entry->key, *(const uint32_t *)entry->value) == sizeof(uint32_t);
+    break;
+  case CONFIG_FLOAT:
+    stored = prefs.putFloat(entry->key, *(const float *)entry->value) == sizeof(float);
+    break;
+  case CONFIG_STRING:{
+    char text[CONFIG_TEXT_LENGTH];
+    configLock();
+    strlcpy(text, (const char *)entry->value, sizeof(text));
+    configUnlock();
+    stored = prefs.putString(entry->key, text) == strlen(text);
+    break;
+  }
+  }
+  prefs.end();
+  return stored;
+}
+
+static void notify(const ConfigEntry *entry){
+  for(uint8_t i = 0; i < listenerCount; i++){
+    listeners[i].listener(entry, listeners[i].context);
+  }
+}
+
+void configBegin(const ConfigEntry *entries, uint8_t count){
+  configMutex = xSemaphoreCreateMutexStatic(&configMutexBuffer);
+  configEntries = entries;
+  configEntryCount = count;
+
+  Preferences prefs;
+  bool opened = prefs.begin(CONFIG_NAMESPACE, true);
+  for(uint8_t i = 0; i < count; i++){
+    applyDefault(&entries[i]);
+    if(opened){
+      loadStored(prefs, &entries[i]);
+    }
+  }
+  if(opened){
+    prefs.end();
+  }
+}
+
+bool configOnChange(ConfigListener listener, void *context){
+  if(listenerCount >= CONFIG_MAX_LISTENERS){
+    return false;
+  }
+  listeners[listenerCount].listener = listener;
+  listeners[listenerCount].context = context;
+  listenerCount++;
+  return true;
+}
+
+ConfigResult configSet(const char *key, const char *text){
+  const ConfigEntry *entry = configFind(key);
+  if(entry == NULL){
+    return CONFIG_UNKNOWN_KEY;
+  }
+  if(!parseInto(entry, text)){
+    return CONFIG_BAD_VALUE;
+  }
+  bool stored = store(entry);
+  notify(entry);
+  return stored ? CONFIG_OK : CONFIG_STORE_FAILED;
+}
+
+ConfigResult configReset(const char *key){
+  const ConfigEntry *entry = configFind(key);
+  if(entry == NULL){
+    return CONFIG_UNKNOWN_KEY;
+  }
+  applyDefault(entry);
+
+  Preferences prefs;
+  bool removed = false;
+  if(prefs.begin(CONFIG_NAMESPACE, false)){
+    removed = !prefs.isKey(key) || prefs.remove(key);
+    prefs.end();
+  }
+  notify(entry);
+  return removed ? CONFIG_OK : CONFIG_STORE_FAILED;
+}
+
+const ConfigEntry *configFind(const char *key){
+  for(uint8_t i = 0; i < configEntryCount; i++){
+    if(strcmp(configEntries[i].key, key) == 0){
+      return &configEntries[i];
+    }
+  }
+  return NULL;
+}
+
+uint8_t configCount(){
+  return configEntryCount;
+}
+
+const ConfigEntry *configEntry(uint8_t index){
+  return index < configEntryCount ? &configEntries[index] : NULL;
+}
+
+void configFormat(const ConfigEntry *entry, char *text, size_t length){
+  switch(entry->type){
+  case CONFIG_UINT32:
+    snprintf(text, length, "%u", (unsigned)*(const uint32_t *)entry->value);
+    break;
+  case CONFIG_FLOAT:
+    snprintf(text, length, "%g", *(const float *)entry->value);
+    break;
+  case CONFIG_STRING:
+    configLock();
+    strlcpy(text, (const char *)entry->value, length);
+    configUnlock();
+    break;
+  }
+}
+
+void configLock(){
+  if(configMutex != NULL){
+    xSemaphoreTake(configMutex, portMAX_DELAY);
+  }
+}
+
+void configUnlock(){
+  if(configMutex != NULL){
+    xSemaphoreGive(configMutex);
+  }
+}
+
+const char *configResultText(ConfigResult result){
+  switch(result){
+  case CONFIG_OK:
+    return "ok";
+  case CONFIG_UNKNOWN_KEY:
+    return "unknown key";
+  case CONFIG_BAD_VALUE:
+    return "bad value";
+  case CONFIG_STORE_FAILED:
+    return "not stored";
+  }
+  return "?";
+}
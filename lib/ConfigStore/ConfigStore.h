@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+#define CONFIG_NAMESPACE "config"
+#define CONFIG_MAX_LISTENERS 4
+#define CONFIG_TEXT_LENGTH 48       // longest formatted value, strings included
+
+typedef enum : uint8_t{
+  CONFIG_UINT32,
+  CONFIG_FLOAT,
+  CONFIG_STRING
+}ConfigType;
+
+/*  One tunable. The table lives in flash, `value` is the cached copy readers use directly: a 32 bit
+ *  write is atomic, so numbers need no locking. Strings are read under configLock()  */
+typedef struct{
+  const char *key;          // NVS key, at most 15 characters
+  ConfigType type;
+  void *value;              // uint32_t, float or char[size]
+  uint16_t size;            // strings only, capacity with the terminator
+  double minimum;           // numbers only, configSet() rejects values outside
+  double maximum;
+  double defaultNumber;
+  const char *defaultText;  // strings only
+  const char *help;
+}ConfigEntry;
+
+typedef enum : uint8_t{
+  CONFIG_OK,
+  CONFIG_UNKNOWN_KEY,
+  CONFIG_BAD_VALUE,         // doesn't parse, out of range or too long
+  CONFIG_STORE_FAILED       // cached value changed, but it won't survive a reboot
+}ConfigResult;
+
+/*  Runs in the task that changed the value, after the cache was updated  */
+typedef void (*ConfigListener)(const ConfigEntry *entry, void *context);
+
+/*  Fills every value with its default, then with what NVS holds for it. Stored values that no longer
+ *  fit the entry (type or range changed since) are ignored  */
+void configBegin(const ConfigEntry *entries, uint8_t count);
+
+bool configOnChange(ConfigListener listener, void *context);
+
+/*  Parses text for the entry, stores it in NVS and notifies the listeners  */
+ConfigResult configSet(const char *key, const char *text);
+
+/*  Back to the default, the NVS copy is erased  */
+ConfigResult configReset(const char *key);
+
+const ConfigEntry *configFind(const char *key);
+uint8_t configCount();
+const ConfigEntry *configEntry(uint8_t index);
+
+/*  Current value as text, taken under the lock  */
+void configFormat(const ConfigEntry *entry, char *text, size_t length);
+
+/*  Held while a string value is written, hold it to read one or several consistently  */
+void configLock();
+void configUnlock();
+
+const char *configResultText(ConfigResult result);
+
+#endif
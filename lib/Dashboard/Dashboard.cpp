@@ -0,0 +1,143 @@
+#include "Dashboard.h"
+#include "DashboardPage.h"
+
+#include <HealthMonitor.h>
+
+#include <AsyncTCP.h>
+#include <ESPAsyncWebServer.h>
+
+static AsyncWebServer server(DASHBOARD_PORT);
+static AsyncEventSource events("/events");
+
+/*  Written by dashboardPublish(), read by the push task and the async_tcp task  */
+static portMUX_TYPE snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+static TelemetrySnapshot latest;
+static bool latestPending = false;
+
+static TaskHandle_t pushTask_handle = NULL;
+static DashboardStats stats;
+
+static size_t latestJson(char *out, size_t outSize){
+  TelemetrySnapshot snapshot;
+  portENTER_CRITICAL(&snapshotLock);
+  snapshot = latest;
+  portEXIT_CRITICAL(&snapshotLock);
+  return telemetryToJson(&snapshot, out, outSize);
+}
+
+static void handlePage(AsyncWebServerRequest *request){
+  stats.pageRequests++;
+  AsyncWebServerResponse *response = request->beginResponse(200, "text/html", dashboardPageGz, sizeof(dashboardPageGz));
+  response->addHeader("Content-Encoding", "gzip");
+  response->addHeader("Cache-Control", "max-age=86400");
+  request->send(response);
+}
+
+static void handleState(AsyncWebServerRequest *request){
+  stats.stateRequests++;
+  char json[TELEMETRY_JSON_MAX_LENGTH];
+  latestJson(json, sizeof(json));
+  AsyncWebServerResponse *response = request->beginResponse(200, "application/json", json);
+  response->addHeader("Cache-Control", "no-store");
+  response->addHeader("Access-Control-Allow-Origin", "*");
+  request->send(response);
+}
+
+// snapshot and JSON are too big for the async_tcp task's stack
+static void handleHealth(AsyncWebServerRequest *request){
+  stats.healthRequests++;
+  HealthSnapshot *snapshot = (HealthSnapshot *)malloc(sizeof(HealthSnapshot));
+  char *json = (char *)malloc(HEALTH_JSON_MAX_LENGTH);
+  if(snapshot == NULL || json == NULL){
+    free(snapshot);
+    free(json);
+    request->send(503, "text/plain", "Out of memory");
+    return;
+  }
+
+  healthGetSnapshot(snapshot);
+  healthToJson(snapshot, json, HEALTH_JSON_MAX_LENGTH);
+  AsyncWebServerResponse *response = request->beginResponse(200, "application/json", json);
+  response->addHeader("Cache-Control", "no-store");
+  response->addHeader("Access-Control-Allow-Origin", "*");
+  request->send(response);
+
+  free(snapshot);
+  free(json);
+}
+
+// a new client gets the current state right away instead of waiting for the next change
+static void handleEventsConnect(AsyncEventSourceClient *client){
+  char json[TELEMETRY_JSON_MAX_LENGTH];
+  if(latestJson(json, sizeof(json)) > 0){
+    client->send(json, "state", millis());
+  }
+}
+
+static void dashboardPushTask(void *parameters){
+  char json[TELEMETRY_JSON_MAX_LENGTH];
+
+  for(;;){
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    bool pending;
+    portENTER_CRITICAL(&snapshotLock);
+    pending = latestPending;
+    latestPending = false;
+    portEXIT_CRITICAL(&snapshotLock);
+
+    stats.clients = events.count();
+    if(pending && stats.clients > 0 && latestJson(json, sizeof(json)) > 0){
+      // AsyncEventSource only queues the message per client, slow clients drop instead of blocking us
+      events.send(json, "state", millis());
+      stats.pushes++;
+    }
+
+    // everything published meanwhile folds into the next push
+    vTaskDelay(pdMS_TO_TICKS(DASHBOARD_PUSH_INTERVAL));
+  }
+}
+
+void dashboardBegin(DashboardStorage *storage, UBaseType_t taskPriority, BaseType_t core){
+  memset(&stats, 0, sizeof(stats));
+
+  server.on("/", HTTP_GET, handlePage);
+  server.on("/api/state", HTTP_GET, handleState);
+  server.on("/api/health", HTTP_GET, handleHealth);
+  events.onConnect(handleEventsConnect);
+  server.addHandler(&events);
+  server.onNotFound([](AsyncWebServerRequest *request){
+    request->send(404, "text/plain", "Not found");
+  });
+  server.begin();
+
+  pushTask_handle = xTaskCreateStaticPinnedToCore(
+    dashboardPushTask,
+    "DASHBOARD PUSH",
+    DASHBOARD_TASK_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+}
+
+void dashboardPublish(const TelemetrySnapshot *snapshot){
+  portENTER_CRITICAL(&snapshotLock);
+  if(latestPending){
+    stats.coalesced++;
+  }
+  latest = *snapshot;
+  latestPending = true;
+  portEXIT_CRITICAL(&snapshotLock);
+
+  if(pushTask_handle != NULL){
+    xTaskNotifyGive(pushTask_handle);
+  }
+}
+
+void dashboardGetStats(DashboardStats *out){
+  *out = stats;
+  out->clients = events.count();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <Arduino.h>
+#include <Telemetry.h>
+
+#define DASHBOARD_PORT 80
+#define DASHBOARD_PUSH_INTERVAL 250     // ms, shortest gap between two SSE pushes
+#define DASHBOARD_TASK_STACK 4096
+
+typedef struct{
+  uint32_t pageRequests;
+  uint32_t stateRequests;
+  uint32_t healthRequests;
+  uint32_t pushes;          // SSE events sent, counted once per push not per client
+  uint32_t coalesced;       // snapshots replaced before they could be pushed
+  uint32_t clients;         // SSE clients connected right now
+}DashboardStats;
+
+/*  The push task's memory, reserved by the caller (see lib/StaticRtos)  */
+typedef struct{
+  StackType_t stack[DASHBOARD_TASK_STACK];
+  StaticTask_t tcb;
+}DashboardStorage;
+
+/*  Starts the async web server and the SSE push task, serving begins as soon as the link is up:
+ *    /            gzipped dashboard page from flash
+ *    /api/state   latest snapshot as JSON
+ *    /api/health  latest HealthMonitor sample as JSON
+ *    /events      SSE stream, one "state" event per change  */
+void dashboardBegin(DashboardStorage *storage, UBaseType_t taskPriority, BaseType_t core);
+
+/*  Copies the snapshot and wakes the push task, never touches the network  */
+void dashboardPublish(const TelemetrySnapshot *snapshot);
+
+void dashboardGetStats(DashboardStats *stats);
+
+#endif
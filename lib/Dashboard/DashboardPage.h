@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef DASHBOARD_PAGE_H
+#define DASHBOARD_PAGE_H
+
+/*  Generated by tools/embed_web.py from web/dashboard.html, do not edit  */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DASHBOARD_PAGE_RAW_LENGTH 2406
+
+static const uint8_t dashboardPageGz[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x56, 0xe9, 0x8e, 0xdb, 0x36,
+  0x10, 0xfe, 0xef, 0xa7, 0x60, 0xb5, 0x08, 0x24, 0x23, 0x96, 0x7c, 0x64, 0x8f, 0xac, 0x7c, 0x04,
+  0xed, 0x76, 0x8b, 0xb6, 0x28, 0x92, 0x00, 0x1b, 0x20, 0xe8, 0x4f, 0xae, 0x38, 0xb2, 0xd8, 0x52,
+  0x07, 0x48, 0xca, 0x47, 0x1d, 0xbf, 0x53, 0x9f, 0xa1, 0x4f, 0xd6, 0x19, 0x4a, 0xda, 0x95, 0x93,
+  0xcd, 0x22, 0x08, 0x0c, 0x9b, 0xd2, 0x1c, 0xdf, 0x5c, 0x1f, 0x49, 0x2f, 0x7e, 0xf8, 0xf9, 0xdd,
+  0xcd, 0x87, 0x3f, 0xdf, 0xdf, 0xb2, 0xcc, 0xe6, 0x6a, 0x35, 0x58, 0x74, 0x0b, 0x70, 0x81, 0x4b,
+  0x0e, 0x96, 0xb3, 0x24, 0xe3, 0xda, 0x80, 0x5d, 0x7a, 0xb5, 0x4d, 0xc3, 0xd7, 0x5e, 0x27, 0x2e,
+  0x78, 0x0e, 0x4b, 0x6f, 0x23, 0x61, 0x5b, 0x95, 0xda, 0x7a, 0x2c, 0x29, 0x0b, 0x0b, 0x05, 0x9a,
+  0x6d, 0xa5, 0xb0, 0xd9, 0x52, 0xc0, 0x46, 0x26, 0x10, 0xba, 0x97, 0x11, 0x93, 0x85, 0xb4, 0x92,
+  0xab, 0xd0, 0x24, 0x5c, 0xc1, 0x72, 0x4a, 0x20, 0x56, 0x5a, 0x05, 0xab, 0xdb, 0xbb, 0xf7, 0xaf,
+  0x66, 0xec, 0x2e, 0xe7, 0xda, 0xb2, 0x8f, 0xdc, 0x26, 0xd9, 0x62, 0xdc, 0x28, 0x06, 0x0b, 0x63,
+  0xf7, 0xb4, 0xde, 0x97, 0x62, 0x7f, 0x48, 0x11, 0x3c, 0x4c, 0x79, 0x2e, 0xd5, 0x3e, 0xfe, 0x51,
+  0x23, 0xd2, 0xc8, 0xf0, 0xc2, 0x84, 0x06, 0xb4, 0x4c, 0xe7, 0xf7, 0x3c, 0xf9, 0x7b, 0xad, 0xcb,
+  0xba, 0x10, 0xf1, 0x59, 0x7a, 0x9e, 0x5e, 0xa4, 0x57, 0x73, 0xc4, 0x5b, 0xcb, 0x22, 0x9e, 0xcc,
+  0x93, 0x52, 0x95, 0x3a, 0x3e, 0x9b, 0xcd, 0x66, 0xc7, 0x41, 0xce, 0x65, 0x71, 0xc8, 0xf9, 0xae,
+  0x49, 0x2a, 0x3e, 0x9f, 0x4d, 0xaa, 0x5d, 0x67, 0x39, 0x3b, 0xaf, 0x76, 0x8c, 0xd7, 0xb6, 0x9c,
+  0x57, 0x5c, 0x08, 0x59, 0xac, 0xe3, 0x09, 0x9b, 0xce, 0xaa, 0xdd, 0x71, 0x90, 0x4d, 0x9b, 0xe8,
+  0x46, 0xfe, 0x03, 0xb1, 0x73, 0xb1, 0xb0, 0xb3, 0x21, 0x57, 0x72, 0x5d, 0xc4, 0x09, 0x56, 0x0c,
+  0xfa, 0x38, 0x88, 0xd6, 0x5a, 0x8a, 0x83, 0x90, 0xa6, 0x52, 0x7c, 0x1f, 0xd3, 0xcb, 0x9c, 0x7e,
+  0x42, 0x0b, 0x39, 0x4a, 0x2c, 0x84, 0x98, 0x47, 0x9d, 0x17, 0x26, 0x9e, 0xa6, 0x9a, 0xe1, 0x77,
+  0xbe, 0xe6, 0x55, 0xdc, 0xe0, 0x47, 0x09, 0xd7, 0xe2, 0x70, 0x52, 0x43, 0x8a, 0x35, 0x95, 0x5a,
+  0x80, 0x0e, 0x35, 0x17, 0xb2, 0x46, 0x2f, 0x0a, 0xdb, 0x25, 0x36, 0xc5, 0x54, 0x51, 0xbf, 0x0b,
+  0x4d, 0xc6, 0x45, 0xb9, 0xc5, 0x44, 0x11, 0x87, 0x5d, 0xe2, 0x57, 0xaf, 0xef, 0x79, 0x30, 0x19,
+  0xd1, 0x27, 0x9a, 0xbc, 0x1e, 0xb6, 0xd8, 0x11, 0x96, 0x0b, 0x07, 0x97, 0x4e, 0x93, 0x45, 0x6c,
+  0x2a, 0x5e, 0x30, 0x6c, 0x48, 0xa4, 0xf8, 0x3d, 0xa8, 0x5e, 0x79, 0x94, 0x51, 0xd7, 0xb2, 0xab,
+  0xab, 0xab, 0xa6, 0x52, 0xab, 0xb1, 0xd5, 0x69, 0xa9, 0xf3, 0xb8, 0xae, 0x2a, 0xd0, 0x09, 0x37,
+  0x80, 0xae, 0x1b, 0xae, 0x6a, 0xe8, 0x77, 0xe6, 0x35, 0xba, 0xba, 0xd7, 0x2d, 0xc8, 0x75, 0x66,
+  0xe3, 0xfb, 0x52, 0x89, 0x0e, 0x6b, 0x32, 0xb9, 0x9c, 0x25, 0x49, 0xdb, 0xeb, 0xd0, 0x96, 0x55,
+  0x7c, 0xee, 0x4a, 0x37, 0x39, 0x57, 0x27, 0xf1, 0xcf, 0x1f, 0xe3, 0x5f, 0x5c, 0x5c, 0x7c, 0xe1,
+  0x70, 0x66, 0x2c, 0xb7, 0xb5, 0x39, 0x7c, 0x31, 0x81, 0xf9, 0xd3, 0x35, 0x5c, 0x5f, 0x5f, 0xf7,
+  0x31, 0xa6, 0x97, 0x3d, 0x90, 0x48, 0xc9, 0x0d, 0x1c, 0x3a, 0x7e, 0xf0, 0x6b, 0xf1, 0x8a, 0x1f,
+  0x07, 0x8b, 0x71, 0xcb, 0xba, 0xc5, 0xb8, 0xdd, 0x02, 0x44, 0x3f, 0xa2, 0x3c, 0x72, 0x87, 0xf6,
+  0xc5, 0xf4, 0x29, 0xc6, 0xa2, 0x74, 0xb0, 0x10, 0x72, 0xc3, 0x12, 0xc5, 0x8d, 0x59, 0x7a, 0xd4,
+  0x6b, 0xa4, 0x38, 0x63, 0x7d, 0x21, 0x8d, 0xc2, 0x5b, 0xf5, 0x25, 0xae, 0xfb, 0xde, 0xea, 0xce,
+  0x42, 0x65, 0x16, 0x63, 0x54, 0x9c, 0x68, 0x5d, 0x83, 0x3d, 0x26, 0xc5, 0xd2, 0x33, 0x64, 0xe1,
+  0xad, 0xc2, 0xb0, 0xb5, 0x72, 0xbf, 0xdf, 0x0a, 0xff, 0x2b, 0x50, 0xa6, 0x1a, 0x49, 0xf8, 0x6c,
+  0x8c, 0xfb, 0x2a, 0xff, 0xde, 0x08, 0x1f, 0x90, 0xe4, 0x80, 0x01, 0x6a, 0xfd, 0x7c, 0x08, 0xda,
+  0x0c, 0xdf, 0x5d, 0x45, 0x9d, 0x4b, 0x21, 0xed, 0xfe, 0xd9, 0x00, 0x3a, 0xfb, 0x06, 0x78, 0x46,
+  0xdb, 0xe1, 0xc9, 0x18, 0x1f, 0x81, 0xdb, 0x0c, 0xf4, 0xb3, 0x21, 0x52, 0x00, 0xd5, 0x1f, 0x45,
+  0xcf, 0xca, 0x91, 0xb9, 0xb1, 0x12, 0x60, 0x12, 0x6f, 0x75, 0x92, 0x48, 0xb7, 0x90, 0x43, 0x33,
+  0x53, 0x22, 0xa1, 0xb7, 0xc2, 0x63, 0xb3, 0x80, 0xc4, 0xe2, 0xc6, 0x8e, 0xa2, 0xe8, 0xc1, 0xb6,
+  0xa5, 0x9b, 0x49, 0xb4, 0xac, 0xec, 0x6a, 0x90, 0xd6, 0x05, 0x9a, 0x94, 0x05, 0x23, 0xe2, 0x07,
+  0x52, 0x8c, 0x98, 0x4b, 0x69, 0xc4, 0x6a, 0x3c, 0x57, 0x87, 0x07, 0xac, 0x52, 0x94, 0x49, 0x9d,
+  0xe3, 0x56, 0x88, 0xd6, 0x60, 0x6f, 0x15, 0xd0, 0xe3, 0x4f, 0xfb, 0xdf, 0x04, 0xda, 0x0e, 0x23,
+  0x72, 0xba, 0x69, 0x4e, 0x67, 0xb6, 0x64, 0x81, 0x73, 0x65, 0xcb, 0xe5, 0x92, 0x15, 0xb5, 0x52,
+  0xec, 0xd3, 0x27, 0xf6, 0x28, 0xc1, 0xf3, 0x07, 0x52, 0x59, 0x80, 0x18, 0xb2, 0x37, 0xcc, 0x0f,
+  0x43, 0x9f, 0xc5, 0xad, 0xf6, 0x25, 0x0b, 0x28, 0x18, 0x99, 0xfb, 0xfe, 0x70, 0x3e, 0x38, 0x3e,
+  0x26, 0x65, 0xb2, 0x72, 0x1b, 0x18, 0x97, 0x86, 0xcb, 0xcf, 0x77, 0x7c, 0xf5, 0x47, 0xcc, 0x44,
+  0xee, 0x09, 0xad, 0x3b, 0x0d, 0xb2, 0xcc, 0xc9, 0x71, 0x1d, 0x31, 0x9f, 0xd1, 0x6b, 0x4f, 0x4b,
+  0x04, 0x71, 0x6a, 0x7a, 0x78, 0xcc, 0xf0, 0x4d, 0xb3, 0xc4, 0xad, 0x22, 0xb2, 0xe5, 0x2f, 0x72,
+  0x07, 0x22, 0x98, 0x0e, 0x09, 0xe3, 0xbf, 0x7f, 0x6f, 0xfa, 0x18, 0x3a, 0x73, 0x08, 0x3a, 0x23,
+  0xdd, 0x8b, 0x46, 0x23, 0xd3, 0xc0, 0x44, 0xdb, 0x66, 0xba, 0x2e, 0xcd, 0xce, 0xd8, 0x4d, 0xd3,
+  0xd9, 0xb7, 0xda, 0xc8, 0x49, 0xbe, 0x16, 0xa1, 0x73, 0xa3, 0xf1, 0x9e, 0x78, 0x91, 0x00, 0x3b,
+  0xe4, 0x93, 0xf5, 0xcb, 0x9e, 0x5c, 0x67, 0x24, 0x65, 0x2f, 0x3e, 0x97, 0x6f, 0x65, 0x21, 0x7a,
+  0x41, 0x9c, 0x51, 0x3e, 0x36, 0x4d, 0x94, 0xe3, 0x49, 0x6f, 0x1d, 0x4d, 0x82, 0xdc, 0xac, 0x47,
+  0x8c, 0x0e, 0x2c, 0x97, 0xfe, 0x86, 0x6b, 0x06, 0x0a, 0x67, 0xf9, 0xb5, 0xa9, 0xfb, 0x8d, 0x5b,
+  0x83, 0x07, 0xea, 0x33, 0x06, 0x20, 0x58, 0x2b, 0x77, 0xcc, 0x7d, 0x8b, 0x17, 0x39, 0x4a, 0x09,
+  0x9d, 0x86, 0x4e, 0x2b, 0x8d, 0xdd, 0xf7, 0xdd, 0x90, 0x01, 0x4f, 0xb8, 0xc0, 0x1f, 0xf3, 0x4a,
+  0x8e, 0x09, 0x14, 0x7c, 0xe4, 0x53, 0x06, 0x45, 0xd0, 0x65, 0x18, 0x60, 0x47, 0x99, 0x06, 0xdc,
+  0xfc, 0x05, 0xd3, 0xd1, 0x5f, 0x06, 0x25, 0xc3, 0x39, 0x3b, 0xb6, 0x56, 0x44, 0x8d, 0x21, 0xde,
+  0x42, 0x04, 0xf2, 0xe0, 0x31, 0x3c, 0x1c, 0x31, 0x31, 0x2a, 0xc2, 0x94, 0xb5, 0x4e, 0x28, 0x78,
+  0x01, 0x5b, 0x76, 0xbb, 0xc1, 0xf4, 0xee, 0x9c, 0x04, 0x03, 0x02, 0xbd, 0xb9, 0x0a, 0x1a, 0xa3,
+  0x08, 0x6f, 0x3f, 0x67, 0xf1, 0x87, 0x44, 0x52, 0x15, 0xa0, 0x9b, 0x22, 0x01, 0x7b, 0xfe, 0x00,
+  0xdc, 0x74, 0xc7, 0xd1, 0xf1, 0xf7, 0xbb, 0x77, 0x6f, 0xa3, 0x8a, 0xfe, 0xb8, 0x04, 0x10, 0x09,
+  0x6e, 0xf9, 0xd0, 0xf5, 0xa2, 0x6d, 0x67, 0x53, 0xe4, 0x88, 0x59, 0x5d, 0x03, 0x71, 0xf9, 0x31,
+  0x4a, 0x89, 0xc8, 0xba, 0xd4, 0x98, 0x52, 0x2f, 0xdd, 0x07, 0x37, 0x0d, 0x27, 0xdb, 0x95, 0x62,
+  0x73, 0x65, 0x80, 0x0a, 0x9e, 0xd3, 0xdd, 0xd1, 0x6e, 0xd7, 0xc5, 0xb8, 0xbd, 0x35, 0xc6, 0xcd,
+  0xdf, 0xa9, 0xff, 0x01, 0xdb, 0x56, 0xac, 0x70, 0x66, 0x09, 0x00, 0x00,
+};
+
+#endif
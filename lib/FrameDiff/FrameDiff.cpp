@@ -0,0 +1,124 @@
+#include "FrameDiff.h"
+
+#include <string.h>
+
+void frameDiffInit(FrameDiff *frameDiff){
+  memset(frameDiff, 0, sizeof(FrameDiff));
+  frameDiff->valid = false;
+}
+
+void frameDiffInvalidate(FrameDiff *frameDiff){
+  frameDiff->valid = false;
+}
+
+// the buffers are bytes, words are loaded through memcpy so nothing aliases them as uint32_t.
+// With the pointer known to be aligned GCC turns each into a single l32i
+static inline uint32_t loadWord(const uint8_t *bytes){
+  uint32_t word;
+  memcpy(&word, __builtin_assume_aligned(bytes, 4), sizeof(word));
+  return word;
+}
+
+static bool pageDirtyWords(const uint8_t *shadowPage, const uint8_t *bufferPage){
+  for(uint8_t word = 0; word < FRAME_PAGE_WORDS; word++){
+    if(loadWord(shadowPage + word * 4) != loadWord(bufferPage + word * 4)){
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool tileDirtyWords(const uint8_t *shadowPage, const uint8_t *bufferPage, uint8_t tile){
+  const uint8_t *shadowTile = shadowPage + tile * FRAME_TILE_BYTES;
+  const uint8_t *bufferTile = bufferPage + tile * FRAME_TILE_BYTES;
+  return loadWord(shadowTile) != loadWord(bufferTile) || loadWord(shadowTile + 4) != loadWord(bufferTile + 4);
+}
+
+static bool tileDirtyBytes(const uint8_t *shadowPage, const uint8_t *bufferPage, uint8_t tile){
+  return memcmp(shadowPage + tile * FRAME_TILE_BYTES, bufferPage + tile * FRAME_TILE_BYTES, FRAME_TILE_BYTES) != 0;
+}
+
+static void addArea(FrameArea *areas, uint8_t *areaCount, uint8_t tileX, uint8_t tileY, uint8_t tileWidth){
+  areas[*areaCount].tileX = tileX;
+  areas[*areaCount].tileY = tileY;
+  areas[*areaCount].tileWidth = tileWidth;
+  (*areaCount)++;
+}
+
+uint8_t frameDiffCompute(FrameDiff *frameDiff, const uint8_t *buffer, FrameArea areas[FRAME_MAX_AREAS]){
+  uint8_t areaCount = 0;
+  frameDiff->stats.pagesSkippedLastFrame = 0;
+
+  if(!frameDiff->valid){
+    for(uint8_t page = 0; page < FRAME_TILE_HEIGHT; page++){
+      addArea(areas, &areaCount, 0, page, FRAME_TILE_WIDTH);
+    }
+    return areaCount;
+  }
+
+  // U8g2 doesn't promise an aligned buffer and Xtensa faults on unaligned word loads
+  bool wordAligned = ((uintptr_t)buffer & 3) == 0;
+
+  for(uint8_t page = 0; page < FRAME_TILE_HEIGHT; page++){
+    const uint8_t *shadowPage = frameDiff->shadow.bytes + page * FRAME_PAGE_BYTES;
+    const uint8_t *bufferPage = buffer + page * FRAME_PAGE_BYTES;
+
+    if(wordAligned && !pageDirtyWords(shadowPage, bufferPage)){
+      frameDiff->stats.pagesSkippedLastFrame++;
+      continue;
+    }
+
+    // a run ends at the first clean tile: resending 8 clean bytes never beats the 7 a new run costs
+    int8_t runStart = -1;
+
+    for(uint8_t tile = 0; tile < FRAME_TILE_WIDTH; tile++){
+      bool dirty = wordAligned ? tileDirtyWords(shadowPage, bufferPage, tile)
+                               : tileDirtyBytes(shadowPage, bufferPage, tile);
+      if(dirty && runStart < 0){
+        runStart = tile;
+      }else if(!dirty && runStart >= 0){
+        addArea(areas, &areaCount, runStart, page, tile - runStart);
+        runStart = -1;
+      }
+    }
+
+    if(runStart >= 0){
+      addArea(areas, &areaCount, runStart, page, FRAME_TILE_WIDTH - runStart);
+    }
+  }
+
+  return areaCount;
+}
+
+uint32_t frameDiffCommit(FrameDiff *frameDiff, const uint8_t *buffer, const FrameArea *areas, uint8_t areaCount,
+                         FrameAreaSender send, void *context){
+  uint32_t bytesSent = 0;
+
+  for(uint8_t i = 0; i < areaCount; i++){
+    uint16_t offset = areas[i].tileY * FRAME_PAGE_BYTES + areas[i].tileX * FRAME_TILE_BYTES;
+    uint16_t length = areas[i].tileWidth * FRAME_TILE_BYTES;
+
+    send(areas[i].tileX, areas[i].tileY, areas[i].tileWidth, context);
+    memcpy(frameDiff->shadow.bytes + offset, buffer + offset, length);
+    bytesSent += length + FRAME_AREA_OVERHEAD_BYTES;
+  }
+  frameDiff->valid = true;
+
+  frameDiff->stats.frames++;
+  frameDiff->stats.areasLastFrame = areaCount;
+  frameDiff->stats.bytesSentLastFrame = bytesSent;
+  frameDiff->stats.bytesSentTotal += bytesSent;
+  frameDiff->stats.bytesFullRedrawTotal += FRAME_FULL_REDRAW_BYTES;
+
+  return bytesSent;
+}
+
+uint32_t frameDiffFlush(FrameDiff *frameDiff, const uint8_t *buffer, FrameAreaSender send, void *context){
+  FrameArea areas[FRAME_MAX_AREAS];
+  uint8_t areaCount = frameDiffCompute(frameDiff, buffer, areas);
+  return frameDiffCommit(frameDiff, buffer, areas, areaCount, send, context);
+}
+
+bool frameDiffVerify(const FrameDiff *frameDiff, const uint8_t *buffer){
+  return frameDiff->valid && memcmp(frameDiff->shadow.bytes, buffer, FRAME_BUFFER_BYTES) == 0;
+}
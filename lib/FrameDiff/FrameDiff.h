@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef FRAME_DIFF_H
+#define FRAME_DIFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*  SH1106 128x64 full buffer in U8g2 tile layout: 8 pages (tile rows) of 16 tiles, 8 bytes per tile  */
+#define FRAME_TILE_WIDTH 16
+#define FRAME_TILE_HEIGHT 8
+#define FRAME_TILE_BYTES 8
+#define FRAME_PAGE_BYTES (FRAME_TILE_WIDTH * FRAME_TILE_BYTES)
+#define FRAME_BUFFER_BYTES (FRAME_PAGE_BYTES * FRAME_TILE_HEIGHT)
+
+/*  I2C bytes spent per tile run besides pixel data: address + control + page/column commands  */
+#define FRAME_AREA_OVERHEAD_BYTES 7
+
+/*  Bytes a full sendBuffer() costs, used as the reference for the savings counters  */
+#define FRAME_FULL_REDRAW_BYTES (FRAME_TILE_HEIGHT * (FRAME_PAGE_BYTES + FRAME_AREA_OVERHEAD_BYTES))
+
+/*  Worst case run count: every other tile dirty on every page  */
+#define FRAME_MAX_AREAS (FRAME_TILE_HEIGHT * (FRAME_TILE_WIDTH / 2))
+
+#define FRAME_PAGE_WORDS (FRAME_PAGE_BYTES / 4)
+
+typedef struct{
+  uint32_t frames;                // flushes performed
+  uint32_t bytesSentLastFrame;    // pixel + overhead bytes of the last flush
+  uint16_t areasLastFrame;        // tile runs pushed by the last flush
+  uint64_t bytesSentTotal;
+  uint64_t bytesFullRedrawTotal;  // what the same frames would have cost with sendBuffer()
+  uint16_t pagesSkippedLastFrame; // pages that matched the shadow word for word
+  uint32_t diffUsLastFrame;       // compare cost, filled in by whoever times frameDiffCompute()
+  uint64_t diffUsTotal;
+}FrameDiffStats;
+
+typedef struct{
+  uint8_t tileX;
+  uint8_t tileY;
+  uint8_t tileWidth;
+}FrameArea;
+
+/*  Pushes tileWidth tiles of page tileY starting at tileX to the panel (updateDisplayArea style)  */
+typedef void (*FrameAreaSender)(uint8_t tileX, uint8_t tileY, uint8_t tileWidth, void *context);
+
+typedef struct{
+  union{
+    uint8_t bytes[FRAME_BUFFER_BYTES];  // last transmitted frame, i.e. what the panel is showing right now
+    uint32_t align;                     // keeps the shadow word aligned, it is only read as bytes
+  }shadow;
+  bool valid;                           // false until the first full frame reached the panel
+  FrameDiffStats stats;
+}FrameDiff;
+
+void frameDiffInit(FrameDiff *frameDiff);
+
+/*  Forget the panel model, e.g. after someone called sendBuffer() directly  */
+void frameDiffInvalidate(FrameDiff *frameDiff);
+
+/*  Compares `buffer` page by page against the shadow, word-wide when `buffer` is 4-byte aligned,
+    and fills `areas` with the tile runs that differ. Returns the number of runs  */
+uint8_t frameDiffCompute(FrameDiff *frameDiff, const uint8_t *buffer, FrameArea areas[FRAME_MAX_AREAS]);
+
+/*  Sends the runs found by frameDiffCompute() and copies them into the shadow, returns bytes sent  */
+uint32_t frameDiffCommit(FrameDiff *frameDiff, const uint8_t *buffer, const FrameArea *areas, uint8_t areaCount,
+                         FrameAreaSender send, void *context);
+
+/*  frameDiffCompute() + frameDiffCommit() in one go  */
+uint32_t frameDiffFlush(FrameDiff *frameDiff, const uint8_t *buffer, FrameAreaSender send, void *context);
+
+/*  True when the panel model equals `buffer`, i.e. the panel shows what a full redraw would  */
+bool frameDiffVerify(const FrameDiff *frameDiff, const uint8_t *buffer);
+
+/*  Pixel (x, y) of a buffer in U8g2 tile layout: one byte per column of 8 pixels, LSB on top  */
+static inline bool frameGetPixel(const uint8_t *buffer, uint8_t x, uint8_t y){
+  return (buffer[(y / 8) * FRAME_PAGE_BYTES + x] >> (y % 8)) & 1;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*  The hardware the sensor, algorithm and screen code touches, as small interfaces:
+ *  HalEsp32.h implements them on the watch, HalFake.h on Linux for the native environment.
+ *  The display is no interface: it is U8g2 on both, drawn through the concrete U8g2Display (HalU8g2.h)
+ *  so the screens' draw calls are direct.
+ *  Nothing here is called from an ISR: the virtual calls are not in IRAM  */
+
+#define HAL_DISPLAY_WIDTH 128
+#define HAL_DISPLAY_HEIGHT 64
+
+class HalClock{
+public:
+  virtual uint32_t millis() = 0;
+  virtual uint32_t micros() = 0;
+};
+
+class HalAdc{
+public:
+  virtual uint16_t read(uint8_t pin) = 0;
+};
+
+class HalGpio{
+public:
+  virtual bool read(uint8_t pin) = 0;
+  virtual void write(uint8_t pin, bool level) = 0;
+};
+
+class HalI2c{
+public:
+  /*  Register read with a repeated start, false when the device did not answer  */
+  virtual bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t length) = 0;
+  virtual bool writeRegister(uint8_t address, uint8_t reg, uint8_t value) = 0;
+};
+
+/*  The fonts the screens use, mapped to U8g2 fonts by U8g2Display  */
+enum HalFont : uint8_t{
+  HAL_FONT_5X7,
+  HAL_FONT_6X10,
+  HAL_FONT_HELV_R08,
+  HAL_FONT_HELV_B08,
+  HAL_FONT_HELV_B10,
+  HAL_FONT_HELV_B12,
+  HAL_FONT_NCEN_B08,
+  HAL_FONT_NUMBERS_20,
+  HAL_FONT_COUNT
+};
+
+/*  Blocking GET into `body`, NUL terminated and cut at capacity - 1.
+ *  Returns the HTTP status, or <= 0 when the request failed  */
+class HalHttp{
+public:
+  virtual int get(const char *url, char *body, size_t capacity, size_t *length) = 0;
+};
+
+#endif
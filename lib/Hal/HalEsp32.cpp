@@ -0,0 +1,67 @@
+#ifdef ARDUINO
+
+#include "HalEsp32.h"
+
+bool Esp32I2c::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t length){
+  wire.beginTransmission(address);
+  wire.write(reg);
+  if(wire.endTransmission(false) != 0){
+    return false;
+  }
+  if(wire.requestFrom(address, (uint8_t)length) != length){
+    return false;
+  }
+  for(size_t i = 0; i < length; i++){
+    data[i] = wire.read();
+  }
+  return true;
+}
+
+bool Esp32I2c::writeRegister(uint8_t address, uint8_t reg, uint8_t value){
+  wire.beginTransmission(address);
+  wire.write(reg);
+  wire.write(value);
+  return wire.endTransmission() == 0;
+}
+
+/*  HTTPClient::writeToStream() target that fills a fixed buffer and drops the rest  */
+class BufferSink : public Stream{
+public:
+  BufferSink(char *buffer, size_t capacity) : buffer(buffer), capacity(capacity), length(0){}
+
+  size_t write(uint8_t byte) override{
+    return write(&byte, 1);
+  }
+
+  size_t write(const uint8_t *data, size_t size) override{
+    size_t room = capacity - 1 - length;
+    size_t copied = size < room ? size : room;
+    memcpy(buffer + length, data, copied);
+    length += copied;
+    return size;    // a short count would make HTTPClient abort the transfer
+  }
+
+  int available() override{ return 0; }
+  int read() override{ return -1; }
+  int peek() override{ return -1; }
+
+  char *buffer;
+  size_t capacity;
+  size_t length;
+};
+
+int Esp32Http::get(const char *url, char *body, size_t capacity, size_t *length){
+  BufferSink sink(body, capacity);
+  client.begin(url);
+  int code = client.GET();
+  if(code > 0){
+    client.writeToStream(&sink);
+  }
+  client.end();
+
+  body[sink.length] = '\0';
+  *length = sink.length;
+  return code;
+}
+
+#endif
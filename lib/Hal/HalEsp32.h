@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef HAL_ESP32_H
+#define HAL_ESP32_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <HTTPClient.h>
+#include "Hal.h"
+
+/*  The watch's side of Hal.h, thin wrappers over the Arduino core, Wire and HTTPClient.
+ *  The display is U8g2Display (HalU8g2.h) on the U8G2 object  */
+
+/*  final and defined here, so calls on these types (lib/SensorDrivers' templates) are direct and inlined  */
+class Esp32Clock final : public HalClock{
+public:
+  uint32_t millis() override{ return ::millis(); }
+  uint32_t micros() override{ return ::micros(); }
+};
+
+class Esp32Adc final : public HalAdc{
+public:
+  uint16_t read(uint8_t pin) override{ return analogRead(pin); }
+};
+
+class Esp32Gpio final : public HalGpio{
+public:
+  bool read(uint8_t pin) override{ return digitalRead(pin) == HIGH; }
+  void write(uint8_t pin, bool level) override{ digitalWrite(pin, level ? HIGH : LOW); }
+};
+
+/*  Callers serialize bus access themselves, the watch goes through I2CBus  */
+class Esp32I2c final : public HalI2c{
+public:
+  explicit Esp32I2c(TwoWire &wire) : wire(wire){}
+  bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t length) override;
+  bool writeRegister(uint8_t address, uint8_t reg, uint8_t value) override;
+private:
+  TwoWire &wire;
+};
+
+/*  The body is streamed into the caller's buffer, no String copy of it  */
+class Esp32Http : public HalHttp{
+public:
+  explicit Esp32Http(HTTPClient &client) : client(client){}
+  int get(const char *url, char *body, size_t capacity, size_t *length) override;
+private:
+  HTTPClient &client;
+};
+
+#endif
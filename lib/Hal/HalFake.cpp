@@ -0,0 +1,43 @@
+#include "HalFake.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+uint16_t FakeAdc::read(uint8_t pin){
+  reads++;
+  return source ? source(pin, context) : value;
+}
+
+bool FakeI2c::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t length){
+  transactions++;
+  if(address != this->address || reg + length > sizeof(registers)){
+    return false;
+  }
+  memcpy(data, registers + reg, length);
+  return true;
+}
+
+bool FakeI2c::writeRegister(uint8_t address, uint8_t reg, uint8_t value){
+  transactions++;
+  if(address != this->address){
+    return false;
+  }
+  registers[reg] = value;
+  return true;
+}
+
+int FakeHttp::get(const char *url, char *body, size_t capacity, size_t *length){
+  requests++;
+  lastUrl = url;
+  size_t copied = 0;
+  if(response != nullptr && status > 0){
+    copied = strlen(response);
+    if(copied > capacity - 1){
+      copied = capacity - 1;
+    }
+    memcpy(body, response, copied);
+  }
+  body[copied] = '\0';
+  *length = copied;
+  return status;
+}
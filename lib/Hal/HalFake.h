@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef HAL_FAKE_H
+#define HAL_FAKE_H
+
+#include "Hal.h"
+#include "HalU8g2.h"
+
+/*  Linux side of Hal.h for the native environment: time only moves when told to, sensors return what
+ *  the caller set up, and the display is U8g2 drawing into its own buffer  */
+
+class FakeClock final : public HalClock{
+public:
+  uint32_t millis() override{ return (uint32_t)(nowUs / 1000); }
+  uint32_t micros() override{ return (uint32_t)nowUs; }
+  void advanceMs(uint32_t ms){ nowUs += (uint64_t)ms * 1000; }
+  void advanceUs(uint32_t us){ nowUs += us; }
+
+  uint64_t nowUs = 0;
+};
+
+/*  read() returns source(pin, context) when set, value otherwise  */
+class FakeAdc final : public HalAdc{
+public:
+  uint16_t read(uint8_t pin) override;
+
+  uint16_t (*source)(uint8_t pin, void *context) = nullptr;
+  void *context = nullptr;
+  uint16_t value = 0;
+  uint32_t reads = 0;
+};
+
+#define FAKE_GPIO_PINS 40
+
+class FakeGpio final : public HalGpio{
+public:
+  bool read(uint8_t pin) override{ return pin < FAKE_GPIO_PINS && levels[pin]; }
+  void write(uint8_t pin, bool level) override{
+    if(pin < FAKE_GPIO_PINS){
+      levels[pin] = level;
+    }
+  }
+
+  bool levels[FAKE_GPIO_PINS] = {};
+};
+
+/*  One device with a 256 byte register file, any other address does not answer  */
+class FakeI2c final : public HalI2c{
+public:
+  explicit FakeI2c(uint8_t address) : address(address){}
+  bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, size_t length) override;
+  bool writeRegister(uint8_t address, uint8_t reg, uint8_t value) override;
+
+  uint8_t address;
+  uint8_t registers[256] = {};
+  uint32_t transactions = 0;
+};
+
+/*  U8g2 full buffer for the watch's SH1106 with no bus behind it. Drawn through U8g2Display, the
+ *  native build renders with the real fonts, pixel for pixel what the panel would show  */
+class FakePanel{
+public:
+  FakePanel(){ u8g2_Setup_sh1106_128x64_noname_f(&u8g2, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb); }
+
+  u8g2_t u8g2;
+};
+
+/*  Answers every GET with status and body, or with status alone when body is NULL  */
+class FakeHttp : public HalHttp{
+public:
+  int get(const char *url, char *body, size_t capacity, size_t *length) override;
+
+  int status = 200;
+  const char *response = nullptr;
+  const char *lastUrl = nullptr;
+  uint32_t requests = 0;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "HalU8g2.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+/*  Indexed by HalFont  */
+static const uint8_t *const fonts[HAL_FONT_COUNT] = {
+  u8g2_font_5x7_tr,
+  u8g2_font_6x10_tr,
+  u8g2_font_helvR08_te,
+  u8g2_font_helvB08_tr,
+  u8g2_font_helvB10_te,
+  u8g2_font_helvB12_te,
+  u8g2_font_ncenB08_tr,
+  u8g2_font_logisoso20_tn,
+};
+
+void U8g2Display::setFont(HalFont font){
+  u8g2_SetFont(u8g2, fonts[font]);
+}
+
+void U8g2Display::drawTextf(int16_t x, int16_t y, const char *format, ...){
+  char text[HAL_TEXT_MAX];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  drawText(x, y, text);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef HAL_U8G2_H
+#define HAL_U8G2_H
+
+#include <clib/u8g2.h>
+#include "Hal.h"
+
+#define HAL_TEXT_MAX 64           // drawTextf() output, longer text is cut
+
+/*  Monochrome frame buffer in U8g2's tile layout, what FrameDiff diffs. Coordinates as in U8g2, text at
+ *  its baseline. It goes through U8g2's C core, so the watch (U8G2::getU8g2()) and the native build
+ *  (FakePanel) draw with the same code and fonts. Not virtual and defined here, every draw call of the
+ *  screens is a direct one. Draws into the buffer only, sending it stays with the caller  */
+class U8g2Display{
+public:
+  explicit U8g2Display(u8g2_t *u8g2) : u8g2(u8g2){}
+  void clear(){ u8g2_ClearBuffer(u8g2); }
+  void setFont(HalFont font);
+  void drawText(int16_t x, int16_t y, const char *text){ u8g2_DrawStr(u8g2, x, y, text); }
+  void drawBox(int16_t x, int16_t y, int16_t width, int16_t height){
+    u8g2_DrawBox(u8g2, x, y, width, height);
+  }
+  void drawFrame(int16_t x, int16_t y, int16_t width, int16_t height){
+    u8g2_DrawFrame(u8g2, x, y, width, height);
+  }
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1){ u8g2_DrawLine(u8g2, x0, y0, x1, y1); }
+  void drawHLine(int16_t x, int16_t y, int16_t width){ u8g2_DrawHLine(u8g2, x, y, width); }
+  const uint8_t *buffer(){ return u8g2_GetBufferPtr(u8g2); }
+
+  void drawTextf(int16_t x, int16_t y, const char *format, ...) __attribute__((format(printf, 4, 5)));
+private:
+  u8g2_t *u8g2;
+};
+
+#endif
@@ -0,0 +1,244 @@
+// sampling needs FreeRTOS and the IDF heap, the native build only uses HealthSnapshot
+#ifdef ARDUINO
+
+#include "HealthMonitor.h"
+
+#include <esp_heap_caps.h>
+
+// the idle hook estimate keeps both cores from sleeping, so it is a diagnostics build only
+#if (configGENERATE_RUN_TIME_STATS != 1) && defined(IDLE_LOAD_ENABLE)
+#define HEALTH_IDLE_LOAD
+#include <esp_freertos_hooks.h>
+#endif
+
+typedef struct{
+  const char *name;
+  QueueHandle_t handle;
+  uint16_t maxWaiting;
+}WatchedQueue;
+
+static WatchedQueue queues[HEALTH_MAX_QUEUES];
+static uint8_t queueCount = 0;
+
+static uint32_t period;
+static void (*sampleCallback)() = NULL;
+
+static SemaphoreHandle_t snapshotMutex_handle = NULL;
+static HealthSnapshot latest;                 // guarded by snapshotMutex_handle
+static HealthSnapshot working;                // monitor task only
+static volatile uint32_t latestSequence = 0;
+
+#if (configUSE_TRACE_FACILITY == 1)
+static TaskStatus_t statuses[HEALTH_MAX_TASKS];
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+/*  Run time counters of the previous sample, by handle: tasks come and go between samples  */
+static TaskHandle_t previousHandles[HEALTH_MAX_TASKS];
+static uint32_t previousRunTime[HEALTH_MAX_TASKS];
+static uint8_t previousCount = 0;
+static uint32_t previousTotal = 0;
+
+static uint32_t previousRunTimeOf(TaskHandle_t handle, uint32_t current){
+  for(uint8_t i = 0; i < previousCount; i++){
+    if(previousHandles[i] == handle){
+      return previousRunTime[i];
+    }
+  }
+  return current;   // new task: no share yet
+}
+
+static uint8_t percentOf(uint32_t part, uint32_t total){
+  if(total == 0){
+    return 0;
+  }
+  uint32_t percent = (uint64_t)part * 100 / total;
+  return percent > 100 ? 100 : percent;
+}
+#endif
+
+static void sampleTasks(HealthSnapshot *snapshot){
+  uint32_t total = 0;
+  UBaseType_t count = uxTaskGetSystemState(statuses, HEALTH_MAX_TASKS, &total);   // 0 if there are more tasks than slots
+  snapshot->taskCount = 0;
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+  // the first sample has nothing to take a difference against
+  bool runTimeValid = previousCount > 0;
+  uint32_t elapsed = total - previousTotal;
+#endif
+
+  for(UBaseType_t i = 0; i < count; i++){
+    const TaskStatus_t *status = &statuses[i];
+    HealthTask *task = &snapshot->tasks[snapshot->taskCount++];
+    strlcpy(task->name, status->pcTaskName, sizeof(task->name));
+    task->stackFree = status->usStackHighWaterMark;   // StackType_t is a byte on the ESP32
+    task->priority = status->uxCurrentPriority;
+    BaseType_t affinity = xTaskGetAffinity(status->xHandle);
+    task->core = affinity == tskNO_AFFINITY ? HEALTH_NO_AFFINITY : affinity;
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+    if(runTimeValid){
+      task->cpuPercent = percentOf(status->ulRunTimeCounter - previousRunTimeOf(status->xHandle, status->ulRunTimeCounter), elapsed);
+      for(uint8_t core = 0; core < HEALTH_CORES; core++){
+        if(status->xHandle == xTaskGetIdleTaskHandleForCPU(core)){
+          snapshot->cpuLoad[core] = 100 - task->cpuPercent;
+        }
+      }
+    }else{
+      task->cpuPercent = HEALTH_CPU_UNKNOWN;
+    }
+#else
+    task->cpuPercent = HEALTH_CPU_UNKNOWN;
+#endif
+  }
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+  for(UBaseType_t i = 0; i < count; i++){
+    previousHandles[i] = statuses[i].xHandle;
+    previousRunTime[i] = statuses[i].ulRunTimeCounter;
+  }
+  previousCount = count;
+  previousTotal = total;
+#endif
+
+  // tightest stack first, insertion sort is plenty for a few dozen tasks
+  for(uint8_t i = 1; i < snapshot->taskCount; i++){
+    HealthTask task = snapshot->tasks[i];
+    uint8_t j = i;
+    while(j > 0 && snapshot->tasks[j - 1].stackFree > task.stackFree){
+      snapshot->tasks[j] = snapshot->tasks[j - 1];
+      j--;
+    }
+    snapshot->tasks[j] = task;
+  }
+}
+#else
+static void sampleTasks(HealthSnapshot *snapshot){
+  snapshot->taskCount = 0;
+}
+#endif
+
+#ifdef HEALTH_IDLE_LOAD
+/*  Without run-time stats (the prebuilt Arduino core) each core's idle hook counts its passes instead.
+ *  The most passes seen in one period stand for a core that idled throughout, so the load is an
+ *  estimate that reads low until the core has had a quiet period. Returning false keeps the idle task
+ *  spinning rather than waiting for an interrupt, so the count follows idle time instead of ticks.
+ *  It also keeps the cores out of WFI and light sleep, hence -DIDLE_LOAD_ENABLE only  */
+static volatile uint32_t idlePasses[HEALTH_CORES];    // written by that core's idle task only
+static uint32_t previousIdlePasses[HEALTH_CORES];
+static uint32_t idlePassesPerPeriod[HEALTH_CORES];    // most seen, i.e. fully idle
+static bool idleSampled = false;
+
+static bool countIdlePass(){
+  idlePasses[xPortGetCoreID()]++;
+  return false;
+}
+
+static void sampleIdleLoad(HealthSnapshot *snapshot){
+  for(uint8_t core = 0; core < HEALTH_CORES; core++){
+    uint32_t passes = idlePasses[core];
+    uint32_t elapsed = passes - previousIdlePasses[core];
+    previousIdlePasses[core] = passes;
+    if(!idleSampled){
+      continue;   // the first sample has nothing to take a difference against
+    }
+    if(elapsed > idlePassesPerPeriod[core]){
+      idlePassesPerPeriod[core] = elapsed;
+    }
+    snapshot->cpuLoad[core] = idlePassesPerPeriod[core] == 0
+      ? 100 : 100 - (uint64_t)elapsed * 100 / idlePassesPerPeriod[core];
+  }
+  idleSampled = true;
+}
+#endif
+
+static void sampleQueues(HealthSnapshot *snapshot){
+  snapshot->queueCount = queueCount;
+  for(uint8_t i = 0; i < queueCount; i++){
+    WatchedQueue *queue = &queues[i];
+    HealthQueue *sample = &snapshot->queues[i];
+    sample->name = queue->name;
+    sample->waiting = uxQueueMessagesWaiting(queue->handle);
+    sample->length = sample->waiting + uxQueueSpacesAvailable(queue->handle);
+    if(sample->waiting > queue->maxWaiting){
+      queue->maxWaiting = sample->waiting;
+    }
+    sample->maxWaiting = queue->maxWaiting;
+  }
+}
+
+static void healthTask(void *parameters){
+  TickType_t lastWake = xTaskGetTickCount();
+
+  for(;;){
+    working.sequence++;
+    working.uptimeS = millis() / 1000;
+    working.heapFree = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    working.heapMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    working.heapLargestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    sampleTasks(&working);
+#ifdef HEALTH_IDLE_LOAD
+    sampleIdleLoad(&working);
+#endif
+    sampleQueues(&working);
+
+    xSemaphoreTake(snapshotMutex_handle, portMAX_DELAY);
+    latest = working;
+    xSemaphoreGive(snapshotMutex_handle);
+    latestSequence = working.sequence;
+
+    if(sampleCallback != NULL){
+      sampleCallback();
+    }
+
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(period));
+  }
+}
+
+void healthRegisterQueue(const char *name, QueueHandle_t queue){
+  if(queueCount < HEALTH_MAX_QUEUES && queue != NULL){
+    queues[queueCount++] = {name, queue, 0};
+  }
+}
+
+void healthBegin(uint32_t periodMs, void (*onSample)(), HealthStorage *storage, UBaseType_t taskPriority,
+                 BaseType_t core){
+  period = periodMs;
+  sampleCallback = onSample;
+  memset(&working, 0, sizeof(working));
+  memset(working.cpuLoad, HEALTH_CPU_UNKNOWN, sizeof(working.cpuLoad));
+  latest = working;
+  snapshotMutex_handle = xSemaphoreCreateMutexStatic(&storage->snapshotMutex);
+#ifdef HEALTH_IDLE_LOAD
+  for(uint8_t core = 0; core < HEALTH_CORES; core++){
+    esp_register_freertos_idle_hook_for_cpu(countIdlePass, core);
+  }
+#endif
+
+  xTaskCreateStaticPinnedToCore(
+    healthTask,
+    "HEALTH MONITOR",
+    HEALTH_TASK_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+}
+
+void healthGetSnapshot(HealthSnapshot *snapshot){
+  if(snapshotMutex_handle == NULL){
+    memset(snapshot, 0, sizeof(*snapshot));
+    return;
+  }
+  xSemaphoreTake(snapshotMutex_handle, portMAX_DELAY);
+  *snapshot = latest;
+  xSemaphoreGive(snapshotMutex_handle);
+}
+
+uint32_t healthSequence(){
+  return latestSequence;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+#include <Arduino.h>
+#include "HealthSnapshot.h"
+
+#define HEALTH_TASK_STACK 3072
+
+/*  The monitor task's and snapshot mutex's memory, reserved by the caller (see lib/StaticRtos)  */
+typedef struct{
+  StackType_t stack[HEALTH_TASK_STACK];
+  StaticTask_t tcb;
+  StaticSemaphore_t snapshotMutex;
+}HealthStorage;
+
+/*  Queues to watch, register them before healthBegin()  */
+void healthRegisterQueue(const char *name, QueueHandle_t queue);
+
+/*  Samples every periodMs: stacks and CPU time of every task (run-time stats when the core
+ *  was built with them, otherwise only the per-core load, estimated through idle hooks with -DIDLE_LOAD_ENABLE), heap and the
+ *  registered queues. onSample, if set, runs in the monitor task  */
+void healthBegin(uint32_t periodMs, void (*onSample)(), HealthStorage *storage, UBaseType_t taskPriority,
+                 BaseType_t core);
+
+void healthGetSnapshot(HealthSnapshot *snapshot);
+
+/*  Cheap check for a new snapshot, without copying one  */
+uint32_t healthSequence();
+
+#endif
@@ -0,0 +1,67 @@
+#include "HealthSnapshot.h"
+
+#include <JsonWriter.h>
+
+static void jsonAppendPercent(JsonWriter *writer, uint8_t percent){
+  if(percent == HEALTH_CPU_UNKNOWN){
+    jsonAppend(writer, "null");
+  }else{
+    jsonAppend(writer, "%u", (unsigned)percent);
+  }
+}
+
+size_t healthToJson(const HealthSnapshot *snapshot, char *out, size_t outSize){
+  if(outSize == 0){
+    return 0;
+  }
+  JsonWriter writer = {out, outSize, 0, false};
+
+  jsonAppend(&writer, "{\"seq\":%u,\"uptime\":%u,\"heap\":{\"free\":%u,\"min\":%u,\"largest\":%u},\"cpu\":[",
+    (unsigned)snapshot->sequence, (unsigned)snapshot->uptimeS, (unsigned)snapshot->heapFree,
+    (unsigned)snapshot->heapMinFree, (unsigned)snapshot->heapLargestBlock);
+  for(uint8_t core = 0; core < HEALTH_CORES; core++){
+    if(core > 0){
+      jsonAppend(&writer, ",");
+    }
+    jsonAppendPercent(&writer, snapshot->cpuLoad[core]);
+  }
+
+  jsonAppend(&writer, "],\"tasks\":[");
+  for(uint8_t i = 0; i < snapshot->taskCount; i++){
+    const HealthTask *task = &snapshot->tasks[i];
+    jsonAppend(&writer, "%s{\"name\":", i > 0 ? "," : "");
+    jsonAppendString(&writer, task->name);
+    jsonAppend(&writer, ",\"stack\":%u,\"prio\":%u,\"core\":", (unsigned)task->stackFree, (unsigned)task->priority);
+    if(task->core == HEALTH_NO_AFFINITY){
+      jsonAppend(&writer, "null");
+    }else{
+      jsonAppend(&writer, "%d", task->core);
+    }
+    jsonAppend(&writer, ",\"cpu\":");
+    jsonAppendPercent(&writer, task->cpuPercent);
+    jsonAppend(&writer, "}");
+  }
+
+  jsonAppend(&writer, "],\"queues\":[");
+  for(uint8_t i = 0; i < snapshot->queueCount; i++){
+    const HealthQueue *queue = &snapshot->queues[i];
+    jsonAppend(&writer, "%s{\"name\":", i > 0 ? "," : "");
+    jsonAppendString(&writer, queue->name);
+    jsonAppend(&writer, ",\"waiting\":%u,\"max\":%u,\"length\":%u}",
+      (unsigned)queue->waiting, (unsigned)queue->maxWaiting, (unsigned)queue->length);
+  }
+  jsonAppend(&writer, "]}");
+  return jsonFinish(&writer);
+}
+
+const HealthQueue *healthFullestQueue(const HealthSnapshot *snapshot){
+  const HealthQueue *fullest = NULL;
+  for(uint8_t i = 0; i < snapshot->queueCount; i++){
+    const HealthQueue *queue = &snapshot->queues[i];
+    // waiting / length > fullest->waiting / fullest->length, without the division
+    if(fullest == NULL || (uint32_t)queue->waiting * fullest->length > (uint32_t)fullest->waiting * queue->length){
+      fullest = queue;
+    }
+  }
+  return fullest;
+}
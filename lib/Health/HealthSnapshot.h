@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef HEALTH_SNAPSHOT_H
+#define HEALTH_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define HEALTH_MAX_TASKS 40           // ours plus the IDF's (idle, ipc, timers, WiFi, lwIP, async_tcp, mqtt...)
+#define HEALTH_MAX_QUEUES 12
+#define HEALTH_TASK_NAME_LENGTH 16    // configMAX_TASK_NAME_LEN
+#define HEALTH_CORES 2
+#define HEALTH_CPU_UNKNOWN 0xFF       // no sample to compare with yet, per task also without FreeRTOS run-time stats
+#define HEALTH_NO_AFFINITY -1
+#define HEALTH_JSON_MAX_LENGTH 4096
+
+typedef struct{
+  char name[HEALTH_TASK_NAME_LENGTH];
+  uint32_t stackFree;       // bytes, high-water mark: the least that was ever left
+  uint8_t priority;
+  int8_t core;              // HEALTH_NO_AFFINITY for unpinned tasks
+  uint8_t cpuPercent;       // of one core over the last period
+}HealthTask;
+
+typedef struct{
+  const char *name;
+  uint16_t waiting;
+  uint16_t maxWaiting;      // deepest seen at a sample, short bursts in between go unnoticed
+  uint16_t length;
+}HealthQueue;
+
+/*  One sample of the whole system, taken by the monitor task  */
+typedef struct{
+  uint32_t sequence;
+  uint32_t uptimeS;
+  uint32_t heapFree;
+  uint32_t heapMinFree;     // low-water mark since boot
+  uint32_t heapLargestBlock;
+  uint8_t cpuLoad[HEALTH_CORES];    // % busy, i.e. not in the core's idle task. Idle hook estimate without run-time stats
+  uint8_t taskCount;
+  uint8_t queueCount;
+  HealthTask tasks[HEALTH_MAX_TASKS];   // tightest stack first
+  HealthQueue queues[HEALTH_MAX_QUEUES];
+}HealthSnapshot;
+
+/*  Returns the JSON length, 0 if it does not fit  */
+size_t healthToJson(const HealthSnapshot *snapshot, char *out, size_t outSize);
+
+/*  Queue with the highest fill ratio right now, NULL without queues  */
+const HealthQueue *healthFullestQueue(const HealthSnapshot *snapshot);
+
+#endif
@@ -0,0 +1,115 @@
+#include "I2CBus.h"
+
+static QueueHandle_t i2cHighQueue_handle = NULL;
+static QueueHandle_t i2cLowQueue_handle = NULL;
+static TaskHandle_t i2cBus_handle = NULL;
+static portMUX_TYPE i2cStatsMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t lastReportUs = 0;
+
+static void recordTransaction(I2CClient *client, uint32_t waitUs, uint32_t busyUs){
+  uint8_t bucket = 0;
+  uint32_t bucketLimit = I2C_WAIT_FIRST_BUCKET_US;
+  while(bucket < I2C_WAIT_BUCKETS - 1 && waitUs >= bucketLimit){
+    bucket++;
+    bucketLimit <<= 1;
+  }
+
+  taskENTER_CRITICAL(&i2cStatsMux);
+  client->stats.transactions++;
+  client->stats.busyUs += busyUs;
+  client->stats.waitUs += waitUs;
+  if(waitUs > client->stats.maxWaitUs){
+    client->stats.maxWaitUs = waitUs;
+  }
+  client->stats.waitHistogram[bucket]++;
+  taskEXIT_CRITICAL(&i2cStatsMux);
+}
+
+static void i2cBusTask(void *parameters){
+  I2CTransaction transaction;
+
+  for(;;){
+    // one notification per queued transaction
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+
+    // sensor reads always go first, display tiles only when nothing urgent is waiting
+    if(xQueueReceive(i2cHighQueue_handle, &transaction, 0) != pdTRUE &&
+       xQueueReceive(i2cLowQueue_handle, &transaction, 0) != pdTRUE){
+      continue;
+    }
+
+    uint32_t startUs = micros();
+    transaction.run(transaction.context);
+    uint32_t endUs = micros();
+
+    recordTransaction(transaction.client, startUs - transaction.enqueuedUs, endUs - startUs);
+    xSemaphoreGive(transaction.client->done);
+  }
+}
+
+void i2cClientInit(I2CClient *client, const char *name, I2CPriority priority){
+  memset(client, 0, sizeof(I2CClient));
+  client->name = name;
+  client->priority = priority;
+  client->done = xSemaphoreCreateBinaryStatic(&client->doneBuffer);
+}
+
+void i2cBusInit(I2CBusStorage *storage, UBaseType_t taskPriority, BaseType_t core){
+  i2cHighQueue_handle = xQueueCreateStatic(I2C_BUS_QUEUE_SIZE, sizeof(I2CTransaction), storage->highStorage,
+                                           &storage->highQueue);
+  i2cLowQueue_handle = xQueueCreateStatic(I2C_BUS_QUEUE_SIZE, sizeof(I2CTransaction), storage->lowStorage,
+                                          &storage->lowQueue);
+  lastReportUs = micros();
+
+  i2cBus_handle = xTaskCreateStaticPinnedToCore(
+    i2cBusTask,
+    "I2C BUS MANAGER TASK",
+    I2C_BUS_TASK_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+}
+
+void i2cBusRun(I2CClient *client, I2CTransactionFn run, void *context){
+  if(i2cBus_handle == NULL){
+    // still in setup(), nobody to race with
+    run(context);
+    return;
+  }
+
+  I2CTransaction transaction = {client, run, context, (uint32_t)micros()};
+  QueueHandle_t queue = (client->priority == I2C_PRIORITY_HIGH) ? i2cHighQueue_handle : i2cLowQueue_handle;
+
+  xQueueSend(queue, &transaction, portMAX_DELAY);
+  xTaskNotifyGive(i2cBus_handle);
+  xSemaphoreTake(client->done, portMAX_DELAY);
+}
+
+void i2cBusPrintStats(Print &out, I2CClient *clients[], uint8_t clientCount){
+  uint32_t nowUs = micros();
+  uint32_t windowUs = nowUs - lastReportUs;
+  lastReportUs = nowUs;
+
+  for(uint8_t i = 0; i < clientCount; i++){
+    I2CClientStats stats;
+
+    taskENTER_CRITICAL(&i2cStatsMux);
+    stats = clients[i]->stats;
+    memset(&clients[i]->stats, 0, sizeof(I2CClientStats));
+    taskEXIT_CRITICAL(&i2cStatsMux);
+
+    out.printf("[I2C] %s: %u txn | bus %.1f%% | avg wait %u us | max wait %u us | wait hist",
+               clients[i]->name,
+               (unsigned)stats.transactions,
+               windowUs ? (100.0 * stats.busyUs) / windowUs : 0.0,
+               (unsigned)(stats.transactions ? stats.waitUs / stats.transactions : 0),
+               (unsigned)stats.maxWaitUs);
+    for(uint8_t bucket = 0; bucket < I2C_WAIT_BUCKETS; bucket++){
+      out.printf(" %u", (unsigned)stats.waitHistogram[bucket]);
+    }
+    out.println();
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+/*  Fastest clock both the SH1106 and the MPU6050 support (I2C fast mode)  */
+#define I2C_BUS_CLOCK 400000
+
+#define I2C_BUS_QUEUE_SIZE 8
+#define I2C_BUS_TASK_STACK 2048     // bytes
+
+/*  Wait-time histogram: bucket 0 is < 64 us, every next bucket doubles, the last one is open ended  */
+#define I2C_WAIT_BUCKETS 8
+#define I2C_WAIT_FIRST_BUCKET_US 64
+
+typedef enum{
+  I2C_PRIORITY_LOW,     // bulk transfers (display tiles)
+  I2C_PRIORITY_HIGH     // latency sensitive sensor reads
+}I2CPriority;
+
+typedef struct{
+  uint32_t transactions;
+  uint64_t busyUs;                          // time the bus spent on this client's transactions
+  uint64_t waitUs;                          // time its transactions sat in the queue
+  uint32_t maxWaitUs;
+  uint32_t waitHistogram[I2C_WAIT_BUCKETS];
+}I2CClientStats;
+
+typedef struct{
+  const char *name;
+  I2CPriority priority;
+  SemaphoreHandle_t done;     // given by the bus task when the client's transaction finished
+  StaticSemaphore_t doneBuffer;
+  I2CClientStats stats;
+}I2CClient;
+
+/*  A transaction is whatever Wire traffic `run` does, e.g. one MPU read or one display tile run  */
+typedef void (*I2CTransactionFn)(void *context);
+
+typedef struct{
+  I2CClient *client;
+  I2CTransactionFn run;
+  void *context;
+  uint32_t enqueuedUs;
+}I2CTransaction;
+
+/*  The bus task's and queues' memory, reserved by the caller (see lib/StaticRtos)  */
+typedef struct{
+  StackType_t stack[I2C_BUS_TASK_STACK];
+  StaticTask_t tcb;
+  uint8_t highStorage[I2C_BUS_QUEUE_SIZE * sizeof(I2CTransaction)];
+  uint8_t lowStorage[I2C_BUS_QUEUE_SIZE * sizeof(I2CTransaction)];
+  StaticQueue_t highQueue;
+  StaticQueue_t lowQueue;
+}I2CBusStorage;
+
+void i2cClientInit(I2CClient *client, const char *name, I2CPriority priority);
+
+/*  Creates the queues and the bus owner task, before this i2cBusRun() runs transactions inline  */
+void i2cBusInit(I2CBusStorage *storage, UBaseType_t taskPriority, BaseType_t core);
+
+/*  Queues the transaction by the client's priority and blocks until the bus task ran it  */
+void i2cBusRun(I2CClient *client, I2CTransactionFn run, void *context);
+
+/*  Prints per client utilization and wait histograms since the previous report  */
+void i2cBusPrintStats(Print &out, I2CClient *clients[], uint8_t clientCount);
+
+#endif
@@ -0,0 +1,57 @@
+#include "InputEvents.h"
+
+#define INPUT_EVENT_RING_MASK (INPUT_EVENT_RING_SIZE - 1)
+
+static_assert((INPUT_EVENT_RING_SIZE & INPUT_EVENT_RING_MASK) == 0, "INPUT_EVENT_RING_SIZE must be a power of two");
+
+void inputEventRingInit(InputEventRing *ring){
+  for(uint32_t i = 0; i < INPUT_EVENT_RING_SIZE; i++){
+    ring->cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  ring->enqueuePosition.store(0, std::memory_order_relaxed);
+  ring->dequeuePosition = 0;
+  ring->pushed.store(0, std::memory_order_relaxed);
+  ring->dropped.store(0, std::memory_order_relaxed);
+}
+
+bool INPUT_EVENT_ISR_ATTR inputEventPush(InputEventRing *ring, const InputEvent *event){
+  uint32_t position = ring->enqueuePosition.load(std::memory_order_relaxed);
+  InputEventCell *cell;
+
+  for(;;){
+    cell = &ring->cells[position & INPUT_EVENT_RING_MASK];
+    int32_t distance = (int32_t)(cell->sequence.load(std::memory_order_acquire) - position);
+
+    if(distance == 0){
+      // slot is free, claim it unless another producer got there first
+      if(ring->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+        break;
+      }
+    }else if(distance < 0){
+      // consumer is a full lap behind
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }else{
+      position = ring->enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->event = *event;
+  cell->sequence.store(position + 1, std::memory_order_release);
+  ring->pushed.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool inputEventPop(InputEventRing *ring, InputEvent *event){
+  uint32_t position = ring->dequeuePosition;
+  InputEventCell *cell = &ring->cells[position & INPUT_EVENT_RING_MASK];
+
+  if((int32_t)(cell->sequence.load(std::memory_order_acquire) - (position + 1)) < 0){
+    return false;
+  }
+
+  *event = cell->event;
+  cell->sequence.store(position + INPUT_EVENT_RING_SIZE, std::memory_order_release);
+  ring->dequeuePosition = position + 1;
+  return true;
+}
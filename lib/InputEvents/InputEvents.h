@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <atomic>
+
+/*  Pushing happens from GPIO ISRs, keep it callable while the flash cache is off  */
+#ifdef ESP32
+#include <esp_attr.h>
+#define INPUT_EVENT_ISR_ATTR IRAM_ATTR
+#else
+#define INPUT_EVENT_ISR_ATTR
+#endif
+
+/*  Must be a power of two  */
+#define INPUT_EVENT_RING_SIZE 32
+
+typedef enum : uint8_t{
+  INPUT_EDGE_PRESS,     // raw edge, button pulled the line low
+  INPUT_EDGE_RELEASE,   // raw edge, line back high
+  INPUT_GESTURE         // debounced gesture, see `gesture`
+}InputEventType;
+
+typedef struct{
+  uint32_t timestampUs;
+  uint8_t button;
+  uint8_t type;         // InputEventType
+  uint8_t gesture;      // GestureType for INPUT_GESTURE events, 0 for raw edges
+}InputEvent;
+
+typedef struct{
+  std::atomic<uint32_t> sequence;   // slot is writable when == position, readable when == position + 1
+  InputEvent event;
+}InputEventCell;
+
+/*  Bounded lock-free ring, any number of producers (ISRs on either core), one consumer task  */
+typedef struct{
+  InputEventCell cells[INPUT_EVENT_RING_SIZE];
+  std::atomic<uint32_t> enqueuePosition;
+  uint32_t dequeuePosition;         // consumer only
+  std::atomic<uint32_t> pushed;
+  std::atomic<uint32_t> dropped;    // ring was full
+}InputEventRing;
+
+void inputEventRingInit(InputEventRing *ring);
+
+/*  ISR safe, never blocks. Returns false and counts a drop when the ring is full  */
+bool inputEventPush(InputEventRing *ring, const InputEvent *event);
+
+/*  Consumer side, returns false when the ring is empty  */
+bool inputEventPop(InputEventRing *ring, InputEvent *event);
+
+#endif
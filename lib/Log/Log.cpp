@@ -0,0 +1,244 @@
+#include "Log.h"
+
+#include <stdio.h>
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+
+static_assert((LOG_RING_SIZE & LOG_RING_MASK) == 0, "LOG_RING_SIZE must be a power of two");
+static_assert(LOG_MAX_ARGS <= 16, "stringArgs has a bit per argument");
+
+static LogRing ring;
+static uint32_t maxDepth = 0;
+
+static const char levelLetters[] = {'-', 'E', 'W', 'I', 'D', 'V'};
+
+static bool ringReady = false;
+
+void logRingInit(){
+  for(uint32_t i = 0; i < LOG_RING_SIZE; i++){
+    ring.cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  ring.enqueuePosition.store(0, std::memory_order_relaxed);
+  ring.dequeuePosition = 0;
+  ring.written.store(0, std::memory_order_relaxed);
+  ring.dropped.store(0, std::memory_order_relaxed);
+  ringReady = true;
+}
+
+uint32_t logTimestampUs(){
+#ifdef ARDUINO
+  return micros();
+#else
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+LogRecord *logClaim(uint32_t *position){
+  if(!ringReady){
+    return NULL;
+  }
+  uint32_t claimed = ring.enqueuePosition.load(std::memory_order_relaxed);
+  LogCell *cell;
+
+  for(;;){
+    cell = &ring.cells[claimed & LOG_RING_MASK];
+    int32_t distance = (int32_t)(cell->sequence.load(std::memory_order_acquire) - claimed);
+
+    if(distance == 0){
+      if(ring.enqueuePosition.compare_exchange_weak(claimed, claimed + 1, std::memory_order_relaxed)){
+        break;
+      }
+    }else if(distance < 0){
+      // the drain task is a full lap behind, losing a line beats stalling the caller
+      ring.dropped.fetch_add(1, std::memory_order_relaxed);
+      return NULL;
+    }else{
+      claimed = ring.enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  *position = claimed;
+  return &cell->record;
+}
+
+void logCommit(uint32_t position){
+  ring.cells[position & LOG_RING_MASK].sequence.store(position + 1, std::memory_order_release);
+  ring.written.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool logNext(LogRecord *record){
+  uint32_t position = ring.dequeuePosition;
+  LogCell *cell = &ring.cells[position & LOG_RING_MASK];
+
+  if((int32_t)(cell->sequence.load(std::memory_order_acquire) - (position + 1)) < 0){
+    return false;
+  }
+
+  *record = cell->record;
+  cell->sequence.store(position + LOG_RING_SIZE, std::memory_order_release);
+  ring.dequeuePosition = position + 1;
+  return true;
+}
+
+static bool isConversion(char c){
+  return strchr("diouxXcsfFeEgGaAp", c) != NULL;
+}
+
+size_t logFormat(const LogRecord *record, char *out, size_t outSize){
+  uint32_t ms = record->timestampUs / 1000;
+  int length = snprintf(out, outSize, "%u.%03u %c [%s] ", (unsigned)(ms / 1000), (unsigned)(ms % 1000),
+                        levelLetters[record->level < sizeof(levelLetters) ? record->level : 0], record->tag);
+  if(length < 0 || (size_t)length >= outSize){
+    return outSize - 1;
+  }
+
+  size_t used = length;
+  uint8_t argIndex = 0;
+  const char *p = record->format;
+
+  while(*p && used < outSize - 1){
+    if(*p != '%'){
+      out[used++] = *p++;
+      continue;
+    }
+    if(p[1] == '%'){
+      out[used++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // copy the spec without length modifiers, every argument is 32 bit wide already
+    char spec[16];
+    size_t specLength = 0;
+    spec[specLength++] = *p++;
+    while(*p && !isConversion(*p)){
+      if(strchr("hlzjtL", *p) == NULL && specLength < sizeof(spec) - 2){
+        spec[specLength++] = *p;
+      }
+      p++;
+    }
+    if(*p == '\0'){
+      break;
+    }
+    char conversion = *p++;
+    spec[specLength++] = conversion;
+    spec[specLength] = '\0';
+
+    if(argIndex >= record->argCount){
+      continue;
+    }
+    uint32_t arg = record->args[argIndex];
+    bool isString = record->stringArgs & (1u << argIndex);
+    argIndex++;
+
+    int written;
+    size_t room = outSize - used;
+    switch(conversion){
+    case 's':
+      written = snprintf(out + used, room, spec, isString ? record->strings + (arg < LOG_STRING_BYTES ? arg : LOG_STRING_BYTES - 1) : "?");
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':{
+      float value;
+      memcpy(&value, &arg, sizeof(value));
+      written = snprintf(out + used, room, spec, (double)value);
+      break;
+    }
+    case 'd': case 'i': case 'c':
+      written = snprintf(out + used, room, spec, (int)arg);
+      break;
+    case 'p':
+      written = snprintf(out + used, room, spec, (void *)(uintptr_t)arg);
+      break;
+    default:
+      written = snprintf(out + used, room, spec, (unsigned)arg);
+      break;
+    }
+    if(written < 0){
+      break;
+    }
+    used += ((size_t)written < room) ? (size_t)written : room - 1;
+  }
+
+  // strip the caller's newline, every line gets exactly one
+  while(used > 0 && (out[used - 1] == '\n' || out[used - 1] == '\r')){
+    used--;
+  }
+  if(used > outSize - 2){
+    used = outSize - 2;
+  }
+  out[used++] = '\n';
+  out[used] = '\0';
+  return used;
+}
+
+// the drain task and the output only exist on the watch
+#ifdef ARDUINO
+static Print * volatile output = NULL;   // swapped by logSetOutput() while the drain task runs
+
+void logWriteDirect(const LogRecord *record){
+  char line[LOG_LINE_MAX];
+  size_t length = logFormat(record, line, sizeof(line));
+  if(output != NULL){
+    output->write((const uint8_t *)line, length);
+  }
+}
+
+static void logTask(void *parameters){
+  char line[LOG_LINE_MAX];
+  LogRecord record;
+  uint32_t reportedDrops = 0;
+
+  for(;;){
+    uint32_t depth = ring.enqueuePosition.load(std::memory_order_relaxed) - ring.dequeuePosition;
+    if(depth > maxDepth){
+      maxDepth = depth;
+    }
+
+    if(!logNext(&record)){
+      uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+      if(dropped != reportedDrops){
+        int length = snprintf(line, sizeof(line), "[Log] %u lines dropped\n", (unsigned)(dropped - reportedDrops));
+        output->write((const uint8_t *)line, length);
+        reportedDrops = dropped;
+      }
+      vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD));
+      continue;
+    }
+
+    size_t length = logFormat(&record, line, sizeof(line));
+    output->write((const uint8_t *)line, length);
+  }
+}
+
+void logInit(Print &out, LogStorage *storage, uint32_t taskPriority, int core){
+  output = &out;
+  logRingInit();
+
+#ifndef LOG_DIRECT
+  xTaskCreateStaticPinnedToCore(
+    logTask,
+    "LOG DRAIN",
+    LOG_DRAIN_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+#endif
+}
+
+void logSetOutput(Print &out){
+  output = &out;
+}
+#endif
+
+void logGetStats(LogStats *stats){
+  stats->written = ring.written.load(std::memory_order_relaxed);
+  stats->dropped = ring.dropped.load(std::memory_order_relaxed);
+  stats->maxDepth = maxDepth;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <atomic>
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+#define LOG_LEVEL_VERBOSE 5
+
+/*  Anything above this level is compiled out, arguments included: -DLOG_LEVEL=LOG_LEVEL_DEBUG  */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+/*  Must be a power of two  */
+#define LOG_RING_SIZE 64
+#define LOG_MAX_ARGS 10
+#define LOG_STRING_BYTES 32     // %s arguments are copied in here, truncated when they run out of room
+#define LOG_LINE_MAX 192
+#define LOG_DRAIN_PERIOD 10     // ms the drain task sleeps once the ring is empty
+#define LOG_DRAIN_STACK 3072    // bytes
+
+/*  Producers only store the format pointer and the raw arguments, the drain task does the formatting.
+ *  So tag and format must be string literals, and only 32 bit integers, floats and strings are taken  */
+#define LOG_E(tag, ...) LOG_AT(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define LOG_W(tag, ...) LOG_AT(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define LOG_I(tag, ...) LOG_AT(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define LOG_D(tag, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define LOG_V(tag, ...) LOG_AT(LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+
+// the constant condition lets the compiler drop disabled calls while still type checking them
+#define LOG_AT(level, tag, ...) do{ if((level) <= LOG_LEVEL){ logWrite((level), (tag), __VA_ARGS__); } }while(0)
+
+typedef struct{
+  uint32_t timestampUs;
+  const char *tag;
+  const char *format;
+  uint8_t level;
+  uint8_t argCount;
+  uint8_t stringBytes;          // used part of `strings`
+  uint16_t stringArgs;          // bit i set: args[i] is an offset into `strings`
+  uint32_t args[LOG_MAX_ARGS];  // integers and float bit patterns
+  char strings[LOG_STRING_BYTES];
+}LogRecord;
+
+typedef struct{
+  std::atomic<uint32_t> sequence;   // slot is writable when == position, readable when == position + 1
+  LogRecord record;
+}LogCell;
+
+/*  Bounded lock-free ring, any task can log, the drain task is the only consumer  */
+typedef struct{
+  LogCell cells[LOG_RING_SIZE];
+  std::atomic<uint32_t> enqueuePosition;
+  uint32_t dequeuePosition;         // consumer only
+  std::atomic<uint32_t> written;
+  std::atomic<uint32_t> dropped;    // ring was full
+}LogRing;
+
+typedef struct{
+  uint32_t written;
+  uint32_t dropped;
+  uint32_t maxDepth;        // most records waiting at once, seen by the drain task
+}LogStats;
+
+#ifdef ARDUINO
+/*  The drain task's memory, reserved by the caller (see lib/StaticRtos). LOG_DIRECT has no drain task  */
+typedef struct{
+#ifndef LOG_DIRECT
+  StackType_t stack[LOG_DRAIN_STACK];
+  StaticTask_t tcb;
+#endif
+}LogStorage;
+
+/*  Starts the drain task writing to `out`, call it first in setup(): lines logged before it are lost  */
+void logInit(Print &out, LogStorage *storage, uint32_t taskPriority, int core);
+
+/*  Redirects the drain task, a line already being written still goes to the old output  */
+void logSetOutput(Print &out);
+#endif
+
+/*  Empties the ring, logInit() does it on the watch. The native runner drives the ring on its own
+ *  with this and logNext(), only the drain task and the output need the Arduino core  */
+void logRingInit();
+
+/*  Oldest committed record, false when the ring is empty. Single consumer: the drain task on the watch  */
+bool logNext(LogRecord *record);
+
+/*  Claims a free record, NULL and a counted drop when the ring is full. logCommit() hands it to the drain task  */
+LogRecord *logClaim(uint32_t *position);
+void logCommit(uint32_t position);
+
+/*  Expands the record's format with its arguments, returns the length  */
+size_t logFormat(const LogRecord *record, char *out, size_t outSize);
+
+void logGetStats(LogStats *stats);
+
+/*  LOG_DIRECT formats and writes right in the caller, only meant to compare against the ring  */
+void logWriteDirect(const LogRecord *record);
+
+uint32_t logTimestampUs();
+
+namespace logDetail{
+
+inline void captureValue(LogRecord *record, uint32_t value){
+  record->args[record->argCount++] = value;
+}
+
+inline void captureOne(LogRecord *record, int value){ captureValue(record, (uint32_t)value); }
+inline void captureOne(LogRecord *record, unsigned int value){ captureValue(record, value); }
+inline void captureOne(LogRecord *record, long value){ captureValue(record, (uint32_t)value); }
+inline void captureOne(LogRecord *record, unsigned long value){ captureValue(record, (uint32_t)value); }
+inline void captureOne(LogRecord *record, short value){ captureValue(record, (uint32_t)(int)value); }
+inline void captureOne(LogRecord *record, unsigned short value){ captureValue(record, value); }
+inline void captureOne(LogRecord *record, char value){ captureValue(record, (uint32_t)(int)value); }
+inline void captureOne(LogRecord *record, signed char value){ captureValue(record, (uint32_t)(int)value); }
+inline void captureOne(LogRecord *record, unsigned char value){ captureValue(record, value); }
+inline void captureOne(LogRecord *record, bool value){ captureValue(record, value); }
+
+inline void captureOne(LogRecord *record, double value){
+  float narrowed = (float)value;
+  uint32_t bits;
+  memcpy(&bits, &narrowed, sizeof(bits));
+  captureValue(record, bits);
+}
+
+// copied now, the caller's buffer may be gone by the time the drain task formats
+inline void captureOne(LogRecord *record, const char *value){
+  uint8_t offset = record->stringBytes;
+  size_t room = LOG_STRING_BYTES - offset;
+  if(room == 0){
+    offset = LOG_STRING_BYTES - 1;    // out of room, points at the terminating '\0'
+  }else{
+    size_t length = value ? strlen(value) : 0;
+    if(length >= room){
+      length = room - 1;
+    }
+    if(length > 0){
+      memcpy(record->strings + offset, value, length);
+    }
+    record->strings[offset + length] = '\0';
+    record->stringBytes = offset + length + 1;
+  }
+  record->stringArgs |= 1u << record->argCount;
+  captureValue(record, offset);
+}
+
+inline void captureOne(LogRecord *record, char *value){ captureOne(record, (const char *)value); }
+inline void captureOne(LogRecord *record, const void *value){ captureValue(record, (uint32_t)(uintptr_t)value); }
+
+inline void capture(LogRecord *){}
+
+template<typename T, typename... Rest>
+inline void capture(LogRecord *record, T value, Rest... rest){
+  captureOne(record, value);
+  capture(record, rest...);
+}
+
+}
+
+/*  What a log call stores, the same for the ring and LOG_DIRECT  */
+template<typename... Args>
+void logFill(LogRecord *record, uint8_t level, const char *tag, const char *format, Args... args){
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments, raise LOG_MAX_ARGS or split the line");
+
+  record->level = level;
+  record->tag = tag;
+  record->format = format;
+  record->argCount = 0;
+  record->stringBytes = 0;
+  record->stringArgs = 0;
+  record->strings[LOG_STRING_BYTES - 1] = '\0';
+  record->timestampUs = logTimestampUs();
+  logDetail::capture(record, args...);
+}
+
+template<typename... Args>
+void logWrite(uint8_t level, const char *tag, const char *format, Args... args){
+#ifdef LOG_DIRECT
+  LogRecord record;
+  logFill(&record, level, tag, format, args...);
+  logWriteDirect(&record);
+#else
+  uint32_t position;
+  LogRecord *record = logClaim(&position);
+  if(record == NULL){
+    return;
+  }
+  logFill(record, level, tag, format, args...);
+  logCommit(position);
+#endif
+}
+
+#endif
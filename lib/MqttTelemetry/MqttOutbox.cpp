@@ -0,0 +1,93 @@
+#include "MqttOutbox.h"
+
+#include <string.h>
+
+static uint8_t slotAt(const MqttOutbox *outbox, uint8_t index){
+  return (outbox->head + index) % MQTT_OUTBOX_SLOTS;
+}
+
+static void clearSlot(MqttOutbox *outbox, uint8_t slot){
+  outbox->msgIds[slot] = MQTT_OUTBOX_NO_MSG_ID;
+  outbox->acked[slot] = false;
+}
+
+void mqttOutboxInit(MqttOutbox *outbox){
+  memset(outbox, 0, sizeof(MqttOutbox));
+  for(uint8_t slot = 0; slot < MQTT_OUTBOX_SLOTS; slot++){
+    clearSlot(outbox, slot);
+  }
+}
+
+void mqttOutboxPush(MqttOutbox *outbox, const TelemetryBatch *batch){
+  if(outbox->count == MQTT_OUTBOX_SLOTS){
+    // an in-flight oldest batch may still get its PUBACK, the ack then finds no slot and is ignored
+    clearSlot(outbox, outbox->head);
+    outbox->head = slotAt(outbox, 1);
+    outbox->count--;
+    outbox->dropped++;
+  }
+  uint8_t slot = slotAt(outbox, outbox->count);
+  outbox->batches[slot] = *batch;
+  clearSlot(outbox, slot);
+  outbox->count++;
+}
+
+const TelemetryBatch *mqttOutboxNextUnsent(MqttOutbox *outbox, uint8_t *slot){
+  for(uint8_t i = 0; i < outbox->count; i++){
+    uint8_t candidate = slotAt(outbox, i);
+    if(outbox->msgIds[candidate] == MQTT_OUTBOX_NO_MSG_ID && !outbox->acked[candidate]){
+      *slot = candidate;
+      return &outbox->batches[candidate];
+    }
+  }
+  return NULL;
+}
+
+void mqttOutboxSent(MqttOutbox *outbox, uint8_t slot, int msgId, uint32_t nowMs){
+  outbox->msgIds[slot] = msgId;
+  outbox->sentMs[slot] = nowMs;
+}
+
+int mqttOutboxAck(MqttOutbox *outbox, int msgId){
+  int found = -1;
+  for(uint8_t i = 0; i < outbox->count; i++){
+    uint8_t slot = slotAt(outbox, i);
+    if(outbox->msgIds[slot] == msgId && !outbox->acked[slot]){
+      outbox->acked[slot] = true;
+      found = slot;
+      break;
+    }
+  }
+
+  // acks can arrive out of order, the ring only shrinks from the head
+  while(outbox->count > 0 && outbox->acked[outbox->head]){
+    clearSlot(outbox, outbox->head);
+    outbox->head = slotAt(outbox, 1);
+    outbox->count--;
+  }
+  return found;
+}
+
+uint8_t mqttOutboxExpire(MqttOutbox *outbox, uint32_t nowMs, uint32_t timeoutMs){
+  uint8_t expired = 0;
+  for(uint8_t i = 0; i < outbox->count; i++){
+    uint8_t slot = slotAt(outbox, i);
+    if(outbox->msgIds[slot] != MQTT_OUTBOX_NO_MSG_ID && !outbox->acked[slot]
+        && nowMs - outbox->sentMs[slot] >= timeoutMs){
+      outbox->msgIds[slot] = MQTT_OUTBOX_NO_MSG_ID;
+      expired++;
+    }
+  }
+  return expired;
+}
+
+uint8_t mqttOutboxInFlight(const MqttOutbox *outbox){
+  uint8_t inFlight = 0;
+  for(uint8_t i = 0; i < outbox->count; i++){
+    uint8_t slot = slotAt(outbox, i);
+    if(outbox->msgIds[slot] != MQTT_OUTBOX_NO_MSG_ID && !outbox->acked[slot]){
+      inFlight++;
+    }
+  }
+  return inFlight;
+}
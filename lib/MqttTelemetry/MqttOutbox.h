@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef MQTT_OUTBOX_H
+#define MQTT_OUTBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <TelemetryBatch.h>
+
+#define MQTT_OUTBOX_SLOTS 32      // ~3.5 KB, 32 batches survive an outage
+#define MQTT_OUTBOX_NO_MSG_ID -1
+
+/*  Bounded FIFO of closed batches. A batch leaves only once the broker acked it (QoS1),
+ *  while offline the oldest batch is overwritten when the ring is full  */
+typedef struct{
+  TelemetryBatch batches[MQTT_OUTBOX_SLOTS];
+  int msgIds[MQTT_OUTBOX_SLOTS];   // msg id of the in-flight publish, MQTT_OUTBOX_NO_MSG_ID if not sent
+  uint32_t sentMs[MQTT_OUTBOX_SLOTS];
+  bool acked[MQTT_OUTBOX_SLOTS];
+  uint8_t head;                    // oldest batch
+  uint8_t count;
+  uint32_t dropped;                // batches overwritten while the ring was full
+}MqttOutbox;
+
+void mqttOutboxInit(MqttOutbox *outbox);
+
+void mqttOutboxPush(MqttOutbox *outbox, const TelemetryBatch *batch);
+
+/*  Oldest batch not published yet, NULL if every batch is in flight. *slot is what mqttOutboxSent() takes  */
+const TelemetryBatch *mqttOutboxNextUnsent(MqttOutbox *outbox, uint8_t *slot);
+
+void mqttOutboxSent(MqttOutbox *outbox, uint8_t slot, int msgId, uint32_t nowMs);
+
+/*  Marks the batch published as msgId delivered, returns its slot or -1 for unknown ids (e.g. a duplicate PUBACK)  */
+int mqttOutboxAck(MqttOutbox *outbox, int msgId);
+
+/*  Batches in flight for longer than timeoutMs go out again, returns how many.
+ *  Covers PUBACKs lost with a dropped connection, QoS1 makes the duplicates harmless  */
+uint8_t mqttOutboxExpire(MqttOutbox *outbox, uint32_t nowMs, uint32_t timeoutMs);
+
+uint8_t mqttOutboxInFlight(const MqttOutbox *outbox);
+
+#endif
@@ -0,0 +1,193 @@
+#include "MqttTelemetry.h"
+#include "MqttOutbox.h"
+
+#include <TelemetryBatch.h>
+#include <WiFi.h>
+#include <mqtt_client.h>
+
+static const MqttTelemetryConfig *config;
+static esp_mqtt_client_handle_t client;
+
+/*  The esp-mqtt task only posts its events here, the outbox belongs to mqttTelemetryTask alone  */
+static QueueHandle_t clientEvents_handle;
+static TaskHandle_t mqttTelemetryTask_handle;
+
+static portMUX_TYPE snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+static TelemetrySnapshot latest;
+
+static MqttOutbox outbox;
+static volatile bool windowOpen = true;
+static MqttTelemetryStats stats;
+static uint32_t payloadLengths[MQTT_OUTBOX_SLOTS];   // of the publish in flight per outbox slot
+
+static void mqttEventHandler(void *arg, esp_event_base_t base, int32_t eventId, void *eventData){
+  esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)eventData;
+  MqttClientEvent clientEvent;
+
+  switch((esp_mqtt_event_id_t)eventId){
+  case MQTT_EVENT_CONNECTED:
+    clientEvent.type = MQTT_CLIENT_CONNECTED;
+    break;
+  case MQTT_EVENT_DISCONNECTED:
+    clientEvent.type = MQTT_CLIENT_DISCONNECTED;
+    break;
+  case MQTT_EVENT_PUBLISHED:
+    clientEvent.type = MQTT_CLIENT_PUBLISHED;
+    break;
+  default:
+    return;
+  }
+  clientEvent.msgId = event->msg_id;
+
+  if(xQueueSend(clientEvents_handle, &clientEvent, 0) != pdTRUE){
+    stats.eventsLost++;
+  }
+  xTaskNotifyGive(mqttTelemetryTask_handle);
+}
+
+static void handleClientEvent(const MqttClientEvent *event){
+  switch(event->type){
+  case MQTT_CLIENT_CONNECTED:
+    stats.connected = true;
+    break;
+  case MQTT_CLIENT_DISCONNECTED:
+    stats.connected = false;
+    break;
+  case MQTT_CLIENT_PUBLISHED:{
+    int slot = mqttOutboxAck(&outbox, event->msgId);
+    if(slot >= 0){
+      stats.acked++;
+      stats.bytesAcked += payloadLengths[slot];
+    }
+    break;
+  }
+  }
+}
+
+static void closeBatch(TelemetryBatch *batch){
+  batch->rssi = stats.connected ? WiFi.RSSI() : 0;
+  batch->freeHeap = ESP.getFreeHeap();
+  batch->minFreeHeap = ESP.getMinFreeHeap();
+  mqttOutboxPush(&outbox, batch);
+  stats.batches++;
+}
+
+static void publishPending(){
+  static char payload[TELEMETRY_BATCH_JSON_MAX_LENGTH];
+
+  stats.retransmits += mqttOutboxExpire(&outbox, millis(), MQTT_ACK_TIMEOUT);
+
+  uint8_t slot;
+  const TelemetryBatch *batch;
+  while(windowOpen && stats.connected && mqttOutboxInFlight(&outbox) < config->maxInFlight
+        && (batch = mqttOutboxNextUnsent(&outbox, &slot)) != NULL){
+    size_t length = telemetryBatchToJson(batch, payload, sizeof(payload));
+    // enqueue copies the payload and leaves the socket write to the esp-mqtt task
+    int msgId = esp_mqtt_client_enqueue(client, config->topic, payload, length, 1, 0, true);
+    if(msgId < 0){
+      break;
+    }
+    payloadLengths[slot] = length;
+    mqttOutboxSent(&outbox, slot, msgId, millis());
+    stats.published++;
+  }
+
+  stats.queued = outbox.count;
+  stats.inFlight = mqttOutboxInFlight(&outbox);
+  stats.dropped = outbox.dropped;
+}
+
+static void mqttTelemetryTask(void *parameters){
+  const uint32_t samplePeriodMs = config->samplePeriodS * 1000UL;
+  const uint32_t batchIntervalMs = config->batchIntervalS * 1000UL;
+  uint32_t sequence = 0;
+
+  TelemetryBatch batch;
+  uint32_t batchOpenedMs = millis();
+  uint32_t lastSampleMs = batchOpenedMs;
+  telemetryBatchStart(&batch, sequence++, batchOpenedMs / 1000, config->samplePeriodS);
+
+  for(;;){
+    uint32_t sinceSample = millis() - lastSampleMs;
+    ulTaskNotifyTake(pdTRUE, sinceSample >= samplePeriodMs ? 0 : pdMS_TO_TICKS(samplePeriodMs - sinceSample));
+
+    MqttClientEvent event;
+    while(xQueueReceive(clientEvents_handle, &event, 0) == pdTRUE){
+      handleClientEvent(&event);
+    }
+
+    uint32_t now = millis();
+    if(now - lastSampleMs >= samplePeriodMs){
+      lastSampleMs += samplePeriodMs;
+
+      TelemetrySnapshot snapshot;
+      portENTER_CRITICAL(&snapshotLock);
+      snapshot = latest;
+      portEXIT_CRITICAL(&snapshotLock);
+
+      bool full = telemetryBatchAdd(&batch, &snapshot);
+      if(full || now - batchOpenedMs >= batchIntervalMs){
+        closeBatch(&batch);
+        batchOpenedMs = now;
+        telemetryBatchStart(&batch, sequence++, now / 1000, config->samplePeriodS);
+      }
+    }
+
+    publishPending();
+  }
+}
+
+void mqttTelemetryBegin(const MqttTelemetryConfig *telemetryConfig, MqttTelemetryStorage *storage, UBaseType_t taskPriority,
+                        BaseType_t core){
+  config = telemetryConfig;
+  memset(&stats, 0, sizeof(stats));
+  mqttOutboxInit(&outbox);
+  clientEvents_handle = xQueueCreateStatic(MQTT_EVENT_QUEUE_SIZE, sizeof(MqttClientEvent), storage->eventStorage,
+                                           &storage->events);
+
+  mqttTelemetryTask_handle = xTaskCreateStaticPinnedToCore(
+    mqttTelemetryTask,
+    "MQTT TELEMETRY",
+    MQTT_TELEMETRY_TASK_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+
+  esp_mqtt_client_config_t clientConfig = {};
+  clientConfig.uri = config->brokerUri;
+  clientConfig.username = config->username;
+  clientConfig.password = config->password;
+  clientConfig.reconnect_timeout_ms = MQTT_RECONNECT_TIMEOUT;   // the default 10 s is a whole window
+  client = esp_mqtt_client_init(&clientConfig);
+  esp_mqtt_client_register_event(client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, mqttEventHandler, NULL);
+  esp_mqtt_client_start(client);
+}
+
+void mqttTelemetryPublish(const TelemetrySnapshot *snapshot){
+  portENTER_CRITICAL(&snapshotLock);
+  latest = *snapshot;
+  portEXIT_CRITICAL(&snapshotLock);
+}
+
+void mqttTelemetrySetWindow(bool open){
+  bool opened = open && !windowOpen;
+  windowOpen = open;
+  if(opened && mqttTelemetryTask_handle != NULL){
+    xTaskNotifyGive(mqttTelemetryTask_handle);
+  }
+}
+
+bool mqttTelemetryPending(){
+  return stats.queued > 0;
+}
+
+bool mqttTelemetryConnected(){
+  return stats.connected;
+}
+
+void mqttTelemetryGetStats(MqttTelemetryStats *out){
+  *out = stats;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#ifndef MQTT_TELEMETRY_H
+#define MQTT_TELEMETRY_H
+
+#include <Arduino.h>
+#include <Telemetry.h>
+
+#define MQTT_TELEMETRY_TASK_STACK 4096
+#define MQTT_EVENT_QUEUE_SIZE 16
+#define MQTT_ACK_TIMEOUT 60000        // ms a QoS1 publish may wait for its PUBACK before it is sent again
+#define MQTT_RECONNECT_TIMEOUT 1000   // ms before the client reconnects, a radio window is only seconds long
+
+typedef struct{
+  const char *brokerUri;      // e.g. "mqtt://192.168.1.10:1883"
+  const char *username;       // NULL for anonymous brokers
+  const char *password;
+  const char *topic;
+  uint16_t samplePeriodS;     // one record per period
+  uint16_t batchIntervalS;    // a batch closes after this long or when it is full
+  uint8_t maxInFlight;        // unacked QoS1 publishes at a time
+}MqttTelemetryConfig;
+
+typedef struct{
+  bool connected;
+  uint32_t batches;           // closed batches
+  uint32_t published;         // publishes handed to the client, retransmits included
+  uint32_t retransmits;       // publishes repeated after MQTT_ACK_TIMEOUT
+  uint32_t acked;
+  uint32_t bytesAcked;        // payload bytes of the acked publishes
+  uint32_t dropped;           // batches lost to a full offline buffer
+  uint32_t eventsLost;        // client events that found the event queue full
+  uint8_t queued;             // batches waiting in the offline buffer, in flight ones included
+  uint8_t inFlight;
+}MqttTelemetryStats;
+
+typedef enum : uint8_t{
+  MQTT_CLIENT_CONNECTED,
+  MQTT_CLIENT_DISCONNECTED,
+  MQTT_CLIENT_PUBLISHED       // PUBACK for msgId
+}MqttClientEventType;
+
+typedef struct{
+  MqttClientEventType type;
+  int msgId;
+}MqttClientEvent;
+
+/*  The batching task's and event queue's memory, reserved by the caller (see lib/StaticRtos).
+ *  The esp-mqtt client still allocates its own task and buffers  */
+typedef struct{
+  StackType_t stack[MQTT_TELEMETRY_TASK_STACK];
+  StaticTask_t tcb;
+  uint8_t eventStorage[MQTT_EVENT_QUEUE_SIZE * sizeof(MqttClientEvent)];
+  StaticQueue_t events;
+}MqttTelemetryStorage;
+
+/*  Starts the esp-mqtt client and the batching task. The client connects and reconnects on its own,
+ *  batches pile up in the offline buffer meanwhile  */
+void mqttTelemetryBegin(const MqttTelemetryConfig *config, MqttTelemetryStorage *storage, UBaseType_t taskPriority,
+                        BaseType_t core);
+
+/*  Latest snapshot, the task samples whatever is current once per samplePeriodS  */
+void mqttTelemetryPublish(const TelemetrySnapshot *snapshot);
+
+/*  Publishing is held back while the network window is closed, open by default  */
+void mqttTelemetrySetWindow(bool open);
+
+/*  True while batches wait for a publish or a PUBACK  */
+bool mqttTelemetryPending();
+
+/*  True while the client has a session with the broker  */
+bool mqttTelemetryConnected();
+
+void mqttTelemetryGetStats(MqttTelemetryStats *stats);
+
+#endif
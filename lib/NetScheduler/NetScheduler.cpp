@@ -0,0 +1,65 @@
+#include "NetScheduler.h"
+
+#include <string.h>
+
+void netSchedulerInit(NetScheduler *scheduler, const NetSchedulerConfig *config, uint32_t nowMs){
+  memset(scheduler, 0, sizeof(NetScheduler));
+  scheduler->config = config;
+  scheduler->state = NET_SCHED_IDLE;
+  scheduler->nextWindowMs = nowMs;
+}
+
+void netSchedulerRequest(NetScheduler *scheduler, uint32_t clients){
+  if(scheduler->state == NET_SCHED_WINDOW){
+    scheduler->active |= clients;
+  }else{
+    scheduler->requested |= clients;
+  }
+}
+
+void netSchedulerDone(NetScheduler *scheduler, uint32_t clients){
+  // also drops work a budget overrun carried over, the client finished it after all
+  scheduler->active &= ~clients;
+  scheduler->requested &= ~clients;
+}
+
+NetRadioAction netSchedulerUpdate(NetScheduler *scheduler, uint32_t nowMs){
+  const NetSchedulerConfig *config = scheduler->config;
+
+  switch(scheduler->state){
+  case NET_SCHED_IDLE:
+    if(scheduler->requested == 0 || (int32_t)(nowMs - scheduler->nextWindowMs) < 0){
+      return NET_RADIO_NONE;
+    }
+    scheduler->active = scheduler->requested;
+    scheduler->requested = 0;
+    scheduler->windowStartMs = nowMs;
+    scheduler->windows++;
+    // stay on the grid, a window that opened late does not shift the next ones
+    do{
+      scheduler->nextWindowMs += config->windowPeriodMs;
+    }while((int32_t)(nowMs - scheduler->nextWindowMs) >= 0);
+    scheduler->state = NET_SCHED_WINDOW;
+    return NET_RADIO_WAKE;
+
+  case NET_SCHED_WINDOW:{
+    uint32_t elapsed = nowMs - scheduler->windowStartMs;
+    if(scheduler->active != 0 && elapsed < config->windowBudgetMs){
+      return NET_RADIO_NONE;
+    }
+    if(scheduler->active != 0){
+      // unfinished work gets the next window
+      scheduler->overruns++;
+      scheduler->requested |= scheduler->active;
+      scheduler->active = 0;
+    }
+    scheduler->lastWindowMs = elapsed;
+    scheduler->radioOnMs += elapsed;
+    scheduler->state = NET_SCHED_IDLE;
+    return NET_RADIO_SLEEP;
+  }
+
+  default:
+    return NET_RADIO_NONE;
+  }
+}
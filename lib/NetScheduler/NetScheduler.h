@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef NET_SCHEDULER_H
+#define NET_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum : uint8_t{
+  NET_SCHED_IDLE,       // radio asleep, requests pile up for the next window
+  NET_SCHED_WINDOW      // radio awake until every client of the window is done or the budget ran out
+}NetSchedulerState;
+
+typedef enum : uint8_t{
+  NET_RADIO_NONE,
+  NET_RADIO_WAKE,       // a window opened
+  NET_RADIO_SLEEP       // the window closed
+}NetRadioAction;
+
+typedef struct{
+  uint32_t windowPeriodMs;  // windows only open on this grid, so work requested in between is coalesced
+  uint32_t windowBudgetMs;  // longest a window may keep the radio awake, connecting included
+}NetSchedulerConfig;
+
+typedef struct{
+  const NetSchedulerConfig *config;
+  NetSchedulerState state;
+  uint32_t requested;       // client bits waiting for the next window
+  uint32_t active;          // client bits of the open window that are not done yet
+  uint32_t nextWindowMs;
+  uint32_t windowStartMs;
+  uint32_t windows;
+  uint32_t overruns;        // windows closed by the budget with clients still working
+  uint32_t lastWindowMs;
+  uint64_t radioOnMs;       // summed length of all closed windows
+}NetScheduler;
+
+/*  The first window may open right away  */
+void netSchedulerInit(NetScheduler *scheduler, const NetSchedulerConfig *config, uint32_t nowMs);
+
+/*  Clients want the radio, they join an open window or wait for the next one  */
+void netSchedulerRequest(NetScheduler *scheduler, uint32_t clients);
+
+void netSchedulerDone(NetScheduler *scheduler, uint32_t clients);
+
+/*  Call periodically, returns what the caller should do with the radio  */
+NetRadioAction netSchedulerUpdate(NetScheduler *scheduler, uint32_t nowMs);
+
+#endif
@@ -0,0 +1,118 @@
+#include "Screens.h"
+
+#include <stdio.h>
+
+void screenDrawNoDataYet(U8g2Display &display, const char *title, const char *reason){
+  display.clear();
+  display.setFont(HAL_FONT_HELV_B10);
+  display.drawText(20, 25, title);
+  display.setFont(HAL_FONT_HELV_R08);
+  display.drawText(20, 50, reason);
+}
+
+void screenRenderTime(U8g2Display &display, const TimeText *time, uint8_t blinkingField, bool blinkOn){
+  char frames[TIME_FRAME_COUNT][TIME_FRAME_LENGTH];
+  timeFormatFrames(frames, time->time, time->date, true);
+
+  uint8_t timeFrame = TIME_FRAME_TIME;
+  uint8_t dateFrame = TIME_FRAME_DATE;
+  if((blinkingField == 1 || blinkingField == 2) && blinkOn){
+    timeFrame = blinkingField;
+  }else if(blinkingField >= 3 && blinkOn){
+    dateFrame = blinkingField + 1;
+  }
+
+  display.clear();
+  display.setFont(HAL_FONT_HELV_B12);
+  display.drawText(40, 25, frames[timeFrame]);
+  display.setFont(HAL_FONT_HELV_R08);
+  display.drawText(20, 50, frames[dateFrame]);
+}
+
+void screenRenderEnv(U8g2Display &display, float temperature, float humidity){
+  display.clear();
+  display.setFont(HAL_FONT_HELV_B10);
+  display.drawTextf(20, 25, "Temp = %.2f ", temperature);
+  display.drawTextf(30, 50, "RH = %.2f", humidity);
+}
+
+void screenRenderPulse(U8g2Display &display, uint16_t bpm){
+  display.clear();
+  display.setFont(HAL_FONT_HELV_B12);
+  display.drawText(40, 25, "BPM");
+  display.drawTextf(50, 50, "%u", bpm);
+}
+
+void screenRenderWeather(U8g2Display &display, const WeatherReport *weather){
+  display.clear();
+  display.setFont(HAL_FONT_HELV_B08);
+  display.drawText(24, 17, weather->description);
+  display.drawTextf(14, 34, "Temp: %.2f", weather->tempFeelLike - 273.25);
+  display.drawTextf(14, 64, "RH(%%): %.2f", weather->humidity);
+  display.drawTextf(14, 47, "wind speed: %.2f", weather->windSpeed);
+}
+
+void screenRenderSteps(U8g2Display &display, int stepCount, const char *ip){
+  display.clear();
+  display.drawFrame(0, 0, 128, 64);
+
+  display.setFont(HAL_FONT_NCEN_B08);
+  display.drawText(25, 12, "Step Counter");
+
+  display.drawLine(5, 15, 123, 15);
+
+  // centered on the 12 px digits of the numbers font
+  char steps[12];
+  int digits = snprintf(steps, sizeof(steps), "%d", stepCount);
+  display.setFont(HAL_FONT_NUMBERS_20);
+  display.drawText((128 - digits * 12) / 2, 40, steps);
+
+  display.setFont(HAL_FONT_6X10);
+  display.drawText(45, 52, "Steps");
+
+  display.setFont(HAL_FONT_5X7);
+  display.drawTextf(2, 62, "IP: %s", ip);
+}
+
+void screenRenderHistory(U8g2Display &display, StepHistory *history){
+  const uint8_t *columns = stepHistoryColumns(history);
+  const uint8_t baseline = 60;
+
+  display.clear();
+  display.setFont(HAL_FONT_5X7);
+  display.drawText(2, 7, "Steps / hour, 24h");
+  display.drawTextf(90, 7, "max %u", (unsigned)history->columnMax);
+
+  display.drawHLine(0, baseline + 1, 128);
+  for(uint8_t column = 0; column < STEP_HISTORY_HOURS; column++){
+    if(columns[column] > 0){
+      display.drawBox(4 + column * 5, baseline + 1 - columns[column], 4, columns[column]);
+    }
+  }
+}
+
+void screenRenderHealth(U8g2Display &display, const HealthSnapshot *health){
+  display.clear();
+  display.setFont(HAL_FONT_5X7);
+  display.drawText(2, 7, "System health");
+  display.drawTextf(80, 7, "up %u min", (unsigned)(health->uptimeS / 60));
+  display.drawHLine(0, 10, 128);
+
+  display.drawTextf(2, 20, "Heap %u KB, min %u KB", (unsigned)(health->heapFree / 1024), (unsigned)(health->heapMinFree / 1024));
+  display.drawTextf(2, 30, "Largest block %u KB", (unsigned)(health->heapLargestBlock / 1024));
+
+  if(health->cpuLoad[0] == HEALTH_CPU_UNKNOWN){
+    display.drawText(2, 40, "CPU n/a");
+  }else{
+    display.drawTextf(2, 40, "CPU %u%% / %u%%", health->cpuLoad[0], health->cpuLoad[1]);
+  }
+
+  // tasks are sorted tightest stack first
+  if(health->taskCount > 0){
+    display.drawTextf(2, 50, "Stack %s %u B", health->tasks[0].name, (unsigned)health->tasks[0].stackFree);
+  }
+  const HealthQueue *queue = healthFullestQueue(health);
+  if(queue != NULL){
+    display.drawTextf(2, 60, "Queue %s %u/%u", queue->name, queue->waiting, queue->length);
+  }
+}
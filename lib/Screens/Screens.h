@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef SCREENS_H
+#define SCREENS_H
+
+#include <stdint.h>
+#include <HalU8g2.h>
+#include <TimeFormat.h>
+#include <WeatherParse.h>
+#include <StepHistory.h>
+#include <HealthSnapshot.h>
+
+/*  Every screen's drawing, from plain values into the U8g2 buffer. Deciding when to draw, and whether
+ *  there is data yet, stays with the display task  */
+
+/*  Placeholder for screens whose producer hasn't delivered anything yet  */
+void screenDrawNoDataYet(U8g2Display &display, const char *title, const char *reason);
+
+/*  blinkingField is the time field being edited (0: none, 1 minutes ... 5 year), blanked while blinkOn  */
+void screenRenderTime(U8g2Display &display, const TimeText *time, uint8_t blinkingField, bool blinkOn);
+void screenRenderEnv(U8g2Display &display, float temperature, float humidity);
+void screenRenderPulse(U8g2Display &display, uint16_t bpm);
+void screenRenderWeather(U8g2Display &display, const WeatherReport *weather);
+void screenRenderSteps(U8g2Display &display, int stepCount, const char *ip);
+void screenRenderHistory(U8g2Display &display, StepHistory *history);
+void screenRenderHealth(U8g2Display &display, const HealthSnapshot *health);
+
+#endif
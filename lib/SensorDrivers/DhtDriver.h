@@ -0,0 +1,26 @@
+#pragma once
+
+#ifndef DHT_DRIVER_H
+#define DHT_DRIVER_H
+
+#include <Arduino.h>
+#include <DHT_U.h>
+
+/*  Environment driver over the Adafruit unified DHT sensor, see SensorDrivers.h  */
+class DhtDriver{
+public:
+  explicit DhtDriver(DHT_Unified &dht) : dht(dht){}
+
+  void read(float *temperature, float *humidity){
+    sensors_event_t event;
+    dht.temperature().getEvent(&event);
+    *temperature = event.temperature;
+    dht.humidity().getEvent(&event);
+    *humidity = event.relative_humidity;
+  }
+
+private:
+  DHT_Unified &dht;
+};
+
+#endif
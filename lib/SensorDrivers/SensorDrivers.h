@@ -0,0 +1,139 @@
+#pragma once
+
+#ifndef SENSOR_DRIVERS_H
+#define SENSOR_DRIVERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <AccelSensor.h>
+
+/*  Sensors as compile-time policies. The pipelines in SensorPipelines.h are templates on the driver
+ *  type, so a read is a direct call the compiler can inline, where going through Hal.h is a virtual one.
+ *  A driver only needs the methods its kind lists, there is no common base to derive from:
+ *
+ *    accelerometer   bool readRaw(int16_t raw[3]), static constexpr float lsbPerG()
+ *                    deriving from AccelDriver<Self> adds readG()
+ *    pulse           uint16_t read()
+ *    environment     void read(float *temperature, float *humidity), NAN for what didn't come back
+ *
+ *  The bus or ADC below a driver is a template parameter too. Instantiated on the final Esp32* and
+ *  Fake* classes of lib/Hal, those calls are direct as well  */
+
+/*  Conversion to g, shared by every accelerometer (CRTP, no virtual calls)  */
+template<class Driver>
+class AccelDriver{
+public:
+  bool readG(float acceleration[3]){
+    int16_t raw[3];
+    return readG(acceleration, raw);
+  }
+
+  /*  Same, and the counts it was converted from  */
+  bool readG(float acceleration[3], int16_t raw[3]){
+    if(!static_cast<Driver *>(this)->readRaw(raw)){
+      return false;
+    }
+    for(uint8_t axis = 0; axis < 3; axis++){
+      acceleration[axis] = raw[axis] / Driver::lsbPerG();
+    }
+    return true;
+  }
+};
+
+/*  Same burst read as accelSensorRead(), on whatever I2c type it is given  */
+template<class I2c>
+class Mpu6050Driver : public AccelDriver<Mpu6050Driver<I2c>>{
+public:
+  explicit Mpu6050Driver(I2c &i2c) : i2c(i2c){}
+
+  bool readRaw(int16_t raw[3]){
+    uint8_t data[6];
+    if(!i2c.readRegisters(MPU6050_ADDRESS, MPU6050_ACCEL_XOUT_H, data, sizeof(data))){
+      return false;
+    }
+    for(uint8_t axis = 0; axis < 3; axis++){
+      raw[axis] = (int16_t)((data[axis * 2] << 8) | data[axis * 2 + 1]);
+    }
+    return true;
+  }
+
+  static constexpr float lsbPerG(){ return MPU6050_ACCEL_LSB_PER_G; }
+
+private:
+  I2c &i2c;
+};
+
+/*  Pulse sensor on an ADC pin  */
+template<class Adc>
+class AnalogPulseDriver{
+public:
+  AnalogPulseDriver(Adc &adc, uint8_t pin) : adc(adc), pin(pin){}
+
+  uint16_t read(){ return adc.read(pin); }
+
+private:
+  Adc &adc;
+  uint8_t pin;
+};
+
+/*  Replay drivers play a recorded or generated buffer back in a loop, for the native build.
+ *  The pulse and environment buffers must not be empty, an empty accelerometer one reads as a dead sensor  */
+
+class ReplayAccelDriver : public AccelDriver<ReplayAccelDriver>{
+public:
+  ReplayAccelDriver(const int16_t (*samples)[3], size_t count) : samples(samples), count(count){}
+
+  bool readRaw(int16_t raw[3]){
+    if(count == 0){
+      return false;
+    }
+    raw[0] = samples[next][0];
+    raw[1] = samples[next][1];
+    raw[2] = samples[next][2];
+    next = next + 1 < count ? next + 1 : 0;
+    return true;
+  }
+
+  static constexpr float lsbPerG(){ return MPU6050_ACCEL_LSB_PER_G; }
+
+private:
+  const int16_t (*samples)[3];
+  size_t count;
+  size_t next = 0;
+};
+
+class ReplayPulseDriver{
+public:
+  ReplayPulseDriver(const uint16_t *samples, size_t count) : samples(samples), count(count){}
+
+  uint16_t read(){
+    uint16_t signal = samples[next];
+    next = next + 1 < count ? next + 1 : 0;
+    return signal;
+  }
+
+private:
+  const uint16_t *samples;
+  size_t count;
+  size_t next = 0;
+};
+
+/*  samples[i] is {temperature, humidity}  */
+class ReplayEnvDriver{
+public:
+  ReplayEnvDriver(const float (*samples)[2], size_t count) : samples(samples), count(count){}
+
+  void read(float *temperature, float *humidity){
+    *temperature = samples[next][0];
+    *humidity = samples[next][1];
+    next = next + 1 < count ? next + 1 : 0;
+  }
+
+private:
+  const float (*samples)[2];
+  size_t count;
+  size_t next = 0;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#ifndef SENSOR_PIPELINES_H
+#define SENSOR_PIPELINES_H
+
+#include <stdint.h>
+#include <math.h>
+#include <StepDetector.h>
+#include <BeatDetector.h>
+#include "SensorDrivers.h"
+
+/*  Sensor read plus detector, templated on the driver (see SensorDrivers.h) so the whole sample is
+ *  one inlinable call chain. The detectors stay plain C in their own libs  */
+
+typedef enum : uint8_t{
+  STEP_SAMPLE_NONE,
+  STEP_SAMPLE_STEP,
+  STEP_SAMPLE_READ_FAILED     // the detector didn't see this sample
+}StepSample;
+
+template<class Accel>
+class StepPipeline{
+public:
+  StepPipeline(Accel &accel, const StepDetectorConfig *config) : accel(accel){
+    stepDetectorInit(&detector, config);
+  }
+
+  StepSample sample(uint32_t nowMs){
+    if(!read()){
+      return STEP_SAMPLE_READ_FAILED;
+    }
+    return detect(nowMs);
+  }
+
+  /*  sample() in two halves, for when the read has to run somewhere else, e.g. as a transaction of a
+   *  shared bus. detect() works on what the last read() got  */
+  bool read(){
+    return accel.readG(acceleration, raw);
+  }
+
+  StepSample detect(uint32_t nowMs){
+    return stepDetectorUpdate(&detector, acceleration, nowMs) ? STEP_SAMPLE_STEP : STEP_SAMPLE_NONE;
+  }
+
+  StepDetector detector;
+  float acceleration[3] = {0, 0, 0};   // g, last sample read
+  int16_t raw[3] = {0, 0, 0};          // sensor counts of the same sample
+
+private:
+  Accel &accel;
+};
+
+template<class Pulse>
+class BeatPipeline{
+public:
+  BeatPipeline(Pulse &pulse, const BeatDetectorConfig *config) : pulse(pulse){
+    beatDetectorInit(&detector, config);
+  }
+
+  /*  True when the sample started a pulse, detector.bpm was refreshed then  */
+  bool sample(uint32_t nowMs){
+    signal = pulse.read();
+    return beatDetectorUpdate(&detector, signal, nowMs);
+  }
+
+  BeatDetector detector;
+  uint16_t signal = 0;                 // ADC counts, last sample read
+
+private:
+  Pulse &pulse;
+};
+
+#define ENV_FRESH_TEMPERATURE (1 << 0)
+#define ENV_FRESH_HUMIDITY (1 << 1)
+
+/*  Last good temperature and humidity. A failed value keeps the previous one, like readDHT always did  */
+template<class Env>
+class EnvCache{
+public:
+  explicit EnvCache(Env &env) : env(env){}
+
+  /*  ENV_FRESH_* bits of the values this read delivered  */
+  uint8_t update(){
+    float newTemperature;
+    float newHumidity;
+    env.read(&newTemperature, &newHumidity);
+
+    uint8_t fresh = 0;
+    if(!isnan(newTemperature)){
+      temperature = newTemperature;
+      fresh |= ENV_FRESH_TEMPERATURE;
+    }
+    if(!isnan(newHumidity)){
+      humidity = newHumidity;
+      fresh |= ENV_FRESH_HUMIDITY;
+    }
+    return fresh;
+  }
+
+  float temperature = 0;
+  float humidity = 0;
+
+private:
+  Env &env;
+};
+
+#endif
@@ -0,0 +1,322 @@
+#include "SeriesCodec.h"
+
+#include <string.h>
+
+#define SERIES_BODY_BITS (SERIES_BLOCK_BODY * 8)
+
+static_assert(SERIES_BLOCK_BODY <= 255, "bodyBytes is a uint8_t");
+
+/*  CRC-16/CCITT-FALSE, catches blocks torn by a reset in the middle of a write  */
+static uint16_t blockCrc(const uint8_t *data, size_t length, uint16_t crc){
+  for(size_t i = 0; i < length; i++){
+    crc ^= (uint16_t)data[i] << 8;
+    for(uint8_t bit = 0; bit < 8; bit++){
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static void put16(uint8_t *out, uint16_t value){
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+}
+
+static void put32(uint8_t *out, uint32_t value){
+  put16(out, (uint16_t)value);
+  put16(out + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t get16(const uint8_t *in){
+  return (uint16_t)(in[0] | in[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *in){
+  return get16(in) | (uint32_t)get16(in + 2) << 16;
+}
+
+static uint8_t leadingZeros(uint32_t value){
+  return value ? __builtin_clz(value) : 32;
+}
+
+static uint8_t trailingZeros(uint32_t value){
+  return value ? __builtin_ctz(value) : 32;
+}
+
+/*  MSB first  */
+static bool writeBits(SeriesBlockEncoder *encoder, uint32_t value, uint8_t count){
+  if(encoder->bitPosition + count > SERIES_BODY_BITS){
+    return false;
+  }
+  for(int8_t bit = count - 1; bit >= 0; bit--){
+    uint16_t position = encoder->bitPosition++;
+    uint8_t mask = 0x80 >> (position & 7);
+    if((value >> bit) & 1){
+      encoder->body[position >> 3] |= mask;
+    }else{
+      encoder->body[position >> 3] &= ~mask;
+    }
+  }
+  return true;
+}
+
+static bool readBits(SeriesBlockDecoder *decoder, uint8_t count, uint32_t *value){
+  if(decoder->bitPosition + count > decoder->bodyBits){
+    return false;
+  }
+  uint32_t result = 0;
+  for(uint8_t bit = 0; bit < count; bit++){
+    uint16_t position = decoder->bitPosition++;
+    result = (result << 1) | ((decoder->body[position >> 3] >> (7 - (position & 7))) & 1);
+  }
+  *value = result;
+  return true;
+}
+
+/*  Counts the leading 1 bits of a size prefix, up to `max`  */
+static bool readPrefix(SeriesBlockDecoder *decoder, uint8_t max, uint8_t *prefix){
+  uint8_t ones = 0;
+  while(ones < max){
+    uint32_t bit;
+    if(!readBits(decoder, 1, &bit)){
+      return false;
+    }
+    if(!bit){
+      break;
+    }
+    ones++;
+  }
+  *prefix = ones;
+  return true;
+}
+
+/*  Timestamp delta-of-delta: regular sampling costs one bit per sample  */
+static const uint8_t timestampBucketBits[] = {0, 7, 9, 12, 32};
+static const int32_t timestampBucketLow[] = {0, -63, -255, -2047, 0};
+
+static bool writeTimestamp(SeriesBlockEncoder *encoder, int32_t deltaOfDelta){
+  for(uint8_t bucket = 0; bucket < 4; bucket++){
+    uint8_t bits = timestampBucketBits[bucket];
+    int32_t low = timestampBucketLow[bucket];
+    if(deltaOfDelta >= low && deltaOfDelta < low + (1 << bits)){
+      // prefix: `bucket` ones and a zero
+      return writeBits(encoder, ((1u << bucket) - 1) << 1, bucket + 1) &&
+             (bits == 0 || writeBits(encoder, (uint32_t)(deltaOfDelta - low), bits));
+    }
+  }
+  return writeBits(encoder, 0xF, 4) && writeBits(encoder, (uint32_t)deltaOfDelta, 32);
+}
+
+static bool readTimestamp(SeriesBlockDecoder *decoder, int32_t *deltaOfDelta){
+  uint8_t bucket;
+  uint32_t raw = 0;
+  if(!readPrefix(decoder, 4, &bucket)){
+    return false;
+  }
+  uint8_t bits = timestampBucketBits[bucket];
+  if(bits > 0 && !readBits(decoder, bits, &raw)){
+    return false;
+  }
+  *deltaOfDelta = (int32_t)raw + timestampBucketLow[bucket];
+  return true;
+}
+
+/*  Integer values: zigzag delta, an unchanged value costs one bit  */
+static const uint8_t integerBucketBits[] = {0, 4, 8, 16, 32};
+
+static bool writeInteger(SeriesBlockEncoder *encoder, uint32_t value){
+  int32_t delta = (int32_t)(value - encoder->previousValue);
+  uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+  for(uint8_t bucket = 0; bucket < 4; bucket++){
+    uint8_t bits = integerBucketBits[bucket];
+    if(bits == 0 ? zigzag == 0 : zigzag < (1u << bits)){
+      return writeBits(encoder, ((1u << bucket) - 1) << 1, bucket + 1) &&
+             (bits == 0 || writeBits(encoder, zigzag, bits));
+    }
+  }
+  return writeBits(encoder, 0xF, 4) && writeBits(encoder, zigzag, 32);
+}
+
+static bool readInteger(SeriesBlockDecoder *decoder){
+  uint8_t bucket;
+  uint32_t zigzag = 0;
+  if(!readPrefix(decoder, 4, &bucket)){
+    return false;
+  }
+  uint8_t bits = integerBucketBits[bucket];
+  if(bits > 0 && !readBits(decoder, bits, &zigzag)){
+    return false;
+  }
+  int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+  decoder->value += (uint32_t)delta;
+  return true;
+}
+
+/*  Floats: XOR with the previous bits, only the meaningful window is stored, and the window
+ *  of the previous sample is reused when it still covers the change  */
+static bool writeFloat(SeriesBlockEncoder *encoder, uint32_t value){
+  uint32_t xored = value ^ encoder->previousValue;
+  if(xored == 0){
+    return writeBits(encoder, 0, 1);
+  }
+
+  uint8_t leading = leadingZeros(xored);
+  uint8_t trailing = trailingZeros(xored);
+
+  uint8_t previousTrailing = 32 - encoder->previousLeading - encoder->previousMeaningful;
+  if(encoder->previousMeaningful != 0 && leading >= encoder->previousLeading && trailing >= previousTrailing){
+    return writeBits(encoder, 0x2, 2) && writeBits(encoder, xored >> previousTrailing, encoder->previousMeaningful);
+  }
+
+  uint8_t meaningful = 32 - leading - trailing;
+  if(!(writeBits(encoder, 0x3, 2) && writeBits(encoder, leading, 5) && writeBits(encoder, meaningful - 1, 5) &&
+       writeBits(encoder, xored >> trailing, meaningful))){
+    return false;
+  }
+  encoder->previousLeading = leading;
+  encoder->previousMeaningful = meaningful;
+  return true;
+}
+
+static bool readFloat(SeriesBlockDecoder *decoder){
+  uint32_t control;
+  if(!readBits(decoder, 1, &control)){
+    return false;
+  }
+  if(!control){
+    return true;
+  }
+
+  if(!readBits(decoder, 1, &control)){
+    return false;
+  }
+  if(control){
+    uint32_t leading, meaningful;
+    if(!readBits(decoder, 5, &leading) || !readBits(decoder, 5, &meaningful)){
+      return false;
+    }
+    decoder->leading = leading;
+    decoder->meaningful = meaningful + 1;
+    if(decoder->leading + decoder->meaningful > 32){
+      return false;
+    }
+  }else if(decoder->meaningful == 0){
+    return false;
+  }
+
+  uint32_t bits;
+  if(!readBits(decoder, decoder->meaningful, &bits)){
+    return false;
+  }
+  decoder->value ^= bits << (32 - decoder->leading - decoder->meaningful);
+  return true;
+}
+
+void seriesBlockEncoderInit(SeriesBlockEncoder *encoder, SeriesKind kind, uint8_t series, uint32_t sequence){
+  memset(encoder, 0, sizeof(*encoder));
+  encoder->kind = kind;
+  encoder->header.series = series;
+  encoder->header.sequence = sequence;
+}
+
+bool seriesBlockAppend(SeriesBlockEncoder *encoder, uint32_t timestamp, SeriesValue value){
+  if(encoder->header.count == UINT16_MAX){
+    return false;
+  }
+
+  if(encoder->header.count == 0){
+    if(!writeBits(encoder, value.bits, 32)){
+      return false;
+    }
+    encoder->header.firstTimestamp = timestamp;
+  }else{
+    SeriesBlockEncoder saved = *encoder;    // a sample that does not fit is rolled back as a whole
+    int32_t delta = (int32_t)(timestamp - encoder->previousTimestamp);
+    bool written = writeTimestamp(encoder, delta - encoder->previousDelta) &&
+                   (encoder->kind == SERIES_FLOAT ? writeFloat(encoder, value.bits) : writeInteger(encoder, value.bits));
+    if(!written){
+      memcpy(encoder, &saved, sizeof(saved));
+      return false;
+    }
+    encoder->previousDelta = delta;
+  }
+
+  encoder->previousTimestamp = timestamp;
+  encoder->previousValue = value.bits;
+  encoder->header.lastTimestamp = timestamp;
+  encoder->header.count++;
+  encoder->header.bodyBytes = (encoder->bitPosition + 7) / 8;
+  return true;
+}
+
+void seriesBlockSerialize(const SeriesBlockEncoder *encoder, uint8_t *out){
+  const SeriesBlockHeader *header = &encoder->header;
+  memset(out, 0, SERIES_BLOCK_SIZE);
+  put32(out, header->sequence);
+  put32(out + 4, header->firstTimestamp);
+  put32(out + 8, header->lastTimestamp);
+  put16(out + 12, header->count);
+  out[14] = header->bodyBytes;
+  out[15] = header->series;
+
+  uint8_t *body = out + SERIES_BLOCK_HEADER;
+  memcpy(body, encoder->body, header->bodyBytes);
+  if(encoder->bitPosition & 7){
+    body[header->bodyBytes - 1] &= 0xFF << (8 - (encoder->bitPosition & 7));
+  }
+
+  uint16_t crc = blockCrc(out, 16, 0xFFFF);
+  put16(out + 16, blockCrc(body, header->bodyBytes, crc));
+}
+
+bool seriesBlockParseHeader(const uint8_t *block, SeriesBlockHeader *header){
+  header->sequence = get32(block);
+  header->firstTimestamp = get32(block + 4);
+  header->lastTimestamp = get32(block + 8);
+  header->count = get16(block + 12);
+  header->bodyBytes = block[14];
+  header->series = block[15];
+
+  if(header->sequence == SERIES_BLOCK_EMPTY || header->count == 0 || header->bodyBytes > SERIES_BLOCK_BODY){
+    return false;
+  }
+  uint16_t crc = blockCrc(block, 16, 0xFFFF);
+  return blockCrc(block + SERIES_BLOCK_HEADER, header->bodyBytes, crc) == get16(block + 16);
+}
+
+void seriesBlockDecoderInit(SeriesBlockDecoder *decoder, const uint8_t *block, SeriesKind kind){
+  memset(decoder, 0, sizeof(*decoder));
+  decoder->body = block + SERIES_BLOCK_HEADER;
+  decoder->bodyBits = block[14] * 8;
+  decoder->remaining = get16(block + 12);
+  decoder->kind = kind;
+  decoder->timestamp = get32(block + 4);
+}
+
+bool seriesBlockNext(SeriesBlockDecoder *decoder, SeriesSample *sample){
+  if(decoder->remaining == 0){
+    return false;
+  }
+
+  if(!decoder->started){
+    if(!readBits(decoder, 32, &decoder->value)){
+      return false;
+    }
+    decoder->started = true;
+  }else{
+    int32_t deltaOfDelta;
+    if(!readTimestamp(decoder, &deltaOfDelta)){
+      return false;
+    }
+    decoder->delta += deltaOfDelta;
+    decoder->timestamp += (uint32_t)decoder->delta;
+    if(!(decoder->kind == SERIES_FLOAT ? readFloat(decoder) : readInteger(decoder))){
+      return false;
+    }
+  }
+
+  decoder->remaining--;
+  sample->timestamp = decoder->timestamp;
+  sample->value.bits = decoder->value;
+  return true;
+}
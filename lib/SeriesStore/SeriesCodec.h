@@ -0,0 +1,87 @@
+#pragma once
+
+#ifndef SERIES_CODEC_H
+#define SERIES_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SERIES_BLOCK_SIZE 256     // bytes on flash per block, header included
+#define SERIES_BLOCK_HEADER 18
+#define SERIES_BLOCK_BODY (SERIES_BLOCK_SIZE - SERIES_BLOCK_HEADER)
+#define SERIES_BLOCK_EMPTY 0xFFFFFFFF   // sequence of a slot never written
+
+typedef enum : uint8_t{
+  SERIES_INT,     // delta of the previous value, zigzag, in size buckets: counters and rates
+  SERIES_FLOAT    // XOR with the previous value's bits: slow moving readings
+}SeriesKind;
+
+typedef union{
+  int32_t i;
+  float f;
+  uint32_t bits;
+}SeriesValue;
+
+typedef struct{
+  uint32_t timestamp;   // seconds, never decreasing within a series
+  SeriesValue value;
+}SeriesSample;
+
+/*  Little endian on flash:
+ *  sequence u32 | firstTs u32 | lastTs u32 | count u16 | bodyBytes u8 | series u8 | crc16 u16 | body
+ *  Body: first value raw, then per sample the timestamp delta-of-delta and the value, both bit packed  */
+typedef struct{
+  uint32_t sequence;
+  uint32_t firstTimestamp;
+  uint32_t lastTimestamp;
+  uint16_t count;
+  uint8_t bodyBytes;
+  uint8_t series;
+}SeriesBlockHeader;
+
+/*  Appends into one block in RAM, the block is full once the next sample would not fit  */
+typedef struct{
+  SeriesBlockHeader header;
+  SeriesKind kind;
+  uint8_t body[SERIES_BLOCK_BODY];
+  uint16_t bitPosition;
+  uint32_t previousTimestamp;
+  int32_t previousDelta;
+  uint32_t previousValue;
+  uint8_t previousLeading;    // XOR window of the last float that was not equal to its predecessor
+  uint8_t previousMeaningful;
+}SeriesBlockEncoder;
+
+void seriesBlockEncoderInit(SeriesBlockEncoder *encoder, SeriesKind kind, uint8_t series, uint32_t sequence);
+
+/*  false when the block is full, the encoder is left as it was  */
+bool seriesBlockAppend(SeriesBlockEncoder *encoder, uint32_t timestamp, SeriesValue value);
+
+/*  Serializes header and body into SERIES_BLOCK_SIZE bytes, the unused tail is zero  */
+void seriesBlockSerialize(const SeriesBlockEncoder *encoder, uint8_t *out);
+
+/*  Reads the header of a serialized block, false for blank slots and torn or corrupt blocks  */
+bool seriesBlockParseHeader(const uint8_t *block, SeriesBlockHeader *header);
+
+/*  Walks the samples of a serialized block that passed seriesBlockParseHeader(), oldest first  */
+typedef struct{
+  const uint8_t *body;
+  uint16_t bodyBits;
+  uint16_t bitPosition;
+  uint16_t remaining;
+  SeriesKind kind;
+  uint32_t timestamp;
+  int32_t delta;
+  uint32_t value;
+  uint8_t leading;
+  uint8_t meaningful;
+  bool started;
+}SeriesBlockDecoder;
+
+void seriesBlockDecoderInit(SeriesBlockDecoder *decoder, const uint8_t *block, SeriesKind kind);
+
+/*  false once every sample was returned, or if the body turns out to be truncated  */
+bool seriesBlockNext(SeriesBlockDecoder *decoder, SeriesSample *sample);
+
+#endif
@@ -0,0 +1,96 @@
+// the task, queue and LittleFS mount need the Arduino core, the native build only uses the store and codec
+#ifdef ARDUINO
+
+#include "SeriesRecorder.h"
+
+#include <LittleFS.h>
+
+#define SERIES_RECORDER_DIRECTORY "/littlefs"   // LittleFS's VFS mount point, the store uses plain stdio
+
+static SeriesStore store;
+static QueueHandle_t records_handle = NULL;
+static SemaphoreHandle_t storeMutex_handle = NULL;
+static volatile uint32_t dropped = 0;
+static bool mounted = false;
+
+static void seriesRecorderTask(void *parameters){
+  SeriesRecord record;
+
+  for(;;){
+    bool received = xQueueReceive(records_handle, &record, pdMS_TO_TICKS(SERIES_RECORDER_TICK)) == pdTRUE;
+
+    xSemaphoreTake(storeMutex_handle, portMAX_DELAY);
+    if(received){
+      seriesStoreAppend(&store, record.series, record.timestamp, record.value, millis());
+    }
+    seriesStoreTick(&store, millis());
+    xSemaphoreGive(storeMutex_handle);
+  }
+}
+
+bool seriesRecorderBegin(const SeriesConfig *configs, uint8_t count, SeriesRecorderStorage *storage,
+                         UBaseType_t taskPriority, BaseType_t core){
+  if(!LittleFS.begin(true) || !seriesStoreOpen(&store, SERIES_RECORDER_DIRECTORY, configs, count)){
+    return false;
+  }
+  mounted = true;
+
+  records_handle = xQueueCreateStatic(SERIES_RECORDER_QUEUE_SIZE, sizeof(SeriesRecord), storage->recordStorage,
+                                      &storage->records);
+  storeMutex_handle = xSemaphoreCreateMutexStatic(&storage->storeMutex);
+
+  xTaskCreateStaticPinnedToCore(
+    seriesRecorderTask,
+    "SERIES RECORDER",
+    SERIES_RECORDER_TASK_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+  return true;
+}
+
+void seriesRecorderAppend(uint8_t series, uint32_t timestamp, SeriesValue value){
+  SeriesRecord record = {series, timestamp, value};
+  if(records_handle == NULL || xQueueSend(records_handle, &record, 0) != pdTRUE){
+    dropped++;
+  }
+}
+
+uint32_t seriesRecorderQuery(uint8_t series, uint32_t from, uint32_t to, SeriesVisitor visitor, void *context){
+  if(!mounted){
+    return 0;
+  }
+  xSemaphoreTake(storeMutex_handle, portMAX_DELAY);
+  uint32_t visited = seriesStoreQuery(&store, series, from, to, visitor, context);
+  xSemaphoreGive(storeMutex_handle);
+  return visited;
+}
+
+void seriesRecorderFlush(){
+  if(!mounted){
+    return;
+  }
+  xSemaphoreTake(storeMutex_handle, portMAX_DELAY);
+  seriesStoreFlush(&store);
+  xSemaphoreGive(storeMutex_handle);
+}
+
+void seriesRecorderGetStats(SeriesRecorderStats *stats){
+  memset(stats, 0, sizeof(*stats));
+  stats->dropped = dropped;
+  stats->mounted = mounted;
+  if(!mounted){
+    return;
+  }
+  xSemaphoreTake(storeMutex_handle, portMAX_DELAY);
+  stats->store = store.stats;
+  for(uint8_t series = 0; series < store.count; series++){
+    stats->blocks[series] = seriesStoreBlocks(&store, series);
+  }
+  xSemaphoreGive(storeMutex_handle);
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef SERIES_RECORDER_H
+#define SERIES_RECORDER_H
+
+#include <Arduino.h>
+#include "SeriesStore.h"
+
+#define SERIES_RECORDER_QUEUE_SIZE 32
+#define SERIES_RECORDER_TASK_STACK 4096
+#define SERIES_RECORDER_TICK 1000         // ms between flush checks when nothing is appended
+
+typedef struct{
+  SeriesStoreStats store;
+  uint32_t dropped;       // samples that found the queue full, or came before the file system was up
+  uint32_t blocks[SERIES_STORE_MAX_SERIES];
+  bool mounted;
+}SeriesRecorderStats;
+
+typedef struct{
+  uint8_t series;
+  uint32_t timestamp;
+  SeriesValue value;
+}SeriesRecord;
+
+/*  The recorder task's, queue's and store mutex's memory, reserved by the caller (see lib/StaticRtos)  */
+typedef struct{
+  StackType_t stack[SERIES_RECORDER_TASK_STACK];
+  StaticTask_t tcb;
+  uint8_t recordStorage[SERIES_RECORDER_QUEUE_SIZE * sizeof(SeriesRecord)];
+  StaticQueue_t records;
+  StaticSemaphore_t storeMutex;
+}SeriesRecorderStorage;
+
+/*  Mounts LittleFS (formatting it if it does not mount) and starts the task that owns the store.
+ *  Sensor tasks never touch the flash themselves  */
+bool seriesRecorderBegin(const SeriesConfig *configs, uint8_t count, SeriesRecorderStorage *storage,
+                         UBaseType_t taskPriority, BaseType_t core);
+
+/*  Never blocks, a full queue counts a drop  */
+void seriesRecorderAppend(uint8_t series, uint32_t timestamp, SeriesValue value);
+
+/*  Runs in the caller, the recorder waits meanwhile  */
+uint32_t seriesRecorderQuery(uint8_t series, uint32_t from, uint32_t to, SeriesVisitor visitor, void *context);
+
+void seriesRecorderFlush();
+
+void seriesRecorderGetStats(SeriesRecorderStats *stats);
+
+#endif
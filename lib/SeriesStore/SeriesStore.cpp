@@ -0,0 +1,222 @@
+#include "SeriesStore.h"
+
+#include <string.h>
+#include <unistd.h>
+
+static bool readSlot(SeriesState *state, uint32_t sequence, uint8_t *block){
+  long offset = (long)(sequence % SERIES_STORE_BLOCKS) * SERIES_BLOCK_SIZE;
+  return fseek(state->file, offset, SEEK_SET) == 0 && fread(block, SERIES_BLOCK_SIZE, 1, state->file) == 1;
+}
+
+static bool writeOpenBlock(SeriesStore *store, SeriesState *state){
+  uint8_t block[SERIES_BLOCK_SIZE];
+  seriesBlockSerialize(&state->open, block);
+
+  long offset = (long)(state->open.header.sequence % SERIES_STORE_BLOCKS) * SERIES_BLOCK_SIZE;
+  bool written = fseek(state->file, offset, SEEK_SET) == 0 && fwrite(block, SERIES_BLOCK_SIZE, 1, state->file) == 1 &&
+                 fflush(state->file) == 0 && fsync(fileno(state->file)) == 0;
+  store->stats.blockWrites++;
+  if(!written){
+    store->stats.writeErrors++;
+    return false;
+  }
+  state->dirty = false;
+  return true;
+}
+
+/*  Newest valid block first: the ring is intact back to the first gap or sequence mismatch  */
+static void scanSeries(SeriesState *state, uint8_t series, SeriesKind kind){
+  uint8_t block[SERIES_BLOCK_SIZE];
+  SeriesBlockHeader header;
+  bool found = false;
+  uint32_t newest = 0;
+
+  for(uint32_t slot = 0; slot < SERIES_STORE_BLOCKS; slot++){
+    if(!readSlot(state, slot, block)){
+      break;    // end of a file that never filled the ring
+    }
+    if(seriesBlockParseHeader(block, &header) && header.series == series && header.sequence % SERIES_STORE_BLOCKS == slot &&
+       (!found || header.sequence > newest)){
+      newest = header.sequence;
+      found = true;
+    }
+  }
+
+  seriesBlockEncoderInit(&state->open, kind, series, found ? newest : 0);
+  state->oldestSequence = state->open.header.sequence;
+  if(!found){
+    return;
+  }
+
+  // appending the newest block's samples again leaves the encoder exactly where it was
+  readSlot(state, newest, block);
+  SeriesBlockDecoder decoder;
+  SeriesSample sample;
+  seriesBlockDecoderInit(&decoder, block, kind);
+  while(seriesBlockNext(&decoder, &sample)){
+    seriesBlockAppend(&state->open, sample.timestamp, sample.value);
+  }
+
+  while(state->oldestSequence > 0 && newest - (state->oldestSequence - 1) < SERIES_STORE_BLOCKS){
+    uint32_t sequence = state->oldestSequence - 1;
+    if(!readSlot(state, sequence, block) || !seriesBlockParseHeader(block, &header) || header.sequence != sequence ||
+       header.series != series){
+      break;
+    }
+    state->firstTimestamps[sequence % SERIES_STORE_BLOCKS] = header.firstTimestamp;
+    state->oldestSequence = sequence;
+  }
+}
+
+bool seriesStoreOpen(SeriesStore *store, const char *directory, const SeriesConfig *configs, uint8_t count){
+  memset(store, 0, sizeof(*store));
+  if(count > SERIES_STORE_MAX_SERIES){
+    return false;
+  }
+  store->configs = configs;
+  store->count = count;
+
+  for(uint8_t series = 0; series < count; series++){
+    char path[SERIES_STORE_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s.ts", directory, configs[series].name);
+
+    SeriesState *state = &store->series[series];
+    state->file = fopen(path, "r+b");
+    if(state->file == NULL){
+      state->file = fopen(path, "w+b");
+    }
+    if(state->file == NULL){
+      seriesStoreClose(store);
+      return false;
+    }
+    scanSeries(state, series, configs[series].kind);
+  }
+  return true;
+}
+
+void seriesStoreClose(SeriesStore *store){
+  seriesStoreFlush(store);
+  for(uint8_t series = 0; series < store->count; series++){
+    if(store->series[series].file != NULL){
+      fclose(store->series[series].file);
+      store->series[series].file = NULL;
+    }
+  }
+}
+
+bool seriesStoreAppend(SeriesStore *store, uint8_t series, uint32_t timestamp, SeriesValue value, uint32_t nowMs){
+  if(series >= store->count){
+    return false;
+  }
+  SeriesState *state = &store->series[series];
+  if(state->open.header.count > 0 && timestamp < state->open.header.lastTimestamp){
+    store->stats.rejected++;
+    return false;
+  }
+
+  if(!seriesBlockAppend(&state->open, timestamp, value)){
+    // full: the block goes to flash for good and a new one starts in the next slot
+    writeOpenBlock(store, state);
+    uint32_t sequence = state->open.header.sequence;
+    state->firstTimestamps[sequence % SERIES_STORE_BLOCKS] = state->open.header.firstTimestamp;
+
+    // the new block's slot belongs to the oldest closed block once the ring is full
+    if(sequence + 1 - state->oldestSequence >= SERIES_STORE_BLOCKS){
+      state->oldestSequence = sequence + 2 - SERIES_STORE_BLOCKS;
+    }
+    seriesBlockEncoderInit(&state->open, store->configs[series].kind, series, sequence + 1);
+    seriesBlockAppend(&state->open, timestamp, value);
+  }
+
+  if(!state->dirty){
+    state->dirty = true;
+    state->dirtySinceMs = nowMs;
+  }
+  store->stats.appended++;
+  return true;
+}
+
+void seriesStoreTick(SeriesStore *store, uint32_t nowMs){
+  for(uint8_t series = 0; series < store->count; series++){
+    SeriesState *state = &store->series[series];
+    if(state->dirty && nowMs - state->dirtySinceMs >= SERIES_STORE_FLUSH_PERIOD){
+      writeOpenBlock(store, state);
+    }
+  }
+}
+
+void seriesStoreFlush(SeriesStore *store){
+  for(uint8_t series = 0; series < store->count; series++){
+    if(store->series[series].dirty){
+      writeOpenBlock(store, &store->series[series]);
+    }
+  }
+}
+
+/*  Visits the samples of one serialized block that fall in [from, to], false once the visitor stopped or `to` was passed  */
+static bool visitBlock(const uint8_t *block, SeriesKind kind, uint32_t from, uint32_t to, SeriesVisitor visitor, void *context,
+                       uint32_t *visited){
+  SeriesBlockDecoder decoder;
+  SeriesSample sample;
+  seriesBlockDecoderInit(&decoder, block, kind);
+  while(seriesBlockNext(&decoder, &sample)){
+    if(sample.timestamp > to){
+      return false;
+    }
+    if(sample.timestamp >= from){
+      (*visited)++;
+      if(!visitor(&sample, context)){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+uint32_t seriesStoreQuery(SeriesStore *store, uint8_t series, uint32_t from, uint32_t to, SeriesVisitor visitor, void *context){
+  if(series >= store->count || from > to){
+    return 0;
+  }
+  SeriesState *state = &store->series[series];
+  SeriesKind kind = store->configs[series].kind;
+  uint8_t block[SERIES_BLOCK_SIZE];
+  uint32_t visited = 0;
+
+  // first closed block starting at or after `from`, the one before it may still reach into the range
+  uint32_t closed = state->open.header.sequence - state->oldestSequence;
+  uint32_t low = 0, high = closed;
+  while(low < high){
+    uint32_t middle = low + (high - low) / 2;
+    if(state->firstTimestamps[(state->oldestSequence + middle) % SERIES_STORE_BLOCKS] < from){
+      low = middle + 1;
+    }else{
+      high = middle;
+    }
+  }
+
+  SeriesBlockHeader header;
+  for(uint32_t index = low > 0 ? low - 1 : 0; index < closed; index++){
+    uint32_t sequence = state->oldestSequence + index;
+    if(state->firstTimestamps[sequence % SERIES_STORE_BLOCKS] > to){
+      return visited;
+    }
+    // a block that no longer reads back is skipped, the rest of the range is still good
+    if(!readSlot(state, sequence, block) || !seriesBlockParseHeader(block, &header) || header.sequence != sequence){
+      continue;
+    }
+    if(!visitBlock(block, kind, from, to, visitor, context, &visited)){
+      return visited;
+    }
+  }
+
+  if(state->open.header.count > 0){
+    seriesBlockSerialize(&state->open, block);
+    visitBlock(block, kind, from, to, visitor, context, &visited);
+  }
+  return visited;
+}
+
+uint32_t seriesStoreBlocks(const SeriesStore *store, uint8_t series){
+  const SeriesState *state = &store->series[series];
+  return state->open.header.sequence - state->oldestSequence + (state->open.header.count > 0 ? 1 : 0);
+}
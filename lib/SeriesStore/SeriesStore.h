@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef SERIES_STORE_H
+#define SERIES_STORE_H
+
+#include <stdio.h>
+
+#include "SeriesCodec.h"
+
+#define SERIES_STORE_MAX_SERIES 4
+#define SERIES_STORE_BLOCKS 256             // ring of blocks per series: 64 KB of flash each
+#define SERIES_STORE_FLUSH_PERIOD 600000    // ms a sample may sit in the open block before it is written anyway
+#define SERIES_STORE_PATH_MAX 48
+
+typedef struct{
+  const char *name;     // file name, keep it short
+  SeriesKind kind;
+}SeriesConfig;
+
+typedef struct{
+  FILE *file;
+  uint32_t firstTimestamps[SERIES_STORE_BLOCKS];  // block index of the closed blocks, by sequence % SERIES_STORE_BLOCKS
+  uint32_t oldestSequence;                        // closed blocks are [oldestSequence, open.header.sequence)
+  SeriesBlockEncoder open;                        // newest block, only written when full or when a flush is due
+  bool dirty;
+  uint32_t dirtySinceMs;
+}SeriesState;
+
+typedef struct{
+  uint32_t appended;
+  uint32_t rejected;        // older than the newest sample of their series
+  uint32_t blockWrites;     // full blocks plus flushes of the open block, i.e. flash wear
+  uint32_t writeErrors;
+}SeriesStoreStats;
+
+/*  Append-only time series, one file of fixed size blocks per series, written as a ring.
+ *  Every block is compressed on its own, so a range read only decodes the blocks it overlaps  */
+typedef struct{
+  const SeriesConfig *configs;
+  uint8_t count;
+  SeriesState series[SERIES_STORE_MAX_SERIES];
+  SeriesStoreStats stats;
+}SeriesStore;
+
+/*  Returns false if a file cannot be opened. Rebuilds the block index from the block headers
+ *  and reopens the newest block, so appending continues where the last boot stopped  */
+bool seriesStoreOpen(SeriesStore *store, const char *directory, const SeriesConfig *configs, uint8_t count);
+void seriesStoreClose(SeriesStore *store);
+
+/*  Timestamps are seconds and may not go backwards within a series, older samples are rejected  */
+bool seriesStoreAppend(SeriesStore *store, uint8_t series, uint32_t timestamp, SeriesValue value, uint32_t nowMs);
+
+/*  Writes the open blocks whose oldest unsaved sample has waited SERIES_STORE_FLUSH_PERIOD  */
+void seriesStoreTick(SeriesStore *store, uint32_t nowMs);
+
+/*  Writes every open block with unsaved samples, e.g. before a planned reset  */
+void seriesStoreFlush(SeriesStore *store);
+
+/*  Return false to stop the query early  */
+typedef bool (*SeriesVisitor)(const SeriesSample *sample, void *context);
+
+/*  Visits the samples of [from, to] oldest first, returns how many were visited  */
+uint32_t seriesStoreQuery(SeriesStore *store, uint8_t series, uint32_t from, uint32_t to, SeriesVisitor visitor, void *context);
+
+/*  Blocks in use by a series, the open one included  */
+uint32_t seriesStoreBlocks(const SeriesStore *store, uint8_t series);
+
+#endif
@@ -0,0 +1,26 @@
+#include "StaticRtos.h"
+
+uint8_t staticQueuesCreate(const StaticQueueConfig *queues, uint8_t count){
+  uint8_t failed = 0;
+  for(uint8_t i = 0; i < count; i++){
+    const StaticQueueConfig *config = &queues[i];
+    *config->handle = xQueueCreateStatic(config->length, config->itemSize, config->storage, config->queue);
+    if(*config->handle == NULL){
+      failed++;
+    }
+  }
+  return failed;
+}
+
+uint8_t staticTasksCreate(const StaticTaskConfig *tasks, uint8_t count){
+  uint8_t failed = 0;
+  for(uint8_t i = 0; i < count; i++){
+    const StaticTaskConfig *config = &tasks[i];
+    *config->handle = xTaskCreateStaticPinnedToCore(config->function, config->name, config->stackBytes, NULL,
+                                                    config->priority, config->stack, config->tcb, config->core);
+    if(*config->handle == NULL){
+      failed++;
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef STATIC_RTOS_H
+#define STATIC_RTOS_H
+
+#include <Arduino.h>
+
+/*  Tasks and queues whose memory is reserved at link time instead of taken from the heap at boot.
+ *  A table is an X-macro listing one entry per object, e.g.
+ *
+ *    #define APP_TASKS(X) \
+ *      X(readDHT, readDHT_handle, "DHT", 2000, 1, 1) \
+ *      X(readMPU, readMPU_handle, "MPU", 3000, 2, 1)
+ *
+ *  APP_TASKS(STATIC_TASK_STORAGE) declares the handles and buffers, APP_TASKS(STATIC_TASK_CONFIG)
+ *  inside braces the array staticTasksCreate() takes, and 0 APP_TASKS(STATIC_TASK_BYTES) the RAM
+ *  the whole table takes, as a constant expression. Stack sizes are in bytes, like everywhere in ESP-IDF  */
+
+// task entry: function, handle, name, stack bytes, priority, core
+#define STATIC_TASK_STORAGE(function, handle, name, stackBytes, priority, core) \
+  TaskHandle_t handle; \
+  static StackType_t function##Stack[stackBytes]; \
+  static StaticTask_t function##Tcb;
+#define STATIC_TASK_CONFIG(function, handle, name, stackBytes, priority, core) \
+  {function, #function, name, stackBytes, priority, core, function##Stack, &function##Tcb, &handle},
+#define STATIC_TASK_BYTES(function, handle, name, stackBytes, priority, core) \
+  + (stackBytes) + sizeof(StaticTask_t)
+
+// queue entry: handle, name, length, item size
+#define STATIC_QUEUE_STORAGE(handle, name, length, itemSize) \
+  QueueHandle_t handle; \
+  static uint8_t handle##Storage[(length) * (itemSize)]; \
+  static StaticQueue_t handle##Queue;
+#define STATIC_QUEUE_CONFIG(handle, name, length, itemSize) \
+  {name, length, itemSize, handle##Storage, &handle##Queue, &handle},
+#define STATIC_QUEUE_BYTES(handle, name, length, itemSize) \
+  + (length) * (itemSize) + sizeof(StaticQueue_t)
+
+typedef struct{
+  TaskFunction_t function;
+  const char *functionName;   // what tuned stack sizes are keyed on, the name can change
+  const char *name;
+  uint32_t stackBytes;
+  UBaseType_t priority;
+  BaseType_t core;
+  StackType_t *stack;
+  StaticTask_t *tcb;
+  TaskHandle_t *handle;
+}StaticTaskConfig;
+
+typedef struct{
+  const char *name;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  uint8_t *storage;
+  StaticQueue_t *queue;
+  QueueHandle_t *handle;
+}StaticQueueConfig;
+
+/*  Both fill in every handle and return how many objects failed, their handles stay NULL.
+ *  With the memory already reserved only a bad entry (e.g. a core that doesn't exist) can fail  */
+uint8_t staticQueuesCreate(const StaticQueueConfig *queues, uint8_t count);
+uint8_t staticTasksCreate(const StaticTaskConfig *tasks, uint8_t count);
+
+#endif
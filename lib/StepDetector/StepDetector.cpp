@@ -0,0 +1,48 @@
+#include "StepDetector.h"
+
+#include <math.h>
+#include <string.h>
+
+void stepDetectorInit(StepDetector *detector, const StepDetectorConfig *config){
+  memset(detector, 0, sizeof(StepDetector));
+  detector->config = config;
+}
+
+bool stepDetectorUpdate(StepDetector *detector, const float acceleration[3], uint32_t nowMs){
+  float magnitude = sqrtf(
+    acceleration[0] * acceleration[0] +
+    acceleration[1] * acceleration[1] +
+    acceleration[2] * acceleration[2]
+  );
+
+  const StepDetectorConfig *config = detector->config;
+  uint8_t length = config->windowLength;
+  if(length < 1 || length > STEP_WINDOW_LENGTH){
+    length = STEP_WINDOW_LENGTH;
+  }
+
+  // after a shorter window is configured the index may point past it
+  if(detector->windowIndex >= length){
+    detector->windowIndex = 0;
+  }
+  detector->window[detector->windowIndex] = magnitude;
+  detector->windowIndex = (detector->windowIndex + 1) % length;
+
+  float average = 0;
+  for(uint8_t i = 0; i < length; i++){
+    average += detector->window[i];
+  }
+  average /= length;
+  detector->averageMagnitude = average;
+
+  if(magnitude <= average + config->threshold){
+    detector->aboveThreshold = false;
+    return false;
+  }
+  if(detector->aboveThreshold || nowMs - detector->lastStepMs <= config->debounceMs){
+    return false;
+  }
+  detector->aboveThreshold = true;
+  detector->lastStepMs = nowMs;
+  return true;
+}
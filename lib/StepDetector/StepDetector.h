@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef STEP_DETECTOR_H
+#define STEP_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STEP_WINDOW_LENGTH 15       // samples in the moving average, 150 ms at 100 Hz, also the longest window
+#define STEP_THRESHOLD 1.0f         // g above the moving average that counts as a step
+#define STEP_DEBOUNCE 300           // ms, minimum time between two steps
+
+/*  Read on every sample, so it can be changed while the detector runs  */
+typedef struct{
+  float threshold;          // g
+  uint32_t debounceMs;
+  uint32_t windowLength;    // 1 to STEP_WINDOW_LENGTH samples
+}StepDetectorConfig;
+
+#define STEP_DETECTOR_DEFAULTS {STEP_THRESHOLD, STEP_DEBOUNCE, STEP_WINDOW_LENGTH}
+
+/*  A step is the acceleration magnitude rising config->threshold above its moving average,
+ *  at most one per excursion and one per config->debounceMs  */
+typedef struct{
+  const StepDetectorConfig *config;
+  float window[STEP_WINDOW_LENGTH];
+  uint8_t windowIndex;
+  float averageMagnitude;
+  bool aboveThreshold;      // inside an excursion that already counted
+  uint32_t lastStepMs;
+}StepDetector;
+
+void stepDetectorInit(StepDetector *detector, const StepDetectorConfig *config);
+
+/*  Feeds one sample in g, returns true when it completes a step  */
+bool stepDetectorUpdate(StepDetector *detector, const float acceleration[3], uint32_t nowMs);
+
+#endif
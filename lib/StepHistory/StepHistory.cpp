@@ -0,0 +1,78 @@
+#include "StepHistory.h"
+
+#include <string.h>
+
+void stepHistoryInit(StepHistory *history, uint32_t nowMinute){
+  memset(history, 0, sizeof(StepHistory));
+  history->currentMinute = nowMinute;
+  history->columnsDirty = true;
+}
+
+static uint16_t runningHourSteps(const StepHistory *history){
+  uint32_t sum = 0;
+  uint32_t hourStart = history->currentMinute - history->currentMinute % STEP_HISTORY_MINUTES;
+  for(uint32_t minute = hourStart; minute <= history->currentMinute; minute++){
+    sum += history->minuteBuckets[minute % STEP_HISTORY_MINUTES];
+  }
+  return sum > UINT16_MAX ? UINT16_MAX : sum;
+}
+
+bool stepHistoryAdvance(StepHistory *history, uint32_t nowMinute){
+  if(nowMinute <= history->currentMinute){
+    return false;
+  }
+
+  // nothing of the old window survives a gap of a whole day
+  if(nowMinute - history->currentMinute >= STEP_HISTORY_HOURS * STEP_HISTORY_MINUTES){
+    stepHistoryInit(history, nowMinute);
+    return true;
+  }
+
+  while(history->currentMinute < nowMinute){
+    history->currentMinute++;
+    if(history->currentMinute % STEP_HISTORY_MINUTES == 0){
+      // the previous hour's bucket already holds its roll-up, start the new hour (the one from 24 h ago) empty
+      uint32_t hour = history->currentMinute / STEP_HISTORY_MINUTES;
+      history->hourBuckets[hour % STEP_HISTORY_HOURS] = 0;
+      memset(history->minuteBuckets, 0, sizeof(history->minuteBuckets));
+      history->columnsDirty = true;
+    }
+  }
+
+  return history->columnsDirty;
+}
+
+void stepHistoryAddSteps(StepHistory *history, uint32_t nowMinute, uint16_t steps){
+  stepHistoryAdvance(history, nowMinute);
+
+  uint16_t *bucket = &history->minuteBuckets[history->currentMinute % STEP_HISTORY_MINUTES];
+  *bucket = (UINT16_MAX - *bucket < steps) ? UINT16_MAX : *bucket + steps;
+
+  history->hourBuckets[(history->currentMinute / STEP_HISTORY_MINUTES) % STEP_HISTORY_HOURS] = runningHourSteps(history);
+  history->columnsDirty = true;
+}
+
+const uint8_t *stepHistoryColumns(StepHistory *history){
+  if(!history->columnsDirty){
+    return history->columnHeights;
+  }
+
+  uint32_t currentHour = history->currentMinute / STEP_HISTORY_MINUTES;
+  uint16_t maxSteps = 1;
+  for(uint8_t i = 0; i < STEP_HISTORY_HOURS; i++){
+    if(history->hourBuckets[i] > maxSteps){
+      maxSteps = history->hourBuckets[i];
+    }
+  }
+
+  // column 0 is 23 hours ago, the last column is the running hour
+  for(uint8_t column = 0; column < STEP_HISTORY_HOURS; column++){
+    uint32_t hour = currentHour + 1 + column;
+    uint16_t steps = history->hourBuckets[hour % STEP_HISTORY_HOURS];
+    history->columnHeights[column] = (uint32_t)steps * STEP_HISTORY_GRAPH_HEIGHT / maxSteps;
+  }
+
+  history->columnMax = maxSteps;
+  history->columnsDirty = false;
+  return history->columnHeights;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef STEP_HISTORY_H
+#define STEP_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STEP_HISTORY_MINUTES 60       // minute buckets of the running hour
+#define STEP_HISTORY_HOURS 24         // hourly buckets, the last one is the running hour
+#define STEP_HISTORY_GRAPH_HEIGHT 40  // px, tallest column
+
+typedef struct{
+  uint16_t minuteBuckets[STEP_HISTORY_MINUTES];   // indexed by minute % 60
+  uint16_t hourBuckets[STEP_HISTORY_HOURS];       // indexed by hour % 24, rolled up from the minute buckets
+  uint32_t currentMinute;                         // minutes since boot the buckets are up to date with
+  uint8_t columnHeights[STEP_HISTORY_HOURS];      // oldest to newest, ready to draw
+  uint16_t columnMax;                             // steps of the tallest column
+  bool columnsDirty;
+}StepHistory;
+
+void stepHistoryInit(StepHistory *history, uint32_t nowMinute);
+
+/*  Rolls the buckets forward to nowMinute, returns true if the graph changed  */
+bool stepHistoryAdvance(StepHistory *history, uint32_t nowMinute);
+
+void stepHistoryAddSteps(StepHistory *history, uint32_t nowMinute, uint16_t steps);
+
+/*  Column heights oldest to newest, recomputed only after the buckets changed  */
+const uint8_t *stepHistoryColumns(StepHistory *history);
+
+#endif
@@ -0,0 +1,51 @@
+#include "JsonWriter.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+
+void jsonAppend(JsonWriter *writer, const char *format, ...){
+  if(writer->overflow){
+    return;
+  }
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf(writer->out + writer->length, writer->size - writer->length, format, args);
+  va_end(args);
+  if(written < 0 || (size_t)written >= writer->size - writer->length){
+    writer->overflow = true;
+    return;
+  }
+  writer->length += written;
+}
+
+void jsonAppendNumber(JsonWriter *writer, double value, uint8_t decimals){
+  if(!isfinite(value) || fabs(value) >= JSON_NUMBER_LIMIT){
+    jsonAppend(writer, "null");
+    return;
+  }
+  jsonAppend(writer, "%.*f", decimals, value);
+}
+
+void jsonAppendString(JsonWriter *writer, const char *value){
+  jsonAppend(writer, "\"");
+  for(; *value; value++){
+    char c = *value;
+    if(c == '"' || c == '\\'){
+      jsonAppend(writer, "\\%c", c);
+    }else if((unsigned char)c < 0x20){
+      jsonAppend(writer, "\\u%04x", (unsigned)c);
+    }else{
+      jsonAppend(writer, "%c", c);
+    }
+  }
+  jsonAppend(writer, "\"");
+}
+
+size_t jsonFinish(JsonWriter *writer){
+  if(writer->overflow){
+    writer->out[0] = '\0';
+    return 0;
+  }
+  return writer->length;
+}
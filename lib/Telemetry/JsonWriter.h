@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*  Appends into a fixed buffer, once something does not fit every later append is a no-op  */
+typedef struct{
+  char *out;
+  size_t size;
+  size_t length;
+  bool overflow;
+}JsonWriter;
+
+void jsonAppend(JsonWriter *writer, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/*  Numbers from outside (sensors, the weather API) past this are written as null, like NaN and infinity,
+ *  so a garbage reading can't make a document longer than its buffer was sized for  */
+#define JSON_NUMBER_LIMIT 1e9
+
+/*  `decimals` digits after the point, at most 11 + decimals characters  */
+void jsonAppendNumber(JsonWriter *writer, double value, uint8_t decimals);
+
+/*  Quoted and escaped, whatever the string holds  */
+void jsonAppendString(JsonWriter *writer, const char *value);
+
+/*  Length of the document, or 0 (and an empty string) if it overflowed  */
+size_t jsonFinish(JsonWriter *writer);
+
+#endif
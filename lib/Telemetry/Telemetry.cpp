@@ -0,0 +1,50 @@
+#include "Telemetry.h"
+
+#include "JsonWriter.h"
+
+size_t telemetryToJson(const TelemetrySnapshot *snapshot, char *out, size_t outSize){
+  if(outSize == 0){
+    return 0;
+  }
+  JsonWriter writer = {out, outSize, 0, false};
+
+  jsonAppend(&writer, "{\"seq\":%u,\"uptime\":%u", (unsigned)snapshot->sequence, (unsigned)snapshot->uptimeS);
+
+  if(snapshot->valid & TELEMETRY_VALID_STEPS){
+    jsonAppend(&writer, ",\"steps\":%d", (int)snapshot->steps);
+  }else{
+    jsonAppend(&writer, ",\"steps\":null");
+  }
+
+  if(snapshot->valid & TELEMETRY_VALID_PULSE){
+    jsonAppend(&writer, ",\"bpm\":%u", (unsigned)snapshot->bpm);
+  }else{
+    jsonAppend(&writer, ",\"bpm\":null");
+  }
+
+  if(snapshot->valid & TELEMETRY_VALID_ENV){
+    jsonAppend(&writer, ",\"temp\":");
+    jsonAppendNumber(&writer, snapshot->temperature, 1);
+    jsonAppend(&writer, ",\"rh\":");
+    jsonAppendNumber(&writer, snapshot->humidity, 0);
+  }else{
+    jsonAppend(&writer, ",\"temp\":null,\"rh\":null");
+  }
+
+  if(snapshot->valid & TELEMETRY_VALID_WEATHER){
+    jsonAppend(&writer, ",\"weather\":{\"feels\":");
+    jsonAppendNumber(&writer, snapshot->weatherFeelsLike, 1);
+    jsonAppend(&writer, ",\"rh\":");
+    jsonAppendNumber(&writer, snapshot->weatherHumidity, 0);
+    jsonAppend(&writer, ",\"wind\":");
+    jsonAppendNumber(&writer, snapshot->windSpeed, 1);
+    jsonAppend(&writer, ",\"desc\":");
+    jsonAppendString(&writer, snapshot->weatherDescription);
+    jsonAppend(&writer, "}");
+  }else{
+    jsonAppend(&writer, ",\"weather\":null");
+  }
+
+  jsonAppend(&writer, "}");
+  return jsonFinish(&writer);
+}
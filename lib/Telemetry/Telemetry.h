@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*  Which fields of a snapshot have been produced at least once, the others serialize as null  */
+#define TELEMETRY_VALID_STEPS   (1u << 0)
+#define TELEMETRY_VALID_PULSE   (1u << 1)
+#define TELEMETRY_VALID_ENV     (1u << 2)
+#define TELEMETRY_VALID_WEATHER (1u << 3)
+
+#define TELEMETRY_WEATHER_DESC_LENGTH 32
+/*  Fits any snapshot: every number at its longest (see jsonAppendNumber()) and a description of
+ *  nothing but control characters, 6 bytes each escaped. The native runner checks it  */
+#define TELEMETRY_JSON_MAX_LENGTH 384
+
+/*  Latest value of every producer, the one shape every network consumer publishes  */
+typedef struct{
+  uint32_t sequence;        // bumped by every change, consumers compare it to skip duplicates
+  uint32_t uptimeS;
+  uint8_t valid;            // TELEMETRY_VALID_* bits
+  int32_t steps;
+  uint16_t bpm;
+  float temperature;        // °C, DHT11
+  float humidity;           // %RH, DHT11
+  float weatherFeelsLike;   // °C, OpenWeather
+  float weatherHumidity;
+  float windSpeed;          // m/s
+  char weatherDescription[TELEMETRY_WEATHER_DESC_LENGTH];
+}TelemetrySnapshot;
+
+/*  Writes the snapshot as one JSON object, returns its length or 0 if it does not fit  */
+size_t telemetryToJson(const TelemetrySnapshot *snapshot, char *out, size_t outSize);
+
+#endif
@@ -0,0 +1,71 @@
+#include "TelemetryBatch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+void telemetryBatchStart(TelemetryBatch *batch, uint32_t sequence, uint32_t nowS, uint16_t periodS){
+  memset(batch, 0, sizeof(TelemetryBatch));
+  batch->sequence = sequence;
+  batch->startS = nowS;
+  batch->periodS = periodS;
+}
+
+bool telemetryBatchAdd(TelemetryBatch *batch, const TelemetrySnapshot *snapshot){
+  if(batch->count >= TELEMETRY_BATCH_MAX_RECORDS){
+    return true;
+  }
+  TelemetryRecord *record = &batch->records[batch->count++];
+  record->steps = snapshot->steps;
+  record->bpm = snapshot->bpm;
+  record->temperatureDeci = (int16_t)(snapshot->temperature * 10.0f + (snapshot->temperature < 0 ? -0.5f : 0.5f));
+  record->humidity = (uint8_t)(snapshot->humidity + 0.5f);
+  record->valid = snapshot->valid;
+  return batch->count >= TELEMETRY_BATCH_MAX_RECORDS;
+}
+
+static bool append(char *out, size_t outSize, size_t *length, int written){
+  if(written < 0 || (size_t)written >= outSize - *length){
+    return false;
+  }
+  *length += written;
+  return true;
+}
+
+size_t telemetryBatchToJson(const TelemetryBatch *batch, char *out, size_t outSize){
+  if(outSize == 0){
+    return 0;
+  }
+  size_t length = 0;
+  bool ok = append(out, outSize, &length, snprintf(out, outSize,
+    "{\"seq\":%u,\"t0\":%u,\"dt\":%u,\"rssi\":%d,\"heap\":%u,\"heapMin\":%u,\"f\":[\"steps\",\"bpm\",\"temp\",\"rh\"],\"d\":[",
+    (unsigned)batch->sequence, (unsigned)batch->startS, (unsigned)batch->periodS, (int)batch->rssi,
+    (unsigned)batch->freeHeap, (unsigned)batch->minFreeHeap));
+
+  for(uint8_t i = 0; ok && i < batch->count; i++){
+    const TelemetryRecord *record = &batch->records[i];
+    char steps[12] = "null";
+    char bpm[8] = "null";
+    char temperature[10] = "null";
+    char humidity[6] = "null";
+    if(record->valid & TELEMETRY_VALID_STEPS){
+      snprintf(steps, sizeof(steps), "%d", (int)record->steps);
+    }
+    if(record->valid & TELEMETRY_VALID_PULSE){
+      snprintf(bpm, sizeof(bpm), "%u", (unsigned)record->bpm);
+    }
+    if(record->valid & TELEMETRY_VALID_ENV){
+      int deci = record->temperatureDeci;
+      snprintf(temperature, sizeof(temperature), "%s%d.%d", deci < 0 ? "-" : "", (deci < 0 ? -deci : deci) / 10, (deci < 0 ? -deci : deci) % 10);
+      snprintf(humidity, sizeof(humidity), "%u", (unsigned)record->humidity);
+    }
+    ok = append(out, outSize, &length, snprintf(out + length, outSize - length, "%s[%s,%s,%s,%s]",
+      i ? "," : "", steps, bpm, temperature, humidity));
+  }
+
+  ok = ok && append(out, outSize, &length, snprintf(out + length, outSize - length, "]}"));
+  if(!ok){
+    out[0] = '\0';
+    return 0;
+  }
+  return length;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef TELEMETRY_BATCH_H
+#define TELEMETRY_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "Telemetry.h"
+
+#define TELEMETRY_BATCH_MAX_RECORDS 12
+#define TELEMETRY_BATCH_JSON_MAX_LENGTH 640    // worst case of a full batch, every field at its widest
+
+/*  One sample, fixed point so a batch stays small while it waits in the offline buffer  */
+typedef struct{
+  int32_t steps;
+  uint16_t bpm;
+  int16_t temperatureDeci;  // 0.1 °C
+  uint8_t humidity;         // %RH
+  uint8_t valid;            // TELEMETRY_VALID_* bits of the snapshot it came from
+}TelemetryRecord;
+
+typedef struct{
+  uint32_t sequence;        // consumers drop QoS1 duplicates by it
+  uint32_t startS;          // uptime of the first record
+  uint16_t periodS;         // between records
+  uint8_t count;
+  int8_t rssi;              // device health, taken when the batch closes
+  uint32_t freeHeap;
+  uint32_t minFreeHeap;
+  TelemetryRecord records[TELEMETRY_BATCH_MAX_RECORDS];
+}TelemetryBatch;
+
+void telemetryBatchStart(TelemetryBatch *batch, uint32_t sequence, uint32_t nowS, uint16_t periodS);
+
+/*  Returns true once the batch is full  */
+bool telemetryBatchAdd(TelemetryBatch *batch, const TelemetrySnapshot *snapshot);
+
+/*  Compact JSON, field names once in "f" and one array per record in "d". Returns the length or 0 if it does not fit  */
+size_t telemetryBatchToJson(const TelemetryBatch *batch, char *out, size_t outSize);
+
+#endif
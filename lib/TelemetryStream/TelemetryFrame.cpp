@@ -0,0 +1,59 @@
+#include "TelemetryFrame.h"
+
+#include <string.h>
+
+uint16_t telemetryCrc16(const uint8_t *data, size_t length){
+  uint16_t crc = 0xFFFF;
+  while(length--){
+    crc ^= (uint16_t)(*data++) << 8;
+    for(uint8_t bit = 0; bit < 8; bit++){
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// every run of up to 254 non-zero bytes becomes a length code followed by the run, no zero is left in the output
+static size_t cobsEncode(const uint8_t *in, size_t length, uint8_t *out){
+  size_t write = 1;
+  size_t codeIndex = 0;
+  uint8_t code = 1;
+
+  for(size_t read = 0; read < length; read++){
+    if(in[read] != 0){
+      out[write++] = in[read];
+      code++;
+    }
+    if(in[read] == 0 || code == 0xFF){
+      out[codeIndex] = code;
+      codeIndex = write++;
+      code = 1;
+    }
+  }
+  out[codeIndex] = code;
+  return write;
+}
+
+size_t telemetryFrameEncode(uint8_t type, uint32_t timestampUs, const uint8_t *payload, size_t payloadLength, uint8_t *out){
+  uint8_t raw[TELEMETRY_FRAME_HEADER_BYTES + TELEMETRY_FRAME_MAX_PAYLOAD + TELEMETRY_FRAME_CRC_BYTES];
+  if(payloadLength > TELEMETRY_FRAME_MAX_PAYLOAD){
+    payloadLength = TELEMETRY_FRAME_MAX_PAYLOAD;
+  }
+
+  size_t length = 0;
+  raw[length++] = type;
+  raw[length++] = (uint8_t)timestampUs;
+  raw[length++] = (uint8_t)(timestampUs >> 8);
+  raw[length++] = (uint8_t)(timestampUs >> 16);
+  raw[length++] = (uint8_t)(timestampUs >> 24);
+  memcpy(raw + length, payload, payloadLength);
+  length += payloadLength;
+
+  uint16_t crc = telemetryCrc16(raw, length);
+  raw[length++] = (uint8_t)crc;
+  raw[length++] = (uint8_t)(crc >> 8);
+
+  size_t encoded = cobsEncode(raw, length, out);
+  out[encoded++] = TELEMETRY_FRAME_DELIMITER;
+  return encoded;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*  Frame on the wire: COBS( type u8 | timestampUs u32 | payload | crc16 ) 0x00
+ *  Little endian, CRC-16/CCITT-FALSE over type, timestamp and payload.
+ *  tools/telemetry_decode.py is the reader, keep the two in sync  */
+#define TELEMETRY_FRAME_DELIMITER 0x00
+#define TELEMETRY_FRAME_HEADER_BYTES 5
+#define TELEMETRY_FRAME_CRC_BYTES 2
+#define TELEMETRY_FRAME_MAX_PAYLOAD 200
+
+/*  COBS adds one byte per 254 plus the leading code byte, and the delimiter follows  */
+#define TELEMETRY_FRAME_MAX_BYTES(payload) \
+  ((TELEMETRY_FRAME_HEADER_BYTES + (payload) + TELEMETRY_FRAME_CRC_BYTES) \
+   + (TELEMETRY_FRAME_HEADER_BYTES + (payload) + TELEMETRY_FRAME_CRC_BYTES) / 254 + 2)
+
+typedef enum : uint8_t{
+  TELEMETRY_RECORD_ACCEL = 1,     // int16 ax, ay, az (raw, ±16 g range: 2048 LSB/g)
+  TELEMETRY_RECORD_PULSE = 2,     // uint16 ADC reading
+  TELEMETRY_RECORD_DHT = 3,       // int16 temperature 0.1 °C, uint16 humidity 0.1 %RH
+  TELEMETRY_RECORD_EVENT = 4,     // uint8 TelemetryEventKind, uint16 value
+  TELEMETRY_RECORD_LOG = 5,       // log line text, no terminator
+  TELEMETRY_RECORD_DROPPED = 6    // uint32 records dropped so far
+}TelemetryRecordType;
+
+typedef enum : uint8_t{
+  TELEMETRY_EVENT_STEP = 1,       // value: step count
+  TELEMETRY_EVENT_GESTURE = 2,    // value: button << 8 | GestureType
+  TELEMETRY_EVENT_BPM = 3         // value: averaged BPM
+}TelemetryEventKind;
+
+uint16_t telemetryCrc16(const uint8_t *data, size_t length);
+
+/*  Encodes one record into `out` (at least TELEMETRY_FRAME_MAX_BYTES(payloadLength)), returns the frame length  */
+size_t telemetryFrameEncode(uint8_t type, uint32_t timestampUs, const uint8_t *payload, size_t payloadLength, uint8_t *out);
+
+#endif
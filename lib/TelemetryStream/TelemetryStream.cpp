@@ -0,0 +1,163 @@
+#include "TelemetryStream.h"
+
+static Print *output = NULL;
+static QueueHandle_t records_handle = NULL;
+static SemaphoreHandle_t outputMutex_handle = NULL;   // stream task and log frames share the UART
+static volatile bool active = false;
+static TelemetryStreamStats stats;
+
+static void put16(uint8_t *out, uint16_t value){
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+}
+
+static void streamWrite(const uint8_t *data, size_t length){
+  xSemaphoreTake(outputMutex_handle, portMAX_DELAY);
+  output->write(data, length);
+  stats.bytes += length;
+  xSemaphoreGive(outputMutex_handle);
+}
+
+static void streamPush(uint8_t type, uint32_t timestampUs, const uint8_t *payload, uint8_t length){
+  if(!active){
+    return;
+  }
+  StreamRecord record;
+  record.type = type;
+  record.length = length;
+  record.timestampUs = timestampUs;
+  memcpy(record.payload, payload, length);
+  if(xQueueSend(records_handle, &record, 0) != pdTRUE){
+    stats.dropped++;
+  }
+}
+
+static void telemetryStreamTask(void *parameters){
+  uint8_t txBuffer[TELEMETRY_STREAM_TX_BUFFER];
+  size_t txLength = 0;
+  uint32_t reportedDrops = 0;
+  StreamRecord record;
+
+  for(;;){
+    // flush once the queue runs dry, so a quiet stream still goes out promptly
+    TickType_t wait = txLength > 0 ? 0 : portMAX_DELAY;
+    if(xQueueReceive(records_handle, &record, wait) != pdTRUE){
+      streamWrite(txBuffer, txLength);
+      txLength = 0;
+
+      if(stats.dropped != reportedDrops && active){
+        reportedDrops = stats.dropped;
+        uint8_t payload[4] = {(uint8_t)reportedDrops, (uint8_t)(reportedDrops >> 8), (uint8_t)(reportedDrops >> 16), (uint8_t)(reportedDrops >> 24)};
+        txLength = telemetryFrameEncode(TELEMETRY_RECORD_DROPPED, micros(), payload, sizeof(payload), txBuffer);
+      }
+      continue;
+    }
+
+    if(txLength + TELEMETRY_FRAME_MAX_BYTES(TELEMETRY_STREAM_RECORD_PAYLOAD) > sizeof(txBuffer)){
+      streamWrite(txBuffer, txLength);
+      txLength = 0;
+    }
+    txLength += telemetryFrameEncode(record.type, record.timestampUs, record.payload, record.length, txBuffer + txLength);
+    stats.records++;
+  }
+}
+
+/*  Log lines are framed right in the log drain task, they are rare next to the sensor records  */
+class TelemetryLogPrint : public Print{
+public:
+  size_t write(uint8_t c) override{
+    return write(&c, 1);
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) override{
+    if(!active){
+      return size;
+    }
+    // the logger ends every line with '\n', the decoder adds its own
+    size_t length = size;
+    while(length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == '\r')){
+      length--;
+    }
+    if(length > TELEMETRY_FRAME_MAX_PAYLOAD){
+      length = TELEMETRY_FRAME_MAX_PAYLOAD;
+    }
+    uint8_t frame[TELEMETRY_FRAME_MAX_BYTES(TELEMETRY_FRAME_MAX_PAYLOAD)];
+    size_t frameLength = telemetryFrameEncode(TELEMETRY_RECORD_LOG, micros(), buffer, length, frame);
+    streamWrite(frame, frameLength);
+    stats.records++;
+    return size;
+  }
+};
+
+static TelemetryLogPrint logOutput;
+
+void telemetryStreamInit(Print &out, TelemetryStreamStorage *storage, UBaseType_t taskPriority, BaseType_t core){
+  output = &out;
+  memset(&stats, 0, sizeof(stats));
+  records_handle = xQueueCreateStatic(TELEMETRY_STREAM_QUEUE_SIZE, sizeof(StreamRecord), storage->recordStorage,
+                                      &storage->records);
+  outputMutex_handle = xSemaphoreCreateMutexStatic(&storage->outputMutex);
+
+  xTaskCreateStaticPinnedToCore(
+    telemetryStreamTask,
+    "TELEMETRY STREAM",
+    TELEMETRY_STREAM_TASK_STACK,
+    NULL,
+    taskPriority,
+    storage->stack,
+    &storage->tcb,
+    core
+  );
+}
+
+void telemetryStreamEnable(bool enable){
+  if(enable && !active){
+    // ends whatever text was still going out, so the first frame decodes
+    const uint8_t delimiter = TELEMETRY_FRAME_DELIMITER;
+    streamWrite(&delimiter, 1);
+  }
+  active = enable;
+  if(!enable){
+    xQueueReset(records_handle);
+  }
+}
+
+bool telemetryStreamActive(){
+  return active;
+}
+
+void telemetryStreamAccel(uint32_t timestampUs, int16_t ax, int16_t ay, int16_t az){
+  uint8_t payload[6];
+  put16(payload, (uint16_t)ax);
+  put16(payload + 2, (uint16_t)ay);
+  put16(payload + 4, (uint16_t)az);
+  streamPush(TELEMETRY_RECORD_ACCEL, timestampUs, payload, sizeof(payload));
+}
+
+void telemetryStreamPulse(uint32_t timestampUs, uint16_t adc){
+  uint8_t payload[2];
+  put16(payload, adc);
+  streamPush(TELEMETRY_RECORD_PULSE, timestampUs, payload, sizeof(payload));
+}
+
+void telemetryStreamDht(uint32_t timestampUs, float temperature, float humidity){
+  uint8_t payload[4];
+  put16(payload, (uint16_t)(int16_t)lroundf(temperature * 10.0f));
+  put16(payload + 2, (uint16_t)lroundf(humidity * 10.0f));
+  streamPush(TELEMETRY_RECORD_DHT, timestampUs, payload, sizeof(payload));
+}
+
+void telemetryStreamEvent(uint32_t timestampUs, TelemetryEventKind kind, uint16_t value){
+  uint8_t payload[3];
+  payload[0] = kind;
+  put16(payload + 1, value);
+  streamPush(TELEMETRY_RECORD_EVENT, timestampUs, payload, sizeof(payload));
+}
+
+Print &telemetryStreamLogOutput(){
+  return logOutput;
+}
+
+void telemetryStreamGetStats(TelemetryStreamStats *out){
+  *out = stats;
+}
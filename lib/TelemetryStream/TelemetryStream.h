@@ -0,0 +1,55 @@
+#pragma once
+
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <Arduino.h>
+#include "TelemetryFrame.h"
+
+#define TELEMETRY_STREAM_QUEUE_SIZE 64      // ~100 ms of 100 Hz accel plus 500 Hz pulse
+#define TELEMETRY_STREAM_TX_BUFFER 256
+#define TELEMETRY_STREAM_TASK_STACK 3072
+#define TELEMETRY_STREAM_RECORD_PAYLOAD 6
+
+/*  Fixed size so the queue copies stay cheap, log lines bypass the queue  */
+typedef struct{
+  uint8_t type;
+  uint8_t length;
+  uint32_t timestampUs;
+  uint8_t payload[TELEMETRY_STREAM_RECORD_PAYLOAD];
+}StreamRecord;
+
+/*  The writer task's, queue's and UART mutex's memory, reserved by the caller (see lib/StaticRtos)  */
+typedef struct{
+  StackType_t stack[TELEMETRY_STREAM_TASK_STACK];
+  StaticTask_t tcb;
+  uint8_t recordStorage[TELEMETRY_STREAM_QUEUE_SIZE * sizeof(StreamRecord)];
+  StaticQueue_t records;
+  StaticSemaphore_t outputMutex;
+}TelemetryStreamStorage;
+
+typedef struct{
+  uint32_t records;     // frames written
+  uint32_t dropped;     // records that found the queue full
+  uint32_t bytes;
+}TelemetryStreamStats;
+
+/*  Creates the queue and the writer task, the stream starts disabled  */
+void telemetryStreamInit(Print &out, TelemetryStreamStorage *storage, UBaseType_t taskPriority, BaseType_t core);
+
+/*  While enabled every text writer has to go through telemetryStreamLogOutput(), anything else breaks framing  */
+void telemetryStreamEnable(bool enable);
+bool telemetryStreamActive();
+
+/*  Producers: never block, a full queue counts a drop. No-ops while the stream is disabled  */
+void telemetryStreamAccel(uint32_t timestampUs, int16_t ax, int16_t ay, int16_t az);
+void telemetryStreamPulse(uint32_t timestampUs, uint16_t adc);
+void telemetryStreamDht(uint32_t timestampUs, float temperature, float humidity);
+void telemetryStreamEvent(uint32_t timestampUs, TelemetryEventKind kind, uint16_t value);
+
+/*  Print that wraps every write into a TELEMETRY_RECORD_LOG frame, for the logger while streaming  */
+Print &telemetryStreamLogOutput();
+
+void telemetryStreamGetStats(TelemetryStreamStats *stats);
+
+#endif
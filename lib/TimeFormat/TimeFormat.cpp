@@ -0,0 +1,44 @@
+#include "TimeFormat.h"
+
+#include <string.h>
+
+/*  Appends text[from, to), clamped to the text like String::substring(), cut at the frame length  */
+static void appendPart(char *frame, const char *text, size_t from, size_t to){
+  size_t textLength = strlen(text);
+  if(to > textLength){
+    to = textLength;
+  }
+  size_t used = strlen(frame);
+  for(size_t i = from; i < to && used < TIME_FRAME_LENGTH - 1; i++){
+    frame[used++] = text[i];
+  }
+  frame[used] = '\0';
+}
+
+void timeFormatFrames(char frames[TIME_FRAME_COUNT][TIME_FRAME_LENGTH], const char *time, const char *date, bool shortTime){
+  for(uint8_t i = 0; i < TIME_FRAME_COUNT; i++){
+    frames[i][0] = '\0';
+  }
+
+  appendPart(frames[TIME_FRAME_TIME], time, 0, shortTime ? 5 : TIME_TEXT_LENGTH);
+
+  appendPart(frames[TIME_FRAME_NO_MINUTES], time, 0, 3);
+  appendPart(frames[TIME_FRAME_NO_MINUTES], "--", 0, 2);
+
+  appendPart(frames[TIME_FRAME_NO_HOURS], "--", 0, 2);
+  appendPart(frames[TIME_FRAME_NO_HOURS], time, 2, 5);
+
+  appendPart(frames[TIME_FRAME_DATE], date, 0, DATE_TEXT_LENGTH);
+
+  // "Sun, Jan 17 2021": day at 9, month at 5, year at 12
+  appendPart(frames[TIME_FRAME_NO_DAY], date, 0, 9);
+  appendPart(frames[TIME_FRAME_NO_DAY], "--", 0, 2);
+  appendPart(frames[TIME_FRAME_NO_DAY], date, 11, DATE_TEXT_LENGTH);
+
+  appendPart(frames[TIME_FRAME_NO_MONTH], date, 0, 5);
+  appendPart(frames[TIME_FRAME_NO_MONTH], "---", 0, 3);
+  appendPart(frames[TIME_FRAME_NO_MONTH], date, 8, DATE_TEXT_LENGTH);
+
+  appendPart(frames[TIME_FRAME_NO_YEAR], date, 0, 12);
+  appendPart(frames[TIME_FRAME_NO_YEAR], "----", 0, 4);
+}
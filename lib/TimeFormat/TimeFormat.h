@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef TIME_FORMAT_H
+#define TIME_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIME_TEXT_LENGTH 12         // "HH:MM:SS"
+#define DATE_TEXT_LENGTH 24         // ESP32Time getDate(false): "Sun, Jan 17 2021"
+#define TIME_FRAME_COUNT 7
+#define TIME_FRAME_LENGTH 24
+
+/*  Time and date as the RTC task publishes them, plain arrays so the struct can go through a queue  */
+typedef struct{
+  char date[DATE_TEXT_LENGTH];
+  char time[TIME_TEXT_LENGTH];
+  char amPm[4];
+}TimeText;
+
+/*  Index into the frames: the plain time and date, and each with one field blanked for the edit blink  */
+enum TimeFrame : uint8_t{
+  TIME_FRAME_TIME,            // "HH:MM", or the full time without shortTime
+  TIME_FRAME_NO_MINUTES,      // "HH:--"
+  TIME_FRAME_NO_HOURS,        // "--:MM"
+  TIME_FRAME_DATE,
+  TIME_FRAME_NO_DAY,
+  TIME_FRAME_NO_MONTH,
+  TIME_FRAME_NO_YEAR,
+};
+
+void timeFormatFrames(char frames[TIME_FRAME_COUNT][TIME_FRAME_LENGTH], const char *time, const char *date, bool shortTime);
+
+#endif
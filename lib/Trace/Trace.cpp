@@ -0,0 +1,82 @@
+#include "Trace.h"
+
+#ifdef TRACE_ENABLE
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <atomic>
+
+#define TRACE_RING_MASK (TRACE_RING_SIZE - 1)
+
+static_assert((TRACE_RING_SIZE & TRACE_RING_MASK) == 0, "TRACE_RING_SIZE must be a power of two");
+
+/*  One ring per core keeps the two cores off each other's cache lines. Tasks on the same core
+ *  can still preempt each other mid-record, so the slot is claimed with an atomic increment.
+ *  Oldest events are overwritten, the ring always holds the latest TRACE_RING_SIZE  */
+typedef struct{
+  std::atomic<uint32_t> head;
+  TraceEvent events[TRACE_RING_SIZE];
+}TraceRing;
+
+static TraceRing rings[TRACE_CORES];
+static std::atomic<bool> paused(false);
+
+void traceRecord(char phase, const char *name){
+  if(paused.load(std::memory_order_relaxed)){
+    return;
+  }
+  uint8_t core = xPortGetCoreID();
+  TraceRing *ring = &rings[core];
+  TraceEvent *event = &ring->events[ring->head.fetch_add(1, std::memory_order_relaxed) & TRACE_RING_MASK];
+  event->timestampUs = (uint32_t)esp_timer_get_time();
+  event->name = name;
+  event->task = xTaskGetCurrentTaskHandle();
+  event->phase = phase;
+  event->core = core;
+}
+
+/*  Task names come from the live task list, a handle alone could belong to a deleted task  */
+static void dumpTasks(Print &out){
+#if (configUSE_TRACE_FACILITY == 1)
+  static TaskStatus_t statuses[40];
+  UBaseType_t count = uxTaskGetSystemState(statuses, sizeof(statuses) / sizeof(statuses[0]), NULL);
+  char line[64];
+  for(UBaseType_t i = 0; i < count; i++){
+    int length = snprintf(line, sizeof(line), "T %p %s\n", statuses[i].xHandle, statuses[i].pcTaskName);
+    out.write((const uint8_t *)line, length);
+  }
+#endif
+}
+
+void traceDump(Print &out){
+  paused.store(true);
+  // a record that was preempted right before the pause finishes meanwhile
+  vTaskDelay(pdMS_TO_TICKS(2));
+
+  out.write((const uint8_t *)"-----BEGIN TRACE-----\n", 22);
+  dumpTasks(out);
+
+  char line[96];
+  for(uint8_t core = 0; core < TRACE_CORES; core++){
+    TraceRing *ring = &rings[core];
+    uint32_t head = ring->head.load();
+    uint32_t count = head < TRACE_RING_SIZE ? head : TRACE_RING_SIZE;
+    for(uint32_t position = head - count; position != head; position++){
+      const TraceEvent *event = &ring->events[position & TRACE_RING_MASK];
+      int length = snprintf(line, sizeof(line), "E %u %c %u %p %s\n",
+        (unsigned)event->timestampUs, event->phase, event->core, event->task, event->name);
+      out.write((const uint8_t *)line, length);
+    }
+    ring->head.store(0);
+  }
+
+  out.write((const uint8_t *)"-----END TRACE-----\n", 20);
+  paused.store(false);
+}
+
+#else
+
+void traceRecord(char phase, const char *name){}
+void traceDump(Print &out){}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/*  Flight recorder of begin / end / instant events, built only with -DTRACE_ENABLE.
+ *  Without it every TRACE_* macro is empty and nothing is allocated  */
+#define TRACE_RING_SIZE 1024      // events per core, must be a power of two: 16 KB each
+#define TRACE_CORES 2
+
+#define TRACE_PHASE_BEGIN   'B'
+#define TRACE_PHASE_END     'E'
+#define TRACE_PHASE_INSTANT 'i'
+
+#ifdef TRACE_ENABLE
+
+/*  `name` must be a string literal, only the pointer is stored  */
+#define TRACE_BEGIN(name)   traceRecord(TRACE_PHASE_BEGIN, (name))
+#define TRACE_END(name)     traceRecord(TRACE_PHASE_END, (name))
+#define TRACE_INSTANT(name) traceRecord(TRACE_PHASE_INSTANT, (name))
+/*  Begin here, end when the enclosing block is left  */
+#define TRACE_SCOPE(name)   TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_CONCAT_INNER(a, b) a##b
+
+#else
+
+#define TRACE_BEGIN(name)   do{}while(0)
+#define TRACE_END(name)     do{}while(0)
+#define TRACE_INSTANT(name) do{}while(0)
+#define TRACE_SCOPE(name)   do{}while(0)
+
+#endif
+
+typedef struct{
+  uint32_t timestampUs;   // esp_timer, low 32 bits
+  const char *name;
+  void *task;             // TaskHandle_t of the recording task
+  char phase;             // TRACE_PHASE_*
+  uint8_t core;
+}TraceEvent;
+
+class Print;
+
+void traceRecord(char phase, const char *name);
+
+/*  Pauses recording and writes the events of both rings, oldest first, between
+ *  -----BEGIN TRACE----- / -----END TRACE----- markers for tools/trace_to_chrome.py.
+ *  Each line goes out in one write, so log lines from other tasks can only land between lines  */
+void traceDump(Print &out);
+
+class TraceScope{
+public:
+  explicit TraceScope(const char *name) : name(name){
+    traceRecord(TRACE_PHASE_BEGIN, name);
+  }
+  ~TraceScope(){
+    traceRecord(TRACE_PHASE_END, name);
+  }
+private:
+  const char *name;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "WeatherParse.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *skipSpace(const char *text){
+  while(*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n'){
+    text++;
+  }
+  return text;
+}
+
+/*  Start of the value of "key", NULL when there is none. A match must be followed by ':',
+ *  so the same word inside a string value is skipped  */
+static const char *findValue(const char *json, const char *key){
+  size_t keyLength = strlen(key);
+  for(const char *match = strstr(json, key); match != NULL; match = strstr(match + 1, key)){
+    if(match == json || match[-1] != '"' || match[keyLength] != '"'){
+      continue;
+    }
+    const char *value = skipSpace(match + keyLength + 1);
+    if(*value == ':'){
+      return skipSpace(value + 1);
+    }
+  }
+  return NULL;
+}
+
+static bool parseNumber(const char *json, const char *key, float *out){
+  const char *value = findValue(json, key);
+  if(value == NULL){
+    return false;
+  }
+  char *end;
+  *out = strtof(value, &end);
+  return end != value;
+}
+
+// escapes other than \" \\ \/ become '?', the display font has no glyphs for them anyway
+static bool parseString(const char *json, const char *key, char *out, size_t capacity){
+  const char *value = findValue(json, key);
+  if(value == NULL || *value != '"'){
+    return false;
+  }
+  size_t length = 0;
+  for(value++; *value != '"'; value++){
+    char c = *value;
+    if(c == '\0'){
+      return false;
+    }
+    if(c == '\\'){
+      value++;
+      if(*value == '\0'){
+        return false;
+      }
+      c = (*value == '"' || *value == '\\' || *value == '/') ? *value : '?';
+      if(*value == 'u'){
+        for(uint8_t digit = 0; digit < 4 && value[1] != '\0'; digit++){
+          value++;
+        }
+      }
+    }
+    if(length < capacity - 1){
+      out[length++] = c;
+    }
+  }
+  out[length] = '\0';
+  return true;
+}
+
+bool weatherParse(const char *json, WeatherReport *report){
+  return parseString(json, "description", report->description, sizeof(report->description)) &&
+         parseNumber(json, "feels_like", &report->tempFeelLike) &&
+         parseNumber(json, "humidity", &report->humidity) &&
+         parseNumber(json, "speed", &report->windSpeed);
+}
+
+// RFC 3986 unreserved characters pass, every other byte (UTF-8 ones included) becomes %XX
+static bool appendEncoded(char *out, size_t outSize, size_t *length, const char *text){
+  static const char hex[] = "0123456789ABCDEF";
+  for(; *text != '\0'; text++){
+    uint8_t c = *text;
+    bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                      c == '-' || c == '.' || c == '_' || c == '~';
+    size_t needed = unreserved ? 1 : 3;
+    if(*length + needed >= outSize){
+      return false;
+    }
+    if(unreserved){
+      out[(*length)++] = c;
+    }else{
+      out[(*length)++] = '%';
+      out[(*length)++] = hex[c >> 4];
+      out[(*length)++] = hex[c & 0x0F];
+    }
+  }
+  out[*length] = '\0';
+  return true;
+}
+
+static bool appendText(char *out, size_t outSize, size_t *length, const char *text){
+  size_t textLength = strlen(text);
+  if(*length + textLength >= outSize){
+    return false;
+  }
+  memcpy(out + *length, text, textLength + 1);
+  *length += textLength;
+  return true;
+}
+
+bool weatherUrl(char *out, size_t outSize, const char *city, const char *country, const char *apiKey){
+  if(outSize == 0){
+    return false;
+  }
+  size_t length = 0;
+  bool fits = appendText(out, outSize, &length, "http://api.openweathermap.org/data/2.5/weather?q=") &&
+              appendEncoded(out, outSize, &length, city) &&
+              appendText(out, outSize, &length, ",") &&
+              appendEncoded(out, outSize, &length, country) &&
+              appendText(out, outSize, &length, "&APPID=") &&
+              appendEncoded(out, outSize, &length, apiKey);
+  if(!fits){
+    out[0] = '\0';
+  }
+  return fits;
+}
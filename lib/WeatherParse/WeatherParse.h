@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef WEATHER_PARSE_H
+#define WEATHER_PARSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define WEATHER_DESCRIPTION_LENGTH 32
+
+typedef struct{
+  char description[WEATHER_DESCRIPTION_LENGTH];   // "broken clouds", cut to fit
+  float tempFeelLike;                             // K, the request asks for no units
+  float humidity;                                 // %
+  float windSpeed;                                // m/s
+}WeatherReport;
+
+/*  Picks weather[0].description, main.feels_like, main.humidity and wind.speed out of an
+ *  OpenWeather current weather response. Each key appears once in it, so they are found by
+ *  name without building a tree. False when one of them is missing  */
+bool weatherParse(const char *json, WeatherReport *report);
+
+/*  Current weather request for a city, the city, country and key percent-encoded so that a
+ *  configured "New York" or "a&b" stays one query value. False, with out empty, when it doesn't fit  */
+bool weatherUrl(char *out, size_t outSize, const char *city, const char *country, const char *apiKey);
+
+#endif
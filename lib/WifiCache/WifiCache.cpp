@@ -0,0 +1,65 @@
+#include "WifiCache.h"
+
+#include <string.h>
+#include <WiFi.h>
+#include <Preferences.h>
+
+#define WIFI_CACHE_KEY "entry"
+
+static uint32_t ssidHash(const char *ssid){
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  while(*ssid){
+    hash ^= (uint8_t)*ssid++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool wifiCacheLoad(WifiCacheEntry *entry, const char *ssid){
+  Preferences prefs;
+  if(!prefs.begin(WIFI_CACHE_NAMESPACE, true)){
+    return false;
+  }
+  size_t length = prefs.getBytes(WIFI_CACHE_KEY, entry, sizeof(WifiCacheEntry));
+  prefs.end();
+
+  return length == sizeof(WifiCacheEntry)
+      && entry->version == WIFI_CACHE_VERSION
+      && entry->ssidHash == ssidHash(ssid)
+      && entry->channel != 0;
+}
+
+void wifiCacheCapture(WifiCacheEntry *entry, const char *ssid){
+  memset(entry, 0, sizeof(WifiCacheEntry));
+  entry->version = WIFI_CACHE_VERSION;
+  entry->channel = (uint8_t)WiFi.channel();
+  const uint8_t *bssid = WiFi.BSSID();
+  if(bssid != NULL){
+    memcpy(entry->bssid, bssid, sizeof(entry->bssid));
+  }
+  entry->ssidHash = ssidHash(ssid);
+}
+
+bool wifiCacheStore(const WifiCacheEntry *entry){
+  Preferences prefs;
+  if(!prefs.begin(WIFI_CACHE_NAMESPACE, false)){
+    return false;
+  }
+
+  // most reconnects find the same AP, skip the flash write then
+  WifiCacheEntry stored;
+  bool same = prefs.getBytes(WIFI_CACHE_KEY, &stored, sizeof(stored)) == sizeof(stored)
+           && memcmp(&stored, entry, sizeof(stored)) == 0;
+  bool written = !same && prefs.putBytes(WIFI_CACHE_KEY, entry, sizeof(WifiCacheEntry)) == sizeof(WifiCacheEntry);
+  prefs.end();
+  return written;
+}
+
+void wifiCacheClear(){
+  Preferences prefs;
+  if(prefs.begin(WIFI_CACHE_NAMESPACE, false)){
+    prefs.remove(WIFI_CACHE_KEY);
+    prefs.end();
+  }
+}
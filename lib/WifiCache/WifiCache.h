@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WIFI_CACHE_VERSION 2
+#define WIFI_CACHE_NAMESPACE "wificache"
+
+/*  What the last successful connection found, enough to rejoin without a scan. The address still
+ *  comes from DHCP: a stored lease can expire or be handed to another device while we're away  */
+typedef struct{
+  uint8_t version;
+  uint8_t channel;
+  uint8_t bssid[6];
+  uint32_t ssidHash;      // entry is ignored once the credentials change
+}WifiCacheEntry;
+
+/*  Reads the entry back from NVS, false if there is none or it belongs to another SSID  */
+bool wifiCacheLoad(WifiCacheEntry *entry, const char *ssid);
+
+/*  Fills the entry from the current station link, call only while connected  */
+void wifiCacheCapture(WifiCacheEntry *entry, const char *ssid);
+
+/*  Writes the entry unless NVS already holds the same bytes, returns true if flash was written  */
+bool wifiCacheStore(const WifiCacheEntry *entry);
+
+void wifiCacheClear();
+
+#endif
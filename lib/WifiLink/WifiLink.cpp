@@ -0,0 +1,71 @@
+#include "WifiLink.h"
+
+#include <string.h>
+
+void wifiLinkInit(WifiLink *link, const WifiLinkConfig *config){
+  memset(link, 0, sizeof(WifiLink));
+  link->config = config;
+  link->state = WIFI_LINK_IDLE;
+  link->backoffMs = config->backoffMinMs;
+}
+
+static void enterState(WifiLink *link, WifiLinkState state, uint32_t nowMs){
+  link->state = state;
+  link->stateSinceMs = nowMs;
+}
+
+static WifiLinkAction beginAttempt(WifiLink *link, uint32_t nowMs){
+  link->attempts++;
+  enterState(link, WIFI_LINK_CONNECTING, nowMs);
+  return WIFI_ACTION_BEGIN;
+}
+
+void wifiLinkSuspend(WifiLink *link, uint32_t nowMs){
+  link->backoffMs = link->config->backoffMinMs;
+  enterState(link, WIFI_LINK_IDLE, nowMs);
+}
+
+WifiLinkAction wifiLinkUpdate(WifiLink *link, bool linkUp, uint32_t nowMs){
+  const WifiLinkConfig *config = link->config;
+  uint32_t inState = nowMs - link->stateSinceMs;
+
+  switch(link->state){
+  case WIFI_LINK_IDLE:
+    return beginAttempt(link, nowMs);
+
+  case WIFI_LINK_CONNECTING:
+    if(linkUp){
+      link->connects++;
+      link->lastConnectMs = inState;
+      link->backoffMs = config->backoffMinMs;
+      enterState(link, WIFI_LINK_CONNECTED, nowMs);
+      return WIFI_ACTION_NONE;
+    }
+    if(inState >= config->connectTimeoutMs){
+      link->failures++;
+      enterState(link, WIFI_LINK_BACKOFF, nowMs);
+      return WIFI_ACTION_DISCONNECT;
+    }
+    return WIFI_ACTION_NONE;
+
+  case WIFI_LINK_CONNECTED:
+    if(!linkUp){
+      // dropped links retry after the shortest delay
+      link->backoffMs = config->backoffMinMs;
+      enterState(link, WIFI_LINK_BACKOFF, nowMs);
+      return WIFI_ACTION_DISCONNECT;
+    }
+    return WIFI_ACTION_NONE;
+
+  case WIFI_LINK_BACKOFF:
+    if(inState >= link->backoffMs){
+      uint32_t nextBackoff = link->backoffMs * 2;
+      link->backoffMs = (nextBackoff > config->backoffMaxMs) ? config->backoffMaxMs : nextBackoff;
+      return beginAttempt(link, nowMs);
+    }
+    return WIFI_ACTION_NONE;
+
+  default:
+    return WIFI_ACTION_NONE;
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum : uint8_t{
+  WIFI_LINK_IDLE,         // nothing tried yet
+  WIFI_LINK_CONNECTING,   // begin() issued, waiting for the link or the timeout
+  WIFI_LINK_CONNECTED,
+  WIFI_LINK_BACKOFF       // last attempt failed or the link dropped, waiting before the next one
+}WifiLinkState;
+
+typedef enum : uint8_t{
+  WIFI_ACTION_NONE,
+  WIFI_ACTION_BEGIN,      // start a connection attempt
+  WIFI_ACTION_DISCONNECT  // give up on the current attempt
+}WifiLinkAction;
+
+typedef struct{
+  uint32_t connectTimeoutMs;
+  uint32_t backoffMinMs;    // first retry delay, doubled after every failed attempt
+  uint32_t backoffMaxMs;
+}WifiLinkConfig;
+
+typedef struct{
+  const WifiLinkConfig *config;
+  WifiLinkState state;
+  uint32_t stateSinceMs;
+  uint32_t backoffMs;         // delay of the current / next backoff
+  uint32_t attempts;
+  uint32_t failures;
+  uint32_t connects;
+  uint32_t lastConnectMs;     // duration of the last successful attempt
+}WifiLink;
+
+void wifiLinkInit(WifiLink *link, const WifiLinkConfig *config);
+
+/*  The radio was switched off on purpose, the next update starts a fresh attempt without backoff  */
+void wifiLinkSuspend(WifiLink *link, uint32_t nowMs);
+
+/*  Call periodically with the current link status, returns what the caller should do with the radio  */
+WifiLinkAction wifiLinkUpdate(WifiLink *link, bool linkUp, uint32_t nowMs);
+
+#endif
@@ -10,4 +10,9 @@
 /*  OpenWeatherAPI credentials  */
 #define APIKey "ENTER_YOUR_OPENWEATHER_API_KEY"
 
+/*  MQTT broker, leave MQTT_BROKER_URI undefined to disable telemetry publishing  */
+#define MQTT_BROKER_URI "mqtt://ENTER_YOUR_BROKER_IP:1883"
+#define MQTT_USERNAME NULL
+#define MQTT_PASSWORD NULL
+
 #endif
\ No newline at end of file
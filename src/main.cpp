@@ -1,4 +1,6 @@
 #include <Arduino.h>
+#include <freertos/timers.h>
+#include <freertos/event_groups.h>
 /*  DHT11 Sensor required dependecies  */
 #include <Adafruit_Sensor.h>
 #include <DHT_U.h>
@@ -13,36 +15,109 @@
 #include <U8g2lib.h>
 /*  MPU6050 lib  */
 #include <MPU6050.h>
-/*  Parsing and getting JSON APIs  */
+/*  Getting the weather API  */
 #include <HTTPClient.h>
-#include <Arduino_JSON.h>
 /*  Handling credentials   */
 #include <credentials.h>
-
+/*  Dirty-tile tracking for partial OLED updates  */
+#include <FrameDiff.h>
+/*  Single owner of the shared Wire bus (OLED + MPU6050)  */
+#include <I2CBus.h>
+/*  24 h step graph buckets  */
+#include <StepHistory.h>
+/*  Lock-free ring the button ISRs push their events into  */
+#include <InputEvents.h>
+/*  Debouncing and press / long press / double press / auto repeat recognition  */
+#include <ButtonGestures.h>
+#include <esp_timer.h>
+/*  Background WiFi connection with timeouts and reconnect backoff  */
+#include <WifiLink.h>
+/*  Last channel and BSSID in NVS for scan-less reconnects  */
+#include <WifiCache.h>
+/*  Async web dashboard: gzipped page, /api/state JSON and an SSE stream  */
+#include <Telemetry.h>
+#include <Dashboard.h>
+/*  Batched QoS1 telemetry to an MQTT broker, buffered while offline  */
+#include <MqttTelemetry.h>
+/*  Coalesces weather, time sync and telemetry into shared radio-on windows  */
+#include <NetScheduler.h>
+#include <esp_sntp.h>
+/*  Leveled logging, formatted by a low priority drain task instead of the caller  */
+#include <Log.h>
+/*  Binary framed sensor records over the UART, toggled from the serial console  */
+#include <TelemetryStream.h>
+/*  Compressed sensor history on flash  */
+#include <SeriesRecorder.h>
+/*  Stacks, CPU load, heap and queue depths of the whole system  */
+#include <HealthMonitor.h>
+/*  Tasks and queues in link time reserved memory, declared as tables  */
+#include <StaticRtos.h>
+/*  Detector thresholds, task periods and the weather location, changeable at runtime and kept in NVS  */
+#include <ConfigStore.h>
+/*  Begin / end / instant events for tools/trace_to_chrome.py, compiled in with -DTRACE_ENABLE  */
+#include <Trace.h>
+/*  Heap allocations per call site and task, compiled in with the alloctrack environment  */
+#include <AllocTrack.h>
+/*  Clock, ADC, GPIO, I2C, display and HTTP behind interfaces, so the code below them also builds for [env:native]  */
+#include <HalEsp32.h>
+#include <HalU8g2.h>
+#include <AccelSensor.h>
+#include <StepDetector.h>
+#include <BeatDetector.h>
+#include <TimeFormat.h>
+#include <WeatherParse.h>
+#include <Screens.h>
+/*  The MPU, pulse sensor and DHT as template driver types, read without virtual calls  */
+#include <SensorPipelines.h>
+#include <DhtDriver.h>
 
 /*  Buttons Pins & debounce Time  */
 #define SCREEN_CHANGE_BUTTON 18
 #define TIME_EDIT_ENABLE_BUTTON 32
 #define TIME_INCREMENT_BUTTON 25
 #define TIME_DECREMENT_BUTTON 26
-#define DEBOUNCE_TIME 250
+#define DEBOUNCE_TIME 20          // ms the level has to be stable to count as an edge, default of button.debounce
+#define BUTTON_SAMPLE_PERIOD 5    // ms, esp_timer sampling period while any button is active
+
+typedef enum : uint8_t{
+  BUTTON_SCREEN_CHANGE,
+  BUTTON_TIME_EDIT_ENABLE,
+  BUTTON_TIME_INCREMENT,
+  BUTTON_TIME_DECREMENT,
+  BUTTON_COUNT
+}ButtonId;
+
+/*  DRAM_ATTR since the edge ISR reads it  */
+const uint8_t DRAM_ATTR buttonPins[BUTTON_COUNT] = {
+  SCREEN_CHANGE_BUTTON,
+  TIME_EDIT_ENABLE_BUTTON,
+  TIME_INCREMENT_BUTTON,
+  TIME_DECREMENT_BUTTON
+};
+
+/*  debounceMs follows the button.debounce setting  */
+GestureConfig buttonGestureConfigs[BUTTON_COUNT] = {
+  // debounce,    long, double, repeat delay, repeat, fast repeat, fast after
+  {DEBOUNCE_TIME, 1000, 0,      0,            0,      0,           0},    // SCREEN_CHANGE: long press resets the step counter
+  {DEBOUNCE_TIME, 1000, 0,      0,            0,      0,           0},    // TIME_EDIT_ENABLE: long press leaves edit mode
+  {DEBOUNCE_TIME, 0,    0,      400,          120,    40,          10},   // TIME_INCREMENT: hold to scroll
+  {DEBOUNCE_TIME, 0,    0,      400,          120,    40,          10}    // TIME_DECREMENT: hold to scroll
+};
 
-/* Buttons last Time Pressed */
-unsigned long lastScreenChangeTime = 0;
-unsigned long lastTimeEditEnablePressed = 0;
-unsigned long lastTimeIncremennt = 0;
-unsigned long lastTimeDecrement = 0;
-unsigned long lastStepCountReset = 0;
+ButtonGesture buttonGestures[BUTTON_COUNT];
+esp_timer_handle_t buttonSampleTimer_handle;
 
-/* MPU6050 super-params  */
-#define THRESHOLD 1.0 
-#define BUFFER_LENGTH 15 
-#define DEBOUNCE_DELAY 300 
+/*  inputTask wake-up reasons (task notification bits)  */
+#define INPUT_NOTIFY_EDGE   (1 << 0)    // an ISR saw an edge, make sure sampling runs
+#define INPUT_NOTIFY_EVENTS (1 << 1)    // the sampler pushed gestures
+#define INPUT_NOTIFY_IDLE   (1 << 2)    // every button is released and settled, sampling can stop
 
 #define DHTPIN 13
 #define DHTTYPE DHT11
 
 #define PULSE_PIN 33
+#define PULSE_SAMPLE_PERIOD 10    // ms, for the pulse screen, default of pulse.period
+#define PULSE_STREAM_PERIOD 2     // ms, 500 Hz raw samples while the binary stream is on
 
 DHT_Unified dht(DHTPIN, DHTTYPE);
 
@@ -55,15 +130,8 @@ MPU6050 mpu;
 #define ntpServer1 "pool.ntp.org"
 #define ntpServer2 "time.nist.gov" 
 
-String city = "Tanta"; 
-String countryCode = "EG";
-String openWeatherUrl = "http://api.openweathermap.org/data/2.5/weather?q=" + city + "," + countryCode + "&APPID=" + APIKey;
-
-typedef struct{
-  String date;
-  String time;
-  String AmPm;
-}timeStrings;
+#define WEATHER_CITY "Tanta"
+#define WEATHER_COUNTRY "EG"
 
 typedef struct{
   uint8_t minOffset;
@@ -93,26 +161,73 @@ typedef struct{
   float rh;         // stands for relative humidiy
 }DHT_sensor_data;
 
+/*  Screens in the order the screen change button cycles through them, one screenRegistry entry each  */
+enum ScreenId : uint8_t{
+  SCREEN_TIME,
+  SCREEN_ENV,
+  SCREEN_PULSE,
+  SCREEN_WEATHER,
+  SCREEN_STEPS,
+  SCREEN_HISTORY,
+  SCREEN_HEALTH,
+  SCREEN_COUNT
+};
+
 typedef struct{
-  String description;
-  float tempFeelLike;
-  float humidity;
-  float windSpeed;
-}openWeatherJSONParsed;
+  const char *name;
+  void (*onEnter)();                                          // screen became visible (optional)
+  void (*onExit)();                                           // screen got hidden (optional)
+  bool (*needsRedraw)(uint32_t events, uint32_t changedData); // DISPLAY_EVENT_* and SCREEN_DATA_* bits of this wake-up
+  void (*render)();                                           // draws into the U8g2 buffer, the caller flushes
+  uint16_t minFrameInterval;                                  // ms, refresh cap for data driven frames
+}ScreenDescriptor;
 
 typedef struct{
-  volatile uint8_t screenCurrentIndex;         //  the current screen number showed on the OLED (0-3)
+  volatile uint8_t screenCurrentIndex;         //  the current screen number showed on the OLED (ScreenId)
   volatile uint8_t currentBlinkingTimeField;   //  the current binking part of Time and date (0-5)
   volatile uint8_t timeChange;                 //  the new change added to the offsets
 }ScreenStatus;
 
-openWeatherJSONParsed weatherInfo;
-
 WiFiClient client;
 HTTPClient httpClient;
 
 U8G2_SH1106_128X64_NONAME_F_HW_I2C screen(U8G2_R0, U8X8_PIN_NONE, SCL, SDA);
 
+/*  The hardware as lib/Hal sees it, what the sensor and screen code below is written against  */
+Esp32Clock halClock;
+Esp32Adc halAdc;
+Esp32Gpio halGpio;
+Esp32I2c halI2c(Wire);
+U8g2Display halDisplay(screen.getU8g2());
+Esp32Http halHttp(httpClient);
+
+/*  The sensors as compile-time driver types on top of it, see lib/SensorDrivers  */
+typedef AnalogPulseDriver<Esp32Adc> PulseSensor;
+typedef StepPipeline<Mpu6050Driver<Esp32I2c>> StepSensor;
+Mpu6050Driver<Esp32I2c> mpuDriver(halI2c);
+PulseSensor pulseDriver(halAdc, PULSE_PIN);
+DhtDriver dhtDriver(dht);
+EnvCache<DhtDriver> envCache(dhtDriver);
+
+/*  Model of the panel contents, only tiles that differ from it get sent over I2C  */
+FrameDiff screenFrameDiff;
+
+/*  Clients of the I2C bus manager, the MPU reads jump ahead of queued display tiles  */
+I2CClient mpuI2CClient;
+I2CClient screenI2CClient;
+I2CClient *i2cClients[] = {&mpuI2CClient, &screenI2CClient};
+
+typedef struct{
+  StepSensor *steps;
+  bool valid;
+}MPURead;
+
+typedef struct{
+  uint8_t tileX;
+  uint8_t tileY;
+  uint8_t tileWidth;
+}ScreenArea;
+
 ScreenStatus screenStatusCfx = {
   .screenCurrentIndex = 0,
   .currentBlinkingTimeField = 0,
@@ -129,563 +244,1485 @@ timeOffsets timeOffsetsCfx = {
 };
 
 
-TaskHandle_t readDHT_handle;
-TaskHandle_t readPulseSensor_handle;
-TaskHandle_t readRTC_handle;
-TaskHandle_t openWeatherTask_handle;
-TaskHandle_t screenDisplay_handle;
-TaskHandle_t readMPU_handle;        
-TaskHandle_t stepDetection_handle;  
-TaskHandle_t displayUpdate_handle;
-
-QueueHandle_t screenRTCQueue_handle;
-
-QueueHandle_t screenDHTQueue_handle;
 #define SCREEN_DHT_QUEUE_SIZE 5
-
-QueueHandle_t screenPulseQueue_handle;
 #define SCREEN_PULSE_QUEUE_SIZE 10
-
-QueueHandle_t screenOpenWeather_handle;
 #define SCREEN_WEATHER_API_QUEUE_SIZE 1
+#define STEP_EVENT_QUEUE_SIZE 10
+/*  +1 / -1 steps for the selected time field, a queue so fast presses aren't merged  */
+#define TIME_EDIT_QUEUE_SIZE 8
+
+/*  Stack sizes measured by a stackprofile run (see stackProfileTask), pasted from its report into
+ *  include/AppStacks.h. Without that file, and in the profiling build itself, the defaults in the table  */
+#if defined(__has_include) && !defined(STACK_PROFILE_ENABLE)
+#if __has_include(<AppStacks.h>)
+#include <AppStacks.h>
+#endif
+#endif
+#ifdef APP_STACKS_TUNED
+#define APP_STACK(function, fallback) APP_STACK_##function
+#else
+#define APP_STACK(function, fallback) (fallback)
+#endif
+
+/*  Every task main.cpp starts, created in setup() from memory reserved at link time, see lib/StaticRtos.
+ *  Stack sizes are in bytes  */
+//  function         handle                   name                        stack                             prio core
+#define APP_TASKS(X) \
+  X(readDHT,         readDHT_handle,          "DHT SENSOR READING TASK",  APP_STACK(readDHT, 2000),         1, 1) \
+  X(readPulseSensor, readPulseSensor_handle,  "READ PULSE SENSOR TASK",   APP_STACK(readPulseSensor, 3000), 1, 1) \
+  X(readRTC,         readRTC_handle,          "READ INTERNAL RTC TASK",   APP_STACK(readRTC, 3000),         1, 1) \
+  X(openWeatherGet,  openWeatherTask_handle,  "OpenWeatherAPI Task",      APP_STACK(openWeatherGet, 4000),  1, 1) \
+  X(readMPU,         readMPU_handle,          "MPU6050 Reading Task",     APP_STACK(readMPU, 3000),         2, 1) \
+  X(stepDetection,   stepDetection_handle,    "Step Detection Task",      APP_STACK(stepDetection, 4000),   2, 1) \
+  X(screenDisplay,   screenDisplay_handle,    "OLED DISPLAY TASK",        APP_STACK(screenDisplay, 5000),   1, 1) \
+  X(wifiTask,        wifiTask_handle,         "WIFI CONNECTION TASK",     APP_STACK(wifiTask, 3000),        1, 1) \
+  X(inputTask,       inputTask_handle,        "INPUT EVENT TASK",         APP_STACK(inputTask, 2048),       2, 1)
+
+/*  Every queue, the name is what the health monitor reports it as  */
+//  handle                    name        length                         item size
+#define APP_QUEUES(X) \
+  X(screenRTCQueue_handle,    "rtc",      1,                             sizeof(TimeText)) \
+  X(screenDHTQueue_handle,    "dht",      SCREEN_DHT_QUEUE_SIZE,         sizeof(DHT_sensor_data)) \
+  X(screenPulseQueue_handle,  "pulse",    SCREEN_PULSE_QUEUE_SIZE,       sizeof(uint16_t)) \
+  X(screenOpenWeather_handle, "weather",  SCREEN_WEATHER_API_QUEUE_SIZE, sizeof(WeatherReport)) \
+  X(stepEventQueue_handle,    "stepEvt",  STEP_EVENT_QUEUE_SIZE,         sizeof(StepData)) \
+  X(stepDataQueue_handle,     "steps",    1,                             sizeof(StepData)) \
+  X(timeEditQueue_handle,     "timeEdit", TIME_EDIT_QUEUE_SIZE,          sizeof(int8_t))
+
+APP_TASKS(STATIC_TASK_STORAGE)
+APP_QUEUES(STATIC_QUEUE_STORAGE)
+
+/*  What the tasks, queues and mutexes the libraries start take, handed to their init/begin call  */
+static LogStorage logStorage;
+static TelemetryStreamStorage telemetryStreamStorage;
+static SeriesRecorderStorage seriesRecorderStorage;
+static I2CBusStorage i2cBusStorage;
+static DashboardStorage dashboardStorage;
+static HealthStorage healthStorage;
+#ifdef MQTT_BROKER_URI
+static MqttTelemetryStorage mqttTelemetryStorage;
+#define APP_MQTT_RTOS_BYTES sizeof(MqttTelemetryStorage)
+#else
+#define APP_MQTT_RTOS_BYTES 0
+#endif
 
-QueueHandle_t mpuDataQueue_handle;  
-QueueHandle_t stepDataQueue_handle; 
-QueueHandle_t displayQueue_handle; 
-
-SemaphoreHandle_t screenDisplaySemaphore_handle;
-SemaphoreHandle_t timeIncerementSemaphore_handle;
-SemaphoreHandle_t timeDecrementSemaphore_handle;
 SemaphoreHandle_t resetSemaphore_handle;
+static StaticSemaphore_t resetSemaphoreBuffer;
 
 volatile int globalStepCount = 0;
 
-void IRAM_ATTR screenChangeButtonISR(){
-  unsigned long currentTime = millis();
-  if(currentTime - lastScreenChangeTime > DEBOUNCE_TIME){
-    screenStatusCfx.screenCurrentIndex = (screenStatusCfx.screenCurrentIndex + 1)%5;
-    lastScreenChangeTime = currentTime;
+/*  WiFi is brought up in the background, nothing at boot waits for it  */
+#define WIFI_POLL_PERIOD 250            // ms
+const WifiLinkConfig wifiLinkConfig = {
+  .connectTimeoutMs = 15000,
+  .backoffMinMs = 1000,
+  .backoffMaxMs = 60000
+};
+WifiLink wifiLink;
+
+/*  A cached AP that has no link by then is given up for a full scan, a targeted join plus DHCP takes well under 1 s  */
+#define WIFI_FAST_CONNECT_TIMEOUT 3000  // ms
+WifiCacheEntry wifiCache;
+bool wifiCacheValid = false;
+bool wifiFastAttempt = false;           // current attempt targets the cached AP
+
+/*  Connect phases, stamped from the WiFi event task  */
+volatile uint32_t wifiBeginUs = 0;
+volatile uint32_t wifiAssocUs = 0;      // scan + auth + association done
+volatile uint32_t wifiGotIpUs = 0;      // DHCP lease up
+
+#ifdef MQTT_BROKER_URI
+#define MQTT_TOPIC "watch/telemetry"
+const MqttTelemetryConfig mqttTelemetryConfig = {
+  .brokerUri = MQTT_BROKER_URI,
+  .username = MQTT_USERNAME,
+  .password = MQTT_PASSWORD,
+  .topic = MQTT_TOPIC,
+  .samplePeriodS = 5,
+  .batchIntervalS = 60,
+  .maxInFlight = 2
+};
+#endif
+
+bool wifiConnected(){
+  return wifiLink.state == WIFI_LINK_CONNECTED;
+}
 
+/*  All network work shares windows on a 60 s grid, the radio is fully awake only inside them.
+ *  Between windows it sits in modem sleep, which keeps the association so the dashboard stays
+ *  reachable. Build with NET_IDLE_RADIO_OFF to switch it off instead and rejoin through the WiFi cache  */
+#define NET_CLIENT_WEATHER (1 << 0)
+#define NET_CLIENT_TIME    (1 << 1)
+#define NET_CLIENT_MQTT    (1 << 2)
+#define NET_CLIENTS_ALL    (NET_CLIENT_WEATHER | NET_CLIENT_TIME | NET_CLIENT_MQTT)
+
+const NetSchedulerConfig netSchedulerConfig = {
+  .windowPeriodMs = 60000,
+  .windowBudgetMs = 10000
+};
+#define MQTT_CONNECT_GRACE 3000   // ms MQTT may hold a window without a broker session
+NetScheduler netScheduler;
+portMUX_TYPE netSchedulerLock = portMUX_INITIALIZER_UNLOCKED;
+/*  One bit per client, set while its window is open and the link is up  */
+EventGroupHandle_t netWindowEvents_handle;
+static StaticEventGroup_t netWindowEventsBuffer;
+
+#define WEATHER_FETCH_PERIOD (10 * 60 * 1000UL)   // ms, default of weather.period
+#define WEATHER_RETRY_PERIOD 60000                // ms, i.e. the next window
+#define WEATHER_BODY_LENGTH 1024                  // B, longer responses are cut and fail to parse
+#define WEATHER_URL_LENGTH 224                    // B, fits weather.city percent-encoded throughout
+#define TIME_SYNC_PERIOD (60 * 60 * 1000UL)       // ms
+
+#define MPU_SAMPLE_PERIOD 10      // ms, default of mpu.period
+#define DHT_SAMPLE_PERIOD 1000    // ms, default of dht.period
+
+/*  The cached values behind appConfig. Tasks read them directly on every use, only the console
+ *  ('c') writes them, through lib/ConfigStore  */
+StepDetectorConfig stepConfig = STEP_DETECTOR_DEFAULTS;
+BeatDetectorConfig beatConfig = BEAT_DETECTOR_DEFAULTS;
+uint32_t buttonDebounceMs = DEBOUNCE_TIME;
+uint32_t mpuPeriodMs = MPU_SAMPLE_PERIOD;
+uint32_t dhtPeriodMs = DHT_SAMPLE_PERIOD;
+uint32_t pulsePeriodMs = PULSE_SAMPLE_PERIOD;
+uint32_t weatherPeriodS = WEATHER_FETCH_PERIOD / 1000;
+char weatherCity[32] = WEATHER_CITY;        // read under configLock()
+char weatherCountry[4] = WEATHER_COUNTRY;
+
+const ConfigEntry appConfig[] = {
+  // key,             type,          value,                      size,                   min,  max,                default,                      text
+  {"step.threshold",  CONFIG_FLOAT,  &stepConfig.threshold,      0,                      0.1,  8,                  STEP_THRESHOLD,               NULL,
+   "g above the moving average that counts as a step"},
+  {"step.debounce",   CONFIG_UINT32, &stepConfig.debounceMs,     0,                      100,  2000,               STEP_DEBOUNCE,                NULL,
+   "ms, shortest time between two steps"},
+  {"step.window",     CONFIG_UINT32, &stepConfig.windowLength,   0,                      1,    STEP_WINDOW_LENGTH, STEP_WINDOW_LENGTH,           NULL,
+   "samples in the moving average"},
+  {"beat.threshold",  CONFIG_UINT32, &beatConfig.threshold,      0,                      200,  4095,               BEAT_THRESHOLD,               NULL,
+   "ADC counts a pulse starts above"},
+  {"beat.refractory", CONFIG_UINT32, &beatConfig.refractoryMs,   0,                      250,  1500,               BEAT_REFRACTORY,              NULL,
+   "ms after a beat in which no new one is timed"},
+  {"button.debounce", CONFIG_UINT32, &buttonDebounceMs,          0,                      5,    200,                DEBOUNCE_TIME,                NULL,
+   "ms a button level has to be stable"},
+  {"mpu.period",      CONFIG_UINT32, &mpuPeriodMs,               0,                      5,    100,                MPU_SAMPLE_PERIOD,            NULL,
+   "ms between accelerometer samples"},
+  {"dht.period",      CONFIG_UINT32, &dhtPeriodMs,               0,                      1000, 600000,             DHT_SAMPLE_PERIOD,            NULL,
+   "ms between temperature / humidity reads"},
+  {"pulse.period",    CONFIG_UINT32, &pulsePeriodMs,             0,                      2,    100,                PULSE_SAMPLE_PERIOD,          NULL,
+   "ms between pulse samples on the pulse screen"},
+  {"weather.period",  CONFIG_UINT32, &weatherPeriodS,            0,                      60,   86400,              WEATHER_FETCH_PERIOD / 1000,  NULL,
+   "s between weather fetches"},
+  {"weather.city",    CONFIG_STRING, weatherCity,                sizeof(weatherCity),    0,    0,                  0,                            WEATHER_CITY,
+   "OpenWeather city name"},
+  {"weather.country", CONFIG_STRING, weatherCountry,             sizeof(weatherCountry), 0,    0,                  0,                            WEATHER_COUNTRY,
+   "ISO 3166 country code"},
+};
+#define APP_CONFIG_COUNT (sizeof(appConfig) / sizeof(appConfig[0]))
+
+static void netSchedule(uint32_t clients){
+  portENTER_CRITICAL(&netSchedulerLock);
+  netSchedulerRequest(&netScheduler, clients);
+  portEXIT_CRITICAL(&netSchedulerLock);
+}
+
+/*  Blocks until the client's window is open and the link is up, call netWindowDone() once its work is over  */
+bool netWindowWait(uint32_t client, TickType_t timeout){
+  netSchedule(client);
+  if(wifiTask_handle != NULL){
+    xTaskNotifyGive(wifiTask_handle);
   }
+  return (xEventGroupWaitBits(netWindowEvents_handle, client, pdFALSE, pdTRUE, timeout) & client) != 0;
 }
 
-void IRAM_ATTR screenTimeDateEditEnableButtonISR(){
-  unsigned long currentTime = millis();
-  if(currentTime - lastTimeEditEnablePressed > DEBOUNCE_TIME){
-    lastTimeEditEnablePressed = currentTime;
-    screenStatusCfx.currentBlinkingTimeField = (screenStatusCfx.currentBlinkingTimeField+1)%6;
+void netWindowDone(uint32_t client){
+  portENTER_CRITICAL(&netSchedulerLock);
+  netSchedulerDone(&netScheduler, client);
+  portEXIT_CRITICAL(&netSchedulerLock);
+  xEventGroupClearBits(netWindowEvents_handle, client);
+}
+
+/*  History kept on flash (LittleFS), see lib/SeriesStore. Timestamps are epoch seconds,
+ *  so nothing is recorded until SNTP or the user has set the clock  */
+typedef enum : uint8_t{
+  SERIES_STEPS,
+  SERIES_BPM,
+  SERIES_TEMPERATURE,
+  SERIES_HUMIDITY,
+  SERIES_COUNT
+}SeriesId;
+
+const SeriesConfig seriesConfigs[SERIES_COUNT] = {
+  {"steps", SERIES_INT},      // SERIES_STEPS: running count, once a minute while it changes
+  {"bpm",   SERIES_INT},      // SERIES_BPM: averaged BPM, at most every SERIES_BPM_PERIOD
+  {"temp",  SERIES_FLOAT},    // SERIES_TEMPERATURE: °C
+  {"rh",    SERIES_FLOAT}     // SERIES_HUMIDITY: %RH
+};
+
+#define SERIES_STEPS_PERIOD 60        // s
+#define SERIES_BPM_PERIOD 5           // s
+#define SERIES_ENV_PERIOD 60          // s
+#define SERIES_VALID_TIME 1700000000  // anything earlier is an unset clock
 
+/*  Current epoch second, false while the clock is not set  */
+bool seriesNow(uint32_t *now){
+  time_t seconds = time(NULL);
+  if(seconds < SERIES_VALID_TIME){
+    return false;
   }
+  *now = (uint32_t)seconds;
+  return true;
 }
 
+void seriesAppendInt(uint8_t series, uint32_t timestamp, int32_t value){
+  SeriesValue sample;
+  sample.i = value;
+  seriesRecorderAppend(series, timestamp, sample);
+}
 
-void IRAM_ATTR screenTimeIncrementButtonISR(){
-  unsigned long currentTime = millis();
-  if(currentTime - lastTimeIncremennt > DEBOUNCE_TIME){
-    
-    lastTimeIncremennt = currentTime;
-    BaseType_t higherPriorityTaskAwaken = pdFALSE;
-    xSemaphoreGiveFromISR(timeIncerementSemaphore_handle, &higherPriorityTaskAwaken);
+void seriesAppendFloat(uint8_t series, uint32_t timestamp, float value){
+  SeriesValue sample;
+  sample.f = value;
+  seriesRecorderAppend(series, timestamp, sample);
+}
+
+#define HEALTH_PERIOD 2000    // ms between system samples
+
+/*  Boot milestones, ms since reset  */
+uint32_t bootFirstFrameTime = 0;
+uint32_t bootFirstClockTime = 0;
 
-    portYIELD_FROM_ISR(higherPriorityTaskAwaken);
+/*  Pulse sampling only runs while its screen is visible (see pulseScreenEnter/Exit)  */
+volatile bool pulseScreenVisible = false;
+
+/*  Display task wake-up reasons (task notification bits)  */
+#define DISPLAY_EVENT_DATA  (1 << 0)    // a producer published a new value
+#define DISPLAY_EVENT_INPUT (1 << 1)    // a button changed the UI state
+#define DISPLAY_EVENT_BLINK (1 << 2)    // time edit field blink phase flipped
+#define DISPLAY_EVENT_DUMP  (1 << 3)    // render unconditionally and dump the frame as PBM
+#define DISPLAY_MIN_FRAME_INTERVAL 50   // ms, bursts of events are coalesced into one frame (20 fps max)
+#define BLINK_PERIOD 400                // ms
+
+TimerHandle_t blinkTimer_handle;
+static StaticTimer_t blinkTimerBuffer;
+
+typedef struct{
+  uint32_t lastUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t samples;
+}LatencyStats;
+
+/*  micros() of the oldest button press that has not reached the panel yet, 0 if none  */
+volatile uint32_t pendingInputTime = 0;
+LatencyStats inputLatency = {0, 0, 0, 0};
+
+void displayNotify(uint32_t events){
+  if(screenDisplay_handle != NULL){
+    xTaskNotify(screenDisplay_handle, events, eSetBits);
   }
-  
 }
 
+/*  Runs in the monitor task, the health screen redraws with every sample  */
+void healthSampled(){
+  if(screenStatusCfx.screenCurrentIndex == SCREEN_HEALTH){
+    displayNotify(DISPLAY_EVENT_DATA);
+  }
+}
 
-void IRAM_ATTR screenTimeDecremntButtonISR(){
-  unsigned long currentTime = millis();
-  if(currentTime - lastTimeDecrement > DEBOUNCE_TIME){
-    
-    lastTimeDecrement = currentTime;
-    BaseType_t higherPriorityTaskAwaken = pdFALSE;
-    xSemaphoreGiveFromISR(timeDecrementSemaphore_handle, &higherPriorityTaskAwaken);
+void blinkTimerCallback(TimerHandle_t timer){
+  // only the time edit mode blinks, any other screen stays idle
+  if(screenStatusCfx.screenCurrentIndex == SCREEN_TIME && screenStatusCfx.currentBlinkingTimeField != 0){
+    displayNotify(DISPLAY_EVENT_BLINK);
+  }
+}
 
+InputEventRing inputEventRing;
 
-    portYIELD_FROM_ISR(higherPriorityTaskAwaken);
+typedef struct{
+  uint32_t edges;       // raw edges seen by the ISR
+  uint32_t gestures;    // gestures the recognizer emitted
+}InputStats;
+
+InputStats inputStats = {0, 0};
+
+// one ISR for every button, it only timestamps the edge and gets the sampler going
+void IRAM_ATTR inputButtonISR(void *arg){
+  uint8_t button = (uint8_t)(uintptr_t)arg;
+  uint8_t type = (digitalRead(buttonPins[button]) == LOW) ? INPUT_EDGE_PRESS : INPUT_EDGE_RELEASE;
+  InputEvent event = {(uint32_t)micros(), button, type, GESTURE_NONE};
+  inputEventPush(&inputEventRing, &event);
+
+  BaseType_t higherPriorityTaskAwaken = pdFALSE;
+  if(inputTask_handle != NULL){
+    xTaskNotifyFromISR(inputTask_handle, INPUT_NOTIFY_EDGE, eSetBits, &higherPriorityTaskAwaken);
   }
-  
+  portYIELD_FROM_ISR(higherPriorityTaskAwaken);
 }
 
-void IRAM_ATTR resetStepCountsISR(){
-  unsigned long currentTime = millis();
-  if(currentTime - lastStepCountReset > DEBOUNCE_TIME){
-    lastStepCountReset = currentTime;
-    BaseType_t higherPriorityTaskAwaken = pdFALSE;
-    xSemaphoreGiveFromISR(resetSemaphore_handle, &higherPriorityTaskAwaken);
-    portYIELD_FROM_ISR(higherPriorityTaskAwaken);
+// esp_timer callback, runs every BUTTON_SAMPLE_PERIOD while inputTask keeps the timer going
+void buttonSampleCallback(void *arg){
+  uint32_t nowMs = millis();
+  uint32_t notification = 0;
+  bool allIdle = true;
+
+  for(uint8_t button = 0; button < BUTTON_COUNT; button++){
+    GestureType gesture = buttonGestureUpdate(&buttonGestures[button], !halGpio.read(buttonPins[button]), nowMs);
+    if(gesture != GESTURE_NONE){
+      InputEvent event = {(uint32_t)micros(), button, INPUT_GESTURE, gesture};
+      inputEventPush(&inputEventRing, &event);
+      notification |= INPUT_NOTIFY_EVENTS;
+    }
+    allIdle = allIdle && buttonGestureIdle(&buttonGestures[button]);
+  }
+
+  if(allIdle){
+    notification |= INPUT_NOTIFY_IDLE;
+  }
+  if(notification != 0 && inputTask_handle != NULL){
+    xTaskNotify(inputTask_handle, notification, eSetBits);
   }
 }
 
+void timeEditRequest(int8_t delta){
+  xQueueSend(timeEditQueue_handle, &delta, 0);
+  // wakes readRTC right away so time edits don't wait for its 1 s period
+  if(readRTC_handle != NULL){
+    xTaskNotifyGive(readRTC_handle);
+  }
+}
 
+void markInput(uint32_t timestampUs){
+  if(pendingInputTime == 0){
+    pendingInputTime = timestampUs;
+  }
+}
+
+void handleButtonGesture(uint8_t button, uint8_t gesture, uint32_t timestampUs){
+  switch(button){
+  case BUTTON_SCREEN_CHANGE:
+    if(gesture == GESTURE_PRESS){
+      markInput(timestampUs);
+      screenStatusCfx.screenCurrentIndex = (screenStatusCfx.screenCurrentIndex + 1)%SCREEN_COUNT;
+      displayNotify(DISPLAY_EVENT_INPUT);
+    }else if(gesture == GESTURE_LONG_PRESS &&
+             (screenStatusCfx.screenCurrentIndex == SCREEN_STEPS || screenStatusCfx.screenCurrentIndex == SCREEN_HISTORY)){
+      markInput(timestampUs);
+      xSemaphoreGive(resetSemaphore_handle);
+    }
+    break;
+  case BUTTON_TIME_EDIT_ENABLE:
+    if(gesture == GESTURE_PRESS){
+      markInput(timestampUs);
+      screenStatusCfx.currentBlinkingTimeField = (screenStatusCfx.currentBlinkingTimeField+1)%6;
+      displayNotify(DISPLAY_EVENT_INPUT);
+    }else if(gesture == GESTURE_LONG_PRESS){
+      markInput(timestampUs);
+      screenStatusCfx.currentBlinkingTimeField = 0;
+      displayNotify(DISPLAY_EVENT_INPUT);
+    }
+    break;
+  case BUTTON_TIME_INCREMENT:
+    if(gesture == GESTURE_PRESS || gesture == GESTURE_REPEAT){
+      markInput(timestampUs);
+      timeEditRequest(1);
+    }
+    break;
+  case BUTTON_TIME_DECREMENT:
+    if(gesture == GESTURE_PRESS || gesture == GESTURE_REPEAT){
+      markInput(timestampUs);
+      timeEditRequest(-1);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/*  Only writer of screenStatusCfx, so readers never see half-applied presses  */
+void inputTask(void *parameters){
+  uint32_t firstEdgeTime[BUTTON_COUNT] = {0};   // latency is measured from the first raw edge of a gesture
+  bool sampling = false;
+  InputEvent event;
+
+  for(;;){
+    uint32_t notification = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &notification, portMAX_DELAY);
+
+    // sample only while something is happening, the buttons cost nothing at rest
+    if((notification & INPUT_NOTIFY_EDGE) && !sampling){
+      esp_timer_start_periodic(buttonSampleTimer_handle, BUTTON_SAMPLE_PERIOD * 1000);
+      sampling = true;
+    }else if((notification & INPUT_NOTIFY_IDLE) && !(notification & INPUT_NOTIFY_EDGE) && sampling){
+      esp_timer_stop(buttonSampleTimer_handle);
+      sampling = false;
+    }
+
+    while(inputEventPop(&inputEventRing, &event)){
+      if(event.button >= BUTTON_COUNT){
+        continue;
+      }
+      if(event.type != INPUT_GESTURE){
+        inputStats.edges++;
+        if(firstEdgeTime[event.button] == 0){
+          firstEdgeTime[event.button] = event.timestampUs;
+        }
+        continue;
+      }
 
+      inputStats.gestures++;
+      telemetryStreamEvent(event.timestampUs, TELEMETRY_EVENT_GESTURE, (uint16_t)(event.button << 8 | event.gesture));
+      handleButtonGesture(event.button, event.gesture, firstEdgeTime[event.button] ? firstEdgeTime[event.button] : event.timestampUs);
+      firstEdgeTime[event.button] = 0;
+    }
+  }
+}
+
+void mpuReadTransaction(void *context){
+  MPURead *read = (MPURead *)context;
+  read->valid = read->steps->read();
+}
+
+/*  Wake-to-wake period of readMPU, i.e. how much blocking work (logging, mostly) delays sampling  */
+typedef struct{
+  uint32_t lastWakeUs;
+  uint32_t samples;
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+}SampleJitter;
+
+SampleJitter mpuJitter = {0, 0, UINT32_MAX, 0, 0};
+volatile bool mpuJitterReset = false;   // set by the stats report, readMPU starts a new window
+
+void sampleJitterAdd(SampleJitter *jitter, uint32_t nowUs){
+  if(jitter->lastWakeUs != 0){
+    uint32_t period = nowUs - jitter->lastWakeUs;
+    jitter->samples++;
+    jitter->totalUs += period;
+    if(period < jitter->minUs){
+      jitter->minUs = period;
+    }
+    if(period > jitter->maxUs){
+      jitter->maxUs = period;
+    }
+  }
+  jitter->lastWakeUs = nowUs;
+}
+
+/*  Reads the MPU and runs the step detector on every sample, hands the steps to stepDetection  */
 void readMPU(void* parameters) {
-  float accelerationData[3];
+  StepSensor steps(mpuDriver, &stepConfig);
+  MPURead read = {&steps, false};
+  bool lastReadValid = true;
   
   for(;;) {
+    if(mpuJitterReset){
+      mpuJitter = {mpuJitter.lastWakeUs, 0, UINT32_MAX, 0, 0};
+      mpuJitterReset = false;
+    }
+    uint32_t wakeUs = micros();
+    sampleJitterAdd(&mpuJitter, wakeUs);
+    TRACE_INSTANT("mpu.wake");
+
     // read data from MPU6050
-    int16_t ax, ay, az;
-    mpu.getAcceleration(&ax, &ay, &az);
-    
-    // convert to g (±16g range)
-    accelerationData[0] = ax / 2048.0;
-    accelerationData[1] = ay / 2048.0;
-    accelerationData[2] = az / 2048.0;
-    
-    // send data to queue
-    xQueueSend(mpuDataQueue_handle, &accelerationData, portMAX_DELAY);
-    
-    Serial.print("Free MPU Stack: ");
-    Serial.println(uxTaskGetStackHighWaterMark(readMPU_handle));
+    TRACE_BEGIN("mpu.read");
+    i2cBusRun(&mpuI2CClient, mpuReadTransaction, &read);
+    TRACE_END("mpu.read");
+
+    if(read.valid){
+      telemetryStreamAccel(wakeUs, steps.raw[0], steps.raw[1], steps.raw[2]);
+
+      TRACE_BEGIN("steps.detect");
+      bool step = steps.detect(halClock.millis()) == STEP_SAMPLE_STEP;
+      TRACE_END("steps.detect");
+
+      if(step){
+        StepData stepData = {0, steps.detector.averageMagnitude, steps.detector.aboveThreshold};
+        TRACE_BEGIN("mpu.send");
+        xQueueSend(stepEventQueue_handle, &stepData, portMAX_DELAY);
+        TRACE_END("mpu.send");
+      }
+    }else if(lastReadValid){
+      LOG_W("MPU", "read failed");     // once per outage, not at 100 Hz
+    }
+    lastReadValid = read.valid;
     
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    vTaskDelay(pdMS_TO_TICKS(mpuPeriodMs));
   }
 }
 
+/*  Counts the steps readMPU detects, takes the reset and records the count  */
 void stepDetection(void* parameters) {
-  float buffer[BUFFER_LENGTH] = {0};
-  int bufferIndex = 0;
-  float accelerationData[3];
-  unsigned long lastStepTime = 0;
   StepData stepData = {0, 0, false};
+  uint32_t lastSeriesMinute = 0;
+  int lastSeriesSteps = 0;
   
   for(;;) {
-    // read acceleration data
-    if(xQueueReceive(mpuDataQueue_handle, &accelerationData, pdMS_TO_TICKS(50))) {
-      
-      // calculate magnitude
-      float accelerationMagnitude = sqrt(
-        accelerationData[0] * accelerationData[0] +
-        accelerationData[1] * accelerationData[1] +
-        accelerationData[2] * accelerationData[2]
-      );
-      
-      // add to buffer
-      buffer[bufferIndex] = accelerationMagnitude;
-      bufferIndex = (bufferIndex + 1) % BUFFER_LENGTH;
-      
-      // calculate average
-      float avgMagnitude = 0;
-      for (int i = 0; i < BUFFER_LENGTH; i++) {
-        avgMagnitude += buffer[i];
-      }
-      avgMagnitude /= BUFFER_LENGTH;
-      
-      stepData.avgMagnitude = avgMagnitude;
-      
-      unsigned long currentMillis = millis();
-      
-      // detect step
-      if (accelerationMagnitude > (avgMagnitude + THRESHOLD)) {
-        if (!stepData.stepDetected && (currentMillis - lastStepTime) > DEBOUNCE_DELAY) {
-          globalStepCount++;
-          stepData.stepCount = globalStepCount;
-          stepData.stepDetected = true;
-          lastStepTime = currentMillis;
-          
-          Serial.print("Step detected! Total: ");
-          Serial.println(globalStepCount);
-          
-          // send update to screen
-          xQueueOverwrite(stepDataQueue_handle, &stepData);
-        }
-      } else {
-        stepData.stepDetected = false;
-      }
-      
-      // detect reset command
-      if(xSemaphoreTake(resetSemaphore_handle, 0)) {
-        globalStepCount = 0;
-        stepData.stepCount = 0;
-        Serial.println("Step counter reset!");
-        xQueueOverwrite(stepDataQueue_handle, &stepData);
-      }
+    if(xQueueReceive(stepEventQueue_handle, &stepData, pdMS_TO_TICKS(50))) {
+      globalStepCount++;
+      stepData.stepCount = globalStepCount;
+
+      LOG_D("Steps", "step detected, total %d", globalStepCount);
+      telemetryStreamEvent(micros(), TELEMETRY_EVENT_STEP, (uint16_t)globalStepCount);
+
+      // send update to screen
+      xQueueOverwrite(stepDataQueue_handle, &stepData);
+      displayNotify(DISPLAY_EVENT_DATA);
     }
     
-    Serial.print("Free StepDetection Stack: ");
-    Serial.println(uxTaskGetStackHighWaterMark(stepDetection_handle));
+    // detect reset command
+    if(xSemaphoreTake(resetSemaphore_handle, 0)) {
+      globalStepCount = 0;
+      stepData.stepCount = 0;
+      LOG_I("Steps", "step counter reset");
+      xQueueOverwrite(stepDataQueue_handle, &stepData);
+      displayNotify(DISPLAY_EVENT_DATA);
+    }
     
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    // minute aligned, so a steady walk costs one bit per timestamp
+    uint32_t now;
+    if(seriesNow(&now) && now / SERIES_STEPS_PERIOD != lastSeriesMinute && globalStepCount != lastSeriesSteps){
+      lastSeriesMinute = now / SERIES_STEPS_PERIOD;
+      lastSeriesSteps = globalStepCount;
+      seriesAppendInt(SERIES_STEPS, lastSeriesMinute * SERIES_STEPS_PERIOD, lastSeriesSteps);
+    }
   }
 }
 
 void readDHT(void* parameters){
   DHT_sensor_data TempRHvalues;
+  uint32_t lastSeriesTime = 0;
 
   for(;;){
-    vTaskDelay(1000 / portTICK_RATE_MS);
+    vTaskDelay(pdMS_TO_TICKS(dhtPeriodMs));
 
-    sensors_event_t event;
-    dht.temperature().getEvent(&event);
+    TRACE_BEGIN("dht.read");
+    uint8_t fresh = envCache.update();
+    TRACE_END("dht.read");
+    bool valid = fresh == (ENV_FRESH_TEMPERATURE | ENV_FRESH_HUMIDITY);
 
-    if(isnan(event.temperature)){
-      Serial.println("DHT11 FAILED TO READ TEMP");
+    // a failed value keeps the last good one
+    if(fresh & ENV_FRESH_TEMPERATURE){
+      LOG_D("DHT", "temperature %.1f °C", envCache.temperature);
     }else{
-      Serial.print("DHT11 Temp = ");
-      Serial.print(event.temperature);
-      Serial.println("°C");
-
-      TempRHvalues.temp = event.temperature;
+      LOG_W("DHT", "failed to read temperature");
     }
-
-    dht.humidity().getEvent(&event);
-
-    if(isnan(event.relative_humidity)){
-      Serial.println("DHT11 FAILED TO READ RELATIVE HUMIDITY"); 
+    if(fresh & ENV_FRESH_HUMIDITY){
+      LOG_D("DHT", "relative humidity %.0f %%", envCache.humidity);
     }else{
-      Serial.print("DHT11 REL_HUMIDITY = ");
-      Serial.print(event.relative_humidity);
-      Serial.println("%");  
+      LOG_W("DHT", "failed to read relative humidity");
+    }
+    TempRHvalues.temp = envCache.temperature;
+    TempRHvalues.rh = envCache.humidity;
 
-      TempRHvalues.rh = event.relative_humidity;
+    if(valid){
+      telemetryStreamDht(micros(), TempRHvalues.temp, TempRHvalues.rh);
+
+      uint32_t now;
+      if(seriesNow(&now) && now - lastSeriesTime >= SERIES_ENV_PERIOD){
+        lastSeriesTime = now;
+        seriesAppendFloat(SERIES_TEMPERATURE, now, TempRHvalues.temp);
+        seriesAppendFloat(SERIES_HUMIDITY, now, TempRHvalues.rh);
+      }
     }
 
+    TRACE_BEGIN("dht.send");
     xQueueSend(screenDHTQueue_handle, &TempRHvalues, portMAX_DELAY);
-
-    Serial.print("Free Stack DHT: ");
-    Serial.println(uxTaskGetStackHighWaterMark(readDHT_handle));
+    TRACE_END("dht.send");
+    displayNotify(DISPLAY_EVENT_DATA);
   }
 }
 
 void readPulseSensor(void *parameters){
-  uint32_t lastPeakTime = 0;
-  uint16_t threshold = 2450;
-  uint32_t timeDelay = 450;
+  BeatPipeline<PulseSensor> pulse(pulseDriver, &beatConfig);
   static uint32_t lastPrintTime = 0;
-  bool pulseOcurred = false;
-
-  uint8_t READING_NUM = 10;
-  uint8_t CURRENT_INDEX = 0;
-  uint16_t lastPulses[READING_NUM] = {0};
-
-  uint16_t signal;
-  uint16_t BPM = 0;
-  uint16_t tempBPM;
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t lastSeriesTime = 0;
 
   for(;;){
-        // condetion to make sensor read at his screen
-    if(screenStatusCfx.screenCurrentIndex != 2){
-      vTaskDelay(pdMS_TO_TICKS(200));
+    // read only for the pulse screen or the binary stream, pulseScreenEnter() and the 'b' command wake us up
+    if(!pulseScreenVisible && !telemetryStreamActive()){
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      lastWake = xTaskGetTickCount();
       continue;
     }
-  
-    signal = analogRead(PULSE_PIN);  // read sensor signal
-    Serial.print("[Pulse] Raw Signal = ");
-    Serial.println(signal);
-    Serial.print("[Pulse] BPM = ");
-    Serial.println(BPM);
-       // soft delay to read from serial_monitor
-    if(millis() - lastPrintTime > 500){   
-      Serial.print("[Pulse] Raw = ");
-      Serial.print(signal);
-      Serial.print(" | BPM = ");
-      Serial.println(BPM);
-      lastPrintTime = millis();
-}
-        
-    if(signal > threshold && !pulseOcurred){
-      uint32_t currentTime = millis();
-
-      if(currentTime - lastPeakTime > timeDelay){
-        tempBPM = 60000 / (currentTime - lastPeakTime);
 
-        if(tempBPM > 40 && tempBPM < 120){
-          lastPulses[CURRENT_INDEX] = tempBPM;
-          CURRENT_INDEX = (CURRENT_INDEX + 1) % READING_NUM;
-        }
-
-        lastPeakTime = currentTime;
-        pulseOcurred = true;
-      }
+    bool beat = pulse.sample(halClock.millis());
+    telemetryStreamPulse(micros(), pulse.signal);
+    LOG_V("Pulse", "raw %u | BPM %u", pulse.signal, pulse.detector.bpm);
+    // soft delay to read from serial_monitor
+    if(millis() - lastPrintTime > 500){
+      LOG_D("Pulse", "raw %u | BPM %u", pulse.signal, pulse.detector.bpm);
+      lastPrintTime = millis();
+    }
 
-      uint16_t sumBPM = 0;
-      uint8_t validReading = 0;
+    if(beat){
+      uint16_t BPM = pulse.detector.bpm;
+      telemetryStreamEvent(micros(), TELEMETRY_EVENT_BPM, BPM);
 
-      for(int i = 0; i < READING_NUM; i++){
-        if(lastPulses[i] > 0){
-          sumBPM += lastPulses[i];
-          validReading++;
-        }
+      uint32_t now;
+      if(BPM > 0 && seriesNow(&now) && now - lastSeriesTime >= SERIES_BPM_PERIOD){
+        lastSeriesTime = now;
+        seriesAppendInt(SERIES_BPM, now, BPM);
       }
 
-      if(validReading > 0){
-        BPM = sumBPM / validReading;
+      if(pulseScreenVisible){
+        TRACE_BEGIN("pulse.send");
+        xQueueSend(screenPulseQueue_handle, &BPM, portMAX_DELAY);
+        TRACE_END("pulse.send");
+        displayNotify(DISPLAY_EVENT_DATA);
       }
-      if(screenStatusCfx.screenCurrentIndex != 2){
-        Serial.println("[Pulse] Waiting for BPM screen...");
-        vTaskDelay(pdMS_TO_TICKS(500));
-        continue;
-      }
-
-
-      xQueueSend(screenPulseQueue_handle, &BPM, portMAX_DELAY);
-    }
-
-    if(signal < (threshold - 100) && pulseOcurred){
-      pulseOcurred = false;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(10));
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(telemetryStreamActive() ? PULSE_STREAM_PERIOD : pulsePeriodMs));
   }
 }
 
 void readRTC(void *parameters){
   tm timeInfo;
-  timeStrings strTime;
+  TimeText strTime;
 
   for(;;){
-    if(getLocalTime(&timeInfo)){
+    // don't sit in getLocalTime()'s 5 s retry loop while SNTP hasn't synced yet
+    if(getLocalTime(&timeInfo, 10)){
 
-      if(xSemaphoreTake(timeIncerementSemaphore_handle, pdMS_TO_TICKS(0))){
+      int8_t delta;
+      bool edited = false;
+      while(xQueueReceive(timeEditQueue_handle, &delta, 0) == pdTRUE){
         switch (screenStatusCfx.currentBlinkingTimeField)
         {
         case 0:
           break;
         case 1:
-          timeInfo.tm_min += 1;
+          timeInfo.tm_min += delta;
           break;
         case 2:
-          timeInfo.tm_hour += 1;
+          timeInfo.tm_hour += delta;
           break;
         case 3:
-          timeInfo.tm_mday += 1;
-          timeInfo.tm_wday += 1;
-          timeInfo.tm_yday += 1;
+          timeInfo.tm_mday += delta;
+          timeInfo.tm_wday += delta;
+          timeInfo.tm_yday += delta;
           break;
         case 4:
-          timeInfo.tm_mon += 1;
+          timeInfo.tm_mon += delta;
           break;
         case 5:
-          timeInfo.tm_year += 1;
+          timeInfo.tm_year += delta;
           break;
         default:
           break;
         }
-        rtc.setTimeStruct(timeInfo);
+        edited = true;
       }
-
-      if(xSemaphoreTake(timeDecrementSemaphore_handle, pdMS_TO_TICKS(0))){
-        switch (screenStatusCfx.currentBlinkingTimeField)
-        {
-        case 0:
-          break;
-        case 1:
-          timeInfo.tm_min -= 1;
-          break;
-        case 2:
-          timeInfo.tm_hour -= 1;
-          break;
-        case 3:
-          timeInfo.tm_mday -= 1;
-          timeInfo.tm_wday -= 1;
-          timeInfo.tm_yday -= 1;
-          break;
-        case 4:
-          timeInfo.tm_mon -= 1;
-          break;
-        case 5:
-          timeInfo.tm_year -= 1;
-          break;
-        default:
-          break;
-        }
+      if(edited){
         rtc.setTimeStruct(timeInfo);
       }
 
-      strTime.date = rtc.getDate(false);
-      strTime.time = rtc.getTime();
-      strTime.AmPm = rtc.getAmPm(true);
+      ALLOC_SITE("rtc.strings");
+      strlcpy(strTime.date, rtc.getDate(false).c_str(), sizeof(strTime.date));
+      strlcpy(strTime.time, rtc.getTime().c_str(), sizeof(strTime.time));
+      strlcpy(strTime.amPm, rtc.getAmPm(true).c_str(), sizeof(strTime.amPm));
 
       xQueueOverwrite(screenRTCQueue_handle, &strTime);
+      displayNotify(DISPLAY_EVENT_DATA);
 
     }else{
-      Serial.println("FAILED TO READTIME");
+      LOG_W("RTC", "failed to read time (not synced yet)");
     }
 
-    Serial.print("Free RTC Stack: ");
-    Serial.println(uxTaskGetStackHighWaterMark(readRTC_handle));
-
-    vTaskDelay(1000/portTICK_PERIOD_MS);
-
-  }
-}
+    // 1 Hz tick, or earlier when an increment/decrement button wakes us
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
 
-void createTimeDateFrames(String arr[], String time, String date, int size = 7, bool mode=true){
-  if(mode){
-    arr[0] = time.substring(0,5);
-  }else{
-    arr[0] = time;
   }
-  arr[1] = time.substring(0,3) + "--";
-  arr[2] = "--" + time.substring(2,5);
-  arr[3] = date; 
-  arr[4] = date.substring(0,9) + "--" + date.substring(11,date.length());
-  arr[5] = date.substring(0,5) + "---" + date.substring(8,date.length());
-  arr[6] = date.substring(0,12) + "----";
 }
 
 void openWeatherGet(void* parameters){
-  openWeatherJSONParsed weatherInfoBuffer;
-  String tempJSON;
-  JSONVar tempJSONVar;
-  String weatherDescriptionBuffer;
-  float numBuffer;
+  WeatherReport weatherInfoBuffer;
+  // a current weather response is ~500 B, static keeps it off the task stack
+  static char body[WEATHER_BODY_LENGTH];
+  char url[WEATHER_URL_LENGTH];
+  size_t bodyLength;
 
   for(;;){
-    httpClient.begin(openWeatherUrl);
-    int httpCode = httpClient.GET();
+    // shares the next network window with the time sync and the telemetry
+    TRACE_BEGIN("weather.window");
+    netWindowWait(NET_CLIENT_WEATHER, portMAX_DELAY);
+    TRACE_END("weather.window");
+
+    // rebuilt every time, weather.city and weather.country may have changed since
+    configLock();
+    bool urlFits = weatherUrl(url, sizeof(url), weatherCity, weatherCountry, APIKey);
+    configUnlock();
+    if(!urlFits){
+      // nothing to send, a new city notifies us before the retry period is over
+      LOG_E("Weather", "request URL longer than %u B", (unsigned)sizeof(url));
+      netWindowDone(NET_CLIENT_WEATHER);
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WEATHER_RETRY_PERIOD));
+      continue;
+    }
+
+    bool fetched = false;
+    ALLOC_SITE("weather");
+    TRACE_BEGIN("weather.http");
+    int httpCode = halHttp.get(url, body, sizeof(body), &bodyLength);
+    TRACE_END("weather.http");
     if(httpCode>0){
-      Serial.println("---- HOLA! CONNECTED HTTP ----");
-      tempJSON = httpClient.getString();
-      tempJSONVar = JSON.parse(tempJSON);
-      
-      weatherInfoBuffer.description = tempJSONVar.stringify(tempJSONVar["weather"][0]["description"]);
-      weatherInfoBuffer.tempFeelLike = atof(tempJSONVar.stringify(tempJSONVar["main"]["feels_like"]).c_str());
-      weatherInfoBuffer.humidity = atof(tempJSONVar.stringify(tempJSONVar["main"]["humidity"]).c_str());
-      weatherInfoBuffer.windSpeed = atof(tempJSONVar.stringify(tempJSONVar["wind"]["speed"]).c_str());
-
-      xQueueSend(screenOpenWeather_handle, &weatherInfoBuffer, portMAX_DELAY);
-
-      Serial.print("Description = ");
-      Serial.println(weatherInfoBuffer.description.substring(1,weatherInfoBuffer.description.length()-1));
-      Serial.print("API TEMP = ");
-      Serial.println(weatherInfoBuffer.tempFeelLike);
-      Serial.print("API RH = ");
-      Serial.println(weatherInfoBuffer.humidity);
-      Serial.print("Wind Speed = ");
-      Serial.println(weatherInfoBuffer.windSpeed);
-
-      httpClient.end();
-      vTaskDelay(5000/portTICK_PERIOD_MS);
+      LOG_D("Weather", "HTTP %d, %u B", httpCode, (unsigned)bodyLength);
+      TRACE_BEGIN("weather.parse");
+      bool parsed = weatherParse(body, &weatherInfoBuffer);
+      TRACE_END("weather.parse");
+
+      if(parsed){
+        xQueueSend(screenOpenWeather_handle, &weatherInfoBuffer, portMAX_DELAY);
+        displayNotify(DISPLAY_EVENT_DATA);
+        fetched = true;
+
+        LOG_I("Weather", "%s, feels like %.1f °C, %.0f %%RH, wind %.1f m/s",
+          weatherInfoBuffer.description, weatherInfoBuffer.tempFeelLike, weatherInfoBuffer.humidity,
+          weatherInfoBuffer.windSpeed);
+      }else{
+        LOG_W("Weather", "unexpected response (HTTP %d, %u B)", httpCode, (unsigned)bodyLength);
+      }
 
     }else{
-      Serial.println("HELL NAH");
+      LOG_W("Weather", "fetch failed (%d)", httpCode);
+    }
+    netWindowDone(NET_CLIENT_WEATHER);
+
+    // a notification fetches right away, a new location and the stack profile workload use it
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(fetched ? weatherPeriodS * 1000 : WEATHER_RETRY_PERIOD));
+  }
+}
+
+void screenAreaTransaction(void *context){
+  ScreenArea *area = (ScreenArea *)context;
+  screen.updateDisplayArea(area->tileX, area->tileY, area->tileWidth, 1);
+}
+
+// every tile run is its own bus transaction, so an MPU read waits at most one page (~3.5 ms at 400 kHz)
+void screenAreaSend(uint8_t tileX, uint8_t tileY, uint8_t tileWidth, void *context){
+  ScreenArea area = {tileX, tileY, tileWidth};
+  i2cBusRun(&screenI2CClient, screenAreaTransaction, &area);
+}
+
+// replaces screen.sendBuffer(): diffs the U8g2 buffer against the shadow and pushes only the changed tiles
+uint32_t screenFlush(){
+  FrameArea areas[FRAME_MAX_AREAS];
+
+  uint32_t diffStart = micros();
+  uint8_t areaCount = frameDiffCompute(&screenFrameDiff, screen.getBufferPtr(), areas);
+  screenFrameDiff.stats.diffUsLastFrame = micros() - diffStart;
+  screenFrameDiff.stats.diffUsTotal += screenFrameDiff.stats.diffUsLastFrame;
+
+  uint32_t bytesSent = frameDiffCommit(&screenFrameDiff, screen.getBufferPtr(), areas, areaCount, screenAreaSend, NULL);
+
+#ifdef FRAME_DIFF_VERIFY
+  if(!frameDiffVerify(&screenFrameDiff, screen.getBufferPtr())){
+    LOG_E("Display", "panel model differs from full redraw!");
+  }
+#endif
+
+  return bytesSent;
+}
+
+/*  Latest value of every producer, owned by the display task  */
+typedef struct{
+  TimeText time;
+  DHT_sensor_data env;
+  uint16_t bpm;
+  WeatherReport weather;
+  StepData steps;
+  bool blinkingState;
+  bool timeValid;             // SNTP synced and readRTC published at least once
+  bool weatherValid;          // at least one weather fetch succeeded
+  WifiLinkState linkState;
+  char ip[16];
+}DisplayModel;
+
+/*  Which part of the display model changed since the last frame  */
+#define SCREEN_DATA_TIME    (1 << 0)
+#define SCREEN_DATA_ENV     (1 << 1)
+#define SCREEN_DATA_PULSE   (1 << 2)
+#define SCREEN_DATA_WEATHER (1 << 3)
+#define SCREEN_DATA_STEPS   (1 << 4)
+#define SCREEN_DATA_HISTORY (1 << 5)
+#define SCREEN_DATA_NETWORK (1 << 6)
+#define SCREEN_DATA_HEALTH  (1 << 7)
+
+/*  Copy of the monitor's latest sample for the health screen, display task only  */
+HealthSnapshot displayHealth;
+
+DisplayModel displayModel = {
+  .time = {},
+  .env = {0, 0},
+  .bpm = 0,
+  .weather = {},
+  .steps = {0, 0, false},
+  .blinkingState = false,
+  .timeValid = false,
+  .weatherValid = false,
+  .linkState = WIFI_LINK_IDLE,
+  .ip = {}
+};
+
+const char *linkStateText(){
+  return (displayModel.linkState == WIFI_LINK_CONNECTED) ? "No data yet" : "Waiting for WiFi...";
+}
+
+/*  Steps per hour over the last day, fed from the step count the display task receives  */
+StepHistory stepHistory;
+
+uint32_t uptimeMinutes(){
+  return millis() / 60000;
+}
+
+void timeScreenRender(){
+  if(!displayModel.timeValid){
+    screenDrawNoDataYet(halDisplay, "--:--", (displayModel.linkState == WIFI_LINK_CONNECTED) ? "Syncing time..." : "Waiting for WiFi...");
+    return;
+  }
+  screenRenderTime(halDisplay, &displayModel.time, screenStatusCfx.currentBlinkingTimeField, displayModel.blinkingState);
+}
+
+bool timeScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return (events & (DISPLAY_EVENT_INPUT | DISPLAY_EVENT_BLINK)) || (changedData & (SCREEN_DATA_TIME | SCREEN_DATA_NETWORK));
+}
+
+void envScreenRender(){
+  screenRenderEnv(halDisplay, displayModel.env.temp, displayModel.env.rh);
+}
+
+bool envScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return changedData & SCREEN_DATA_ENV;
+}
+
+void pulseScreenEnter(){
+  pulseScreenVisible = true;
+  if(readPulseSensor_handle != NULL){
+    xTaskNotifyGive(readPulseSensor_handle);
+  }
+}
+
+void pulseScreenExit(){
+  pulseScreenVisible = false;
+}
+
+void pulseScreenRender(){
+  screenRenderPulse(halDisplay, displayModel.bpm);
+}
+
+bool pulseScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return changedData & SCREEN_DATA_PULSE;
+}
+
+void weatherScreenRender(){
+  if(!displayModel.weatherValid){
+    screenDrawNoDataYet(halDisplay, "Weather", linkStateText());
+    return;
+  }
+  screenRenderWeather(halDisplay, &displayModel.weather);
+}
+
+bool weatherScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return changedData & (SCREEN_DATA_WEATHER | SCREEN_DATA_NETWORK);
+}
+
+void stepsScreenRender(){
+  screenRenderSteps(halDisplay, displayModel.steps.stepCount,
+                    displayModel.linkState == WIFI_LINK_CONNECTED ? displayModel.ip : "offline");
+}
+
+bool stepsScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return changedData & (SCREEN_DATA_STEPS | SCREEN_DATA_NETWORK);
+}
+
+void historyScreenRender(){
+  screenRenderHistory(halDisplay, &stepHistory);
+}
+
+bool historyScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return changedData & SCREEN_DATA_HISTORY;
+}
+
+void healthScreenRender(){
+  screenRenderHealth(halDisplay, &displayHealth);
+}
+
+bool healthScreenNeedsRedraw(uint32_t events, uint32_t changedData){
+  return changedData & SCREEN_DATA_HEALTH;
+}
+
+typedef struct{
+  uint32_t frames;
+  uint32_t lastUs;
+  uint32_t maxUs;
+  uint64_t totalUs;
+}ScreenRenderStats;
+
+/*  Cost of each screen's render() into the U8g2 buffer, I2C time excluded  */
+ScreenRenderStats screenRenderStats[SCREEN_COUNT];
+
+/*  Writes the U8g2 buffer as an ASCII PBM (P1) between markers, so a serial log can be cut into golden images  */
+void screenDumpPBM(Print &out, const char *screenName){
+  const uint8_t *buffer = halDisplay.buffer();
+
+  out.printf("-----BEGIN PBM %s-----\n", screenName);
+  out.printf("P1\n%u %u\n", FRAME_TILE_WIDTH * 8, FRAME_TILE_HEIGHT * 8);
+  for(uint8_t y = 0; y < FRAME_TILE_HEIGHT * 8; y++){
+    char row[FRAME_TILE_WIDTH * 8 + 1];
+    for(uint8_t x = 0; x < FRAME_TILE_WIDTH * 8; x++){
+      row[x] = frameGetPixel(buffer, x, y) ? '1' : '0';
     }
+    row[FRAME_TILE_WIDTH * 8] = '\0';
+    out.println(row);
+  }
+  out.printf("-----END PBM %s-----\n", screenName);
+}
+
+/*  One entry per ScreenId, in the order the screen change button cycles through them.
+    const, so it is placed in flash (.rodata)  */
+const ScreenDescriptor screenRegistry[] = {
+  {"Time",    NULL,             NULL,            timeScreenNeedsRedraw,    timeScreenRender,    50},     // SCREEN_TIME
+  {"Env",     NULL,             NULL,            envScreenNeedsRedraw,     envScreenRender,     1000},   // SCREEN_ENV
+  {"Pulse",   pulseScreenEnter, pulseScreenExit, pulseScreenNeedsRedraw,   pulseScreenRender,   250},    // SCREEN_PULSE
+  {"Weather", NULL,             NULL,            weatherScreenNeedsRedraw, weatherScreenRender, 1000},   // SCREEN_WEATHER
+  {"Steps",   NULL,             NULL,            stepsScreenNeedsRedraw,   stepsScreenRender,   200},    // SCREEN_STEPS
+  {"History", NULL,             NULL,            historyScreenNeedsRedraw, historyScreenRender, 1000},   // SCREEN_HISTORY
+  {"Health",  NULL,             NULL,            healthScreenNeedsRedraw,  healthScreenRender,  1000},   // SCREEN_HEALTH
+};
+static_assert(sizeof(screenRegistry) / sizeof(screenRegistry[0]) == SCREEN_COUNT, "screenRegistry must have one entry per ScreenId");
 
-    Serial.print("Free openWeatherAPI Stack: ");
-    Serial.println(uxTaskGetStackHighWaterMark(openWeatherTask_handle));
+/*  Latest producer values in the shape the network side publishes, only touched by screenDisplay  */
+TelemetrySnapshot telemetry = {};
 
-    vTaskDelay(5000/portTICK_PERIOD_MS);
+void publishTelemetry(uint32_t changedData){
+  if(changedData & SCREEN_DATA_STEPS){
+    telemetry.steps = displayModel.steps.stepCount;
+    telemetry.valid |= TELEMETRY_VALID_STEPS;
+  }
+  if(changedData & SCREEN_DATA_PULSE){
+    telemetry.bpm = displayModel.bpm;
+    telemetry.valid |= TELEMETRY_VALID_PULSE;
+  }
+  if(changedData & SCREEN_DATA_ENV){
+    telemetry.temperature = displayModel.env.temp;
+    telemetry.humidity = displayModel.env.rh;
+    telemetry.valid |= TELEMETRY_VALID_ENV;
   }
+  if(changedData & SCREEN_DATA_WEATHER){
+    telemetry.weatherFeelsLike = displayModel.weather.tempFeelLike;
+    telemetry.weatherHumidity = displayModel.weather.humidity;
+    telemetry.windSpeed = displayModel.weather.windSpeed;
+    strlcpy(telemetry.weatherDescription, displayModel.weather.description, sizeof(telemetry.weatherDescription));
+    telemetry.valid |= TELEMETRY_VALID_WEATHER;
+  }
+  telemetry.sequence++;
+  telemetry.uptimeS = millis() / 1000;
+
+  dashboardPublish(&telemetry);
+#ifdef MQTT_BROKER_URI
+  mqttTelemetryPublish(&telemetry);
+#endif
 }
 
 void screenDisplay(void *parameters){
-  uint8_t currentScreenIndex = 0;
-  timeStrings tmInfoBuffer;
-  DHT_sensor_data TempRHvaluesBuffer;
-  uint16_t pulseReadingBuffer;
-  openWeatherJSONParsed weatherInfoBuffer;
-  String timeDateFrames[7];
-
-  bool currentBlinkingState = false;
-  StepData stepData = {0, 0, false};
+  uint8_t activeScreen = SCREEN_COUNT;    // nothing entered yet
+  TickType_t lastFrameTick = 0;
 
- 
+  stepHistoryInit(&stepHistory, uptimeMinutes());
 
   for(;;){
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+    TRACE_INSTANT("display.wake");
+
+    // rate cap: hold the frame back and fold in whatever else arrives meanwhile.
+    // Input keeps the global cap, data updates are limited by the screen's own rate. The wait ends
+    // early on input, a press must not sit behind a slow screen's interval.
+    // Before the screen switch below, so a press that changes screens during the wait is seen
+    for(;;){
+      uint16_t frameInterval = (events & DISPLAY_EVENT_INPUT) || activeScreen >= SCREEN_COUNT ?
+                               DISPLAY_MIN_FRAME_INTERVAL : screenRegistry[activeScreen].minFrameInterval;
+      TickType_t sinceLastFrame = xTaskGetTickCount() - lastFrameTick;
+      if(sinceLastFrame >= pdMS_TO_TICKS(frameInterval)){
+        break;
+      }
+      uint32_t lateEvents = 0;
+      xTaskNotifyWait(0, UINT32_MAX, &lateEvents, pdMS_TO_TICKS(frameInterval) - sinceLastFrame);
+      events |= lateEvents;
+    }
+
+    bool screenChanged = false;
+    uint8_t requestedScreen = screenStatusCfx.screenCurrentIndex;
+    if(requestedScreen != activeScreen){
+      if(activeScreen < SCREEN_COUNT && screenRegistry[activeScreen].onExit != NULL){
+        screenRegistry[activeScreen].onExit();
+      }
+      activeScreen = requestedScreen;
+      if(screenRegistry[activeScreen].onEnter != NULL){
+        screenRegistry[activeScreen].onEnter();
+      }
+      screenChanged = true;
+    }
+    const ScreenDescriptor *activeDescriptor = &screenRegistry[activeScreen];
+
+    // keep the latest value of every producer, so switching screens shows fresh data immediately
+    TRACE_BEGIN("display.receive");
+    uint32_t changedData = 0;
+    if(xQueueReceive(screenRTCQueue_handle, &displayModel.time, 0) == pdTRUE){
+      displayModel.timeValid = true;
+      changedData |= SCREEN_DATA_TIME;
+    }
+    while(xQueueReceive(screenDHTQueue_handle, &displayModel.env, 0) == pdTRUE){
+      changedData |= SCREEN_DATA_ENV;
+    }
+    while(xQueueReceive(screenPulseQueue_handle, &displayModel.bpm, 0) == pdTRUE){
+      changedData |= SCREEN_DATA_PULSE;
+    }
+    if(xQueueReceive(screenOpenWeather_handle, &displayModel.weather, 0) == pdTRUE){
+      displayModel.weatherValid = true;
+      changedData |= SCREEN_DATA_WEATHER;
+    }
+    if(wifiLink.state != displayModel.linkState){
+      displayModel.linkState = wifiLink.state;
+      ALLOC_SITE("display.ip");
+      strlcpy(displayModel.ip, WiFi.localIP().toString().c_str(), sizeof(displayModel.ip));
+      changedData |= SCREEN_DATA_NETWORK;
+    }
+    int previousStepCount = displayModel.steps.stepCount;
+    if(xQueueReceive(stepDataQueue_handle, &displayModel.steps, 0) == pdTRUE){
+      changedData |= SCREEN_DATA_STEPS;
+
+      // a reset drops the count, everything after it is new steps
+      int newSteps = displayModel.steps.stepCount - previousStepCount;
+      if(newSteps < 0){
+        newSteps = displayModel.steps.stepCount;
+      }
+      if(newSteps > 0){
+        stepHistoryAddSteps(&stepHistory, uptimeMinutes(), newSteps);
+        changedData |= SCREEN_DATA_HISTORY;
+      }
+    }
+    if(stepHistoryAdvance(&stepHistory, uptimeMinutes())){
+      changedData |= SCREEN_DATA_HISTORY;
+    }
+    // only the health screen uses it, no need to copy the whole snapshot otherwise
+    if(activeScreen == SCREEN_HEALTH && healthSequence() != displayHealth.sequence){
+      healthGetSnapshot(&displayHealth);
+      changedData |= SCREEN_DATA_HEALTH;
+    }
+    TRACE_END("display.receive");
 
-    vTaskDelay(pdMS_TO_TICKS(400));
+    if(changedData & (SCREEN_DATA_STEPS | SCREEN_DATA_PULSE | SCREEN_DATA_ENV | SCREEN_DATA_WEATHER)){
+      publishTelemetry(changedData);
+    }
 
-    if(screenStatusCfx.screenCurrentIndex == 0){
-      xQueueReceive(screenRTCQueue_handle, &tmInfoBuffer, pdMS_TO_TICKS(10));
-      createTimeDateFrames(timeDateFrames, tmInfoBuffer.time, tmInfoBuffer.date);
-      currentBlinkingState = !currentBlinkingState;
+    if(events & DISPLAY_EVENT_BLINK){
+      displayModel.blinkingState = !displayModel.blinkingState;
+    }else if(screenStatusCfx.currentBlinkingTimeField == 0){
+      displayModel.blinkingState = false;
+    }
 
-      if((screenStatusCfx.currentBlinkingTimeField==1 || screenStatusCfx.currentBlinkingTimeField==2) && currentBlinkingState==true){
-        screen.clearBuffer();
-        screen.setFont(u8g2_font_helvB12_te);
-        screen.drawStr(40,25, timeDateFrames[screenStatusCfx.currentBlinkingTimeField].c_str());
-    
-        screen.setFont(u8g2_font_helvR08_te);
-        screen.drawStr(20,50, timeDateFrames[3].c_str());
-        screen.sendBuffer();
-      }else if (screenStatusCfx.currentBlinkingTimeField>=3 && currentBlinkingState==true){
-        screen.clearBuffer();
-        screen.setFont(u8g2_font_helvB12_te);
-        screen.drawStr(40,25, timeDateFrames[0].c_str());
-        screen.setFont(u8g2_font_helvR08_te);
-        screen.drawStr(20,50, timeDateFrames[screenStatusCfx.currentBlinkingTimeField+1].c_str());
-        screen.sendBuffer();
-      }else{
-        screen.clearBuffer();
-        screen.setFont(u8g2_font_helvB12_te);
-        screen.drawStr(40,25, timeDateFrames[0].c_str());
-        screen.setFont(u8g2_font_helvR08_te);
-        screen.drawStr(20,50, timeDateFrames[3].c_str());
-        screen.sendBuffer();
+    if(!screenChanged && !(events & DISPLAY_EVENT_DUMP) && !activeDescriptor->needsRedraw(events, changedData)){
+      // the press didn't change this screen, don't let it count against the next frame
+      if(events & DISPLAY_EVENT_INPUT){
+        pendingInputTime = 0;
+      }
+      continue;
+    }
+
+    ScreenRenderStats *renderStats = &screenRenderStats[activeScreen];
+    uint32_t renderStart = micros();
+    TRACE_BEGIN("display.render");
+    activeDescriptor->render();
+    TRACE_END("display.render");
+    renderStats->lastUs = micros() - renderStart;
+    renderStats->totalUs += renderStats->lastUs;
+    renderStats->frames++;
+    if(renderStats->lastUs > renderStats->maxUs){
+      renderStats->maxUs = renderStats->lastUs;
+    }
+
+    if(events & DISPLAY_EVENT_DUMP){
+      screenDumpPBM(Serial, activeDescriptor->name);
+    }
+
+    TRACE_BEGIN("display.flush");
+    screenFlush();
+    TRACE_END("display.flush");
+
+    lastFrameTick = xTaskGetTickCount();
+
+    if(bootFirstFrameTime == 0){
+      bootFirstFrameTime = millis();
+      LOG_I("Boot", "first frame after %u ms", (unsigned)bootFirstFrameTime);
+    }
+    if(bootFirstClockTime == 0 && activeScreen == SCREEN_TIME && displayModel.timeValid){
+      bootFirstClockTime = millis();
+      LOG_I("Boot", "first clock frame after %u ms", (unsigned)bootFirstClockTime);
+    }
+
+    // input to pixels: from the ISR timestamp until the flush above returned
+    uint32_t inputTime = pendingInputTime;
+    if(inputTime != 0){
+      pendingInputTime = 0;
+      inputLatency.lastUs = micros() - inputTime;
+      inputLatency.totalUs += inputLatency.lastUs;
+      inputLatency.samples++;
+      if(inputLatency.lastUs > inputLatency.maxUs){
+        inputLatency.maxUs = inputLatency.lastUs;
       }
 
-    
-    }else if(screenStatusCfx.screenCurrentIndex == 1){
-      xQueueReceive(screenDHTQueue_handle, &TempRHvaluesBuffer, pdMS_TO_TICKS(10));
-      screen.clearBuffer();
-      screen.setFont(u8g2_font_helvB10_te);
-      screen.setCursor(20,25);
-      screen.printf("Temp = %.2f ", TempRHvaluesBuffer.temp);
-      screen.setCursor(30,50);
-      screen.printf("RH = %.2f", TempRHvaluesBuffer.rh);
-      screen.sendBuffer();
-    }else if(screenStatusCfx.screenCurrentIndex == 2){
-      xQueueReceive(screenPulseQueue_handle, &pulseReadingBuffer, pdMS_TO_TICKS(10));
-      screen.clearBuffer();
-      screen.setFont(u8g2_font_helvB12_te);
-      screen.drawStr(40, 25, "BPM");
-      screen.setCursor(50,50);
-      screen.print(pulseReadingBuffer);
-      screen.sendBuffer();
-    }else if(screenStatusCfx.screenCurrentIndex == 3){
-      xQueueReceive(screenOpenWeather_handle, &weatherInfoBuffer, pdMS_TO_TICKS(10));
-      screen.clearBuffer();
-      screen.setFont(u8g2_font_helvB08_tr);
-      screen.drawStr(24,17, weatherInfoBuffer.description.substring(1,weatherInfoBuffer.description.length()-1).c_str());
-      screen.setCursor(14,34);
-      screen.print("Temp: ");
-      screen.print(weatherInfoBuffer.tempFeelLike - 273.25);
-      screen.setCursor(14,64);
-      screen.print("RH(%): ");
-      screen.print(weatherInfoBuffer.humidity);
-      screen.setCursor(14,47);
-      screen.print("wind speed: ");
-      screen.print(weatherInfoBuffer.windSpeed);
-      screen.sendBuffer();
-    }else{
-      
-      xQueueReceive(stepDataQueue_handle, &stepData, pdMS_TO_TICKS(100));
-      
-      screen.clearBuffer();
-      screen.drawFrame(0, 0, 128, 64);
-      
-      screen.setFont(u8g2_font_ncenB08_tr);
-      screen.drawStr(25, 12, "Step Counter");
-      
-      screen.drawLine(5, 15, 123, 15);
-      
-      screen.setFont(u8g2_font_logisoso20_tn);
-      String steps = String(stepData.stepCount);
-      int textWidth = steps.length() * 12;
-      screen.setCursor((128 - textWidth) / 2, 40);
-      screen.print(stepData.stepCount);
-
-      screen.setFont(u8g2_font_6x10_tr);
-      screen.drawStr(45, 52, "Steps");
-    
-      screen.setFont(u8g2_font_5x7_tr);
-      String ip = WiFi.localIP().toString();
-      screen.setCursor(2, 62);
-      screen.print("IP: " + ip);
-      screen.sendBuffer();
+      LOG_D("Display", "input latency %u us | avg %u us | max %u us",
+        inputLatency.lastUs, (uint32_t)(inputLatency.totalUs / inputLatency.samples), inputLatency.maxUs);
+    }
+
+    // a byte on the wire is 9 clocks (8 data + ACK)
+    uint32_t i2cSavedUs = (uint64_t)(FRAME_FULL_REDRAW_BYTES - screenFrameDiff.stats.bytesSentLastFrame) * 9 * 1000000 / I2C_BUS_CLOCK;
+
+    LOG_D("Display", "%s render %u us | avg %u us | max %u us", activeDescriptor->name,
+      renderStats->lastUs, (uint32_t)(renderStats->totalUs / renderStats->frames), renderStats->maxUs);
+    LOG_D("Display", "bytes sent %u / %u | diff %u us | I2C saved %u us",
+      screenFrameDiff.stats.bytesSentLastFrame, FRAME_FULL_REDRAW_BYTES, screenFrameDiff.stats.diffUsLastFrame, i2cSavedUs);
+
+  }
+
+}
+
+
+void wifiEvent(WiFiEvent_t event, WiFiEventInfo_t info){
+  switch(event){
+  case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+    wifiAssocUs = micros();
+    break;
+  case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+    wifiGotIpUs = micros();
+    break;
+  default:
+    break;
+  }
+}
+
+void wifiBegin(){
+  wifiAssocUs = 0;
+  wifiGotIpUs = 0;
+  wifiBeginUs = micros();
+
+  wifiFastAttempt = wifiCacheValid;
+  if(wifiFastAttempt){
+    // no scan across all channels
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, wifiCache.channel, wifiCache.bssid);
+  }else{
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
+}
+
+void wifiPrintPhases(){
+  uint32_t beginUs = wifiBeginUs;
+  uint32_t assocUs = wifiAssocUs;
+  uint32_t gotIpUs = wifiGotIpUs;
+
+  // the driver raises no event between the scan and the auth exchange, so they are reported together
+  LOG_I("WiFi", "%s connect: scan+auth %u ms, dhcp %u ms",
+    wifiFastAttempt ? "fast" : "full",
+    assocUs ? (unsigned)((assocUs - beginUs) / 1000) : 0,
+    (assocUs && gotIpUs) ? (unsigned)((gotIpUs - assocUs) / 1000) : 0);
+}
+
+/*  Set by SNTP from the lwIP task whenever the clock got synced  */
+volatile bool timeSyncCompleted = false;
+
+void timeSyncCallback(struct timeval *tv){
+  timeSyncCompleted = true;
+}
+
+/*  Clients wifiTask runs on behalf of: SNTP restarts inside a window, MQTT publishes only while its window is open  */
+void netPollClients(uint32_t readyClients){
+  static bool timeSynced = false;
+  static bool timeSyncPending = false;
+  static bool timeSyncStarted = false;
+  static uint32_t lastTimeSyncMs = 0;
+
+  uint32_t now = millis();
+  if(!timeSyncPending && (!timeSynced || now - lastTimeSyncMs >= TIME_SYNC_PERIOD)){
+    timeSyncPending = true;
+    netSchedule(NET_CLIENT_TIME);
+  }
+  if(timeSyncPending && (readyClients & NET_CLIENT_TIME)){
+    if(!timeSyncStarted){
+      timeSyncCompleted = false;
+      sntp_restart();
+      timeSyncStarted = true;
+    }else if(timeSyncCompleted){
+      timeSynced = true;
+      timeSyncPending = false;
+      timeSyncStarted = false;
+      lastTimeSyncMs = now;
+      netWindowDone(NET_CLIENT_TIME);
+    }
+  }else{
+    // the window closed over budget, ask again in the next one
+    timeSyncStarted = false;
+  }
+
+#ifdef MQTT_BROKER_URI
+  // an unreachable broker must not keep every window open for its whole budget: without a session
+  // after the grace period MQTT leaves the window and waits for the next one
+  static uint32_t mqttUnreadyMs = 0;
+  static uint32_t mqttGaveUpWindow = UINT32_MAX;
+  bool mqttReady = (readyClients & NET_CLIENT_MQTT) != 0;
+  if(!mqttReady){
+    mqttUnreadyMs = now;
+  }
+  if(mqttReady && !mqttTelemetryConnected() && now - mqttUnreadyMs >= MQTT_CONNECT_GRACE){
+    LOG_D("Net", "no MQTT broker after %u ms, batches wait for the next window", (unsigned)(now - mqttUnreadyMs));
+    mqttGaveUpWindow = netScheduler.windows;
+    netWindowDone(NET_CLIENT_MQTT);
+    mqttReady = false;
+  }else if(mqttTelemetryPending()){
+    if(mqttGaveUpWindow != netScheduler.windows){
+      netSchedule(NET_CLIENT_MQTT);
+    }
+  }else if(mqttReady){
+    netWindowDone(NET_CLIENT_MQTT);
+  }
+  mqttTelemetrySetWindow(mqttReady);
+#endif
+}
+
+void netRadioWake(){
+#ifdef NET_IDLE_RADIO_OFF
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false);
+#else
+  WiFi.setSleep(WIFI_PS_NONE);
+#endif
+}
+
+void netRadioSleep(){
+#ifdef NET_IDLE_RADIO_OFF
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  wifiLinkSuspend(&wifiLink, millis());
+#else
+  WiFi.setSleep(WIFI_PS_MAX_MODEM);
+#endif
+}
+
+void wifiTask(void *parameters){
+  WifiLinkState lastState = WIFI_LINK_IDLE;
+  bool radioAwake = true;
+
+  for(;;){
+    portENTER_CRITICAL(&netSchedulerLock);
+    NetRadioAction radioAction = netSchedulerUpdate(&netScheduler, millis());
+    bool windowOpen = netScheduler.state == NET_SCHED_WINDOW;
+    uint32_t windowClients = netScheduler.active;
+    uint32_t lastWindowMs = netScheduler.lastWindowMs;
+    portEXIT_CRITICAL(&netSchedulerLock);
+
+    if(radioAction == NET_RADIO_WAKE){
+      netRadioWake();
+      radioAwake = true;
+    }else if(radioAction == NET_RADIO_SLEEP){
+      netRadioSleep();
+      LOG_I("Net", "window closed after %u ms", (unsigned)lastWindowMs);
+#ifdef NET_IDLE_RADIO_OFF
+      radioAwake = false;
+#endif
+    }
+
+    WifiLinkAction linkAction = radioAwake ? wifiLinkUpdate(&wifiLink, WiFi.status() == WL_CONNECTED, millis()) : WIFI_ACTION_NONE;
+    switch(linkAction){
+    case WIFI_ACTION_BEGIN:
+      LOG_I("WiFi", "connecting to %s (attempt %u, %s)", WIFI_SSID, (unsigned)wifiLink.attempts,
+        wifiCacheValid ? "cached AP" : "full scan");
+      wifiBegin();
+      break;
+    case WIFI_ACTION_DISCONNECT:
+      LOG_W("WiFi", "no link, retrying in %u ms", (unsigned)wifiLink.backoffMs);
+      WiFi.disconnect();
+      break;
+    default:
+      break;
     }
 
-    Serial.print("Free sceeenDisplay Stack: ");
-    Serial.println(uxTaskGetStackHighWaterMark(screenDisplay_handle));
+    // the AP moved, fall back to a full scan within the same attempt
+    if(wifiFastAttempt && wifiLink.state == WIFI_LINK_CONNECTING
+        && millis() - wifiLink.stateSinceMs >= WIFI_FAST_CONNECT_TIMEOUT){
+      LOG_W("WiFi", "cached AP not reachable, falling back to a full scan");
+      wifiCacheValid = false;
+      WiFi.disconnect();
+      wifiBegin();
+    }
+
+    if(wifiLink.state != lastState){
+      lastState = wifiLink.state;
+      if(wifiLink.state == WIFI_LINK_CONNECTED){
+        LOG_I("WiFi", "connected in %u ms, IP = %s", wifiLink.lastConnectMs, WiFi.localIP().toString().c_str());
+        wifiPrintPhases();
+
+        wifiCacheCapture(&wifiCache, WIFI_SSID);
+        wifiCacheValid = true;
+        if(wifiCacheStore(&wifiCache)){
+          LOG_I("WiFi", "cached channel %u for the next connect", (unsigned)wifiCache.channel);
+        }
+      }
+      displayNotify(DISPLAY_EVENT_DATA);
+    }
 
+    // the window's clients start once the link is up, the budget already counts the connect
+    uint32_t readyClients = (windowOpen && wifiConnected()) ? windowClients : 0;
+    xEventGroupSetBits(netWindowEvents_handle, readyClients);
+    xEventGroupClearBits(netWindowEvents_handle, NET_CLIENTS_ALL & ~readyClients);
+    netPollClients(readyClients);
+
+    // netWindowWait() wakes us early so a request does not wait for the next poll
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WIFI_POLL_PERIOD));
+  }
+}
+
+void appConfigChanged(const ConfigEntry *entry, void *context){
+  char text[CONFIG_TEXT_LENGTH];
+  configFormat(entry, text, sizeof(text));
+  LOG_I("Config", "%s = %s", entry->key, text);
+
+  if(entry->value == &buttonDebounceMs){
+    for(uint8_t button = 0; button < BUTTON_COUNT; button++){
+      buttonGestureConfigs[button].debounceMs = buttonDebounceMs;
+    }
+  }else if(entry->value == weatherCity || entry->value == weatherCountry){
+    // the next fetch is for the new place, don't wait up to weather.period for it
+    if(openWeatherTask_handle != NULL){
+      xTaskNotifyGive(openWeatherTask_handle);
+    }
   }
+}
 
+const StaticTaskConfig appTasks[] = {APP_TASKS(STATIC_TASK_CONFIG)};
+const StaticQueueConfig appQueues[] = {APP_QUEUES(STATIC_QUEUE_CONFIG)};
+#define APP_TASK_COUNT (sizeof(appTasks) / sizeof(appTasks[0]))
+#define APP_QUEUE_COUNT (sizeof(appQueues) / sizeof(appQueues[0]))
+
+/*  RAM the tables and the single objects above reserve. It shows up in the build's RAM figure rather
+ *  than as heap taken at boot, and the build fails when a new entry pushes it past the budget  */
+#define APP_TASK_BYTES (0 APP_TASKS(STATIC_TASK_BYTES))
+#define APP_QUEUE_BYTES (0 APP_QUEUES(STATIC_QUEUE_BYTES))
+#define APP_OTHER_RTOS_BYTES (sizeof(StaticSemaphore_t) + sizeof(StaticEventGroup_t) + sizeof(StaticTimer_t))
+#define APP_LIBRARY_RTOS_BYTES (sizeof(LogStorage) + sizeof(TelemetryStreamStorage) + sizeof(SeriesRecorderStorage) + \
+                                sizeof(I2CBusStorage) + sizeof(DashboardStorage) + sizeof(HealthStorage) + \
+                                APP_MQTT_RTOS_BYTES)
+#define APP_RTOS_BYTES (APP_TASK_BYTES + APP_QUEUE_BYTES + APP_OTHER_RTOS_BYTES + APP_LIBRARY_RTOS_BYTES)
+#ifndef APP_RTOS_BUDGET
+#define APP_RTOS_BUDGET (64 * 1024)
+#endif
+static_assert(APP_RTOS_BYTES <= APP_RTOS_BUDGET, "static tasks and queues exceed APP_RTOS_BUDGET");
+
+#ifdef STACK_PROFILE_ENABLE
+#define STACK_PROFILE_SETTLE 30000      // ms after boot, WiFi up and the first fetch done
+#define STACK_PROFILE_STEP 1500         // ms between scripted inputs, every frame gets rendered
+#define STACK_PROFILE_ROUNDS 3
+#define STACK_PROFILE_STREAM 10000      // ms of binary streaming per round, the pulse sensor at 500 Hz
+#define STACK_PROFILE_MARGIN 25         // % on top of the measured peak
+#define STACK_PROFILE_MIN_HEADROOM 512  // B, for paths the script can't reach
+
+// as if the sampler had recognized the gesture, so it goes through inputTask like a real press
+void stackProfileGesture(uint8_t button, uint8_t gesture){
+  InputEvent event = {(uint32_t)micros(), button, INPUT_GESTURE, gesture};
+  inputEventPush(&inputEventRing, &event);
+  xTaskNotify(inputTask_handle, INPUT_NOTIFY_EVENTS, eSetBits);
+  vTaskDelay(pdMS_TO_TICKS(STACK_PROFILE_STEP));
 }
 
+uint32_t stackProfileRecommend(uint32_t peakBytes){
+  uint32_t headroom = peakBytes * STACK_PROFILE_MARGIN / 100;
+  if(headroom < STACK_PROFILE_MIN_HEADROOM){
+    headroom = STACK_PROFILE_MIN_HEADROOM;
+  }
+  return (peakBytes + headroom + 15) & ~15u;
+}
+
+/*  Peak use of every APP_TASKS stack as an include/AppStacks.h the task table picks up  */
+void stackProfileReport(){
+  uint32_t currentTotal = 0;
+  uint32_t tunedTotal = 0;
+  Serial.println("-----BEGIN APP STACKS-----");
+  Serial.printf("// include/AppStacks.h, peak stack use + %u %% (at least %u B) from a stackprofile run\n",
+                STACK_PROFILE_MARGIN, STACK_PROFILE_MIN_HEADROOM);
+  Serial.println("#define APP_STACKS_TUNED");
+  for(uint8_t task = 0; task < APP_TASK_COUNT; task++){
+    const StaticTaskConfig *config = &appTasks[task];
+    // the high water mark is the least free stack the task ever had, in bytes on ESP-IDF
+    uint32_t peak = config->stackBytes - uxTaskGetStackHighWaterMark(*config->handle);
+    uint32_t tuned = stackProfileRecommend(peak);
+    currentTotal += config->stackBytes;
+    tunedTotal += tuned;
+    Serial.printf("#define APP_STACK_%s %u  // peak %u of %u B\n", config->functionName, (unsigned)tuned,
+                  (unsigned)peak, (unsigned)config->stackBytes);
+  }
+  Serial.printf("// %u B instead of %u B\n", (unsigned)tunedTotal, (unsigned)currentTotal);
+  Serial.println("-----END APP STACKS-----");
+}
+
+/*  Scripted workload for the stackprofile environment: every screen with a frame dump, time editing,
+ *  a step reset, weather fetches and binary streaming, then the stack report  */
+void stackProfileTask(void *parameters){
+  vTaskDelay(pdMS_TO_TICKS(STACK_PROFILE_SETTLE));
+
+  for(uint8_t round = 0; round < STACK_PROFILE_ROUNDS; round++){
+    LOG_I("Stack", "workload round %u / %u", round + 1, STACK_PROFILE_ROUNDS);
+    for(uint8_t screenIndex = 0; screenIndex < SCREEN_COUNT; screenIndex++){
+      stackProfileGesture(BUTTON_SCREEN_CHANGE, GESTURE_PRESS);
+      displayNotify(DISPLAY_EVENT_DUMP);
+      vTaskDelay(pdMS_TO_TICKS(STACK_PROFILE_STEP));
+
+      if(screenStatusCfx.screenCurrentIndex == SCREEN_TIME){
+        // every field, nudged up and back so the clock ends where it was
+        for(uint8_t field = 0; field < 5; field++){
+          stackProfileGesture(BUTTON_TIME_EDIT_ENABLE, GESTURE_PRESS);
+          stackProfileGesture(BUTTON_TIME_INCREMENT, GESTURE_PRESS);
+          stackProfileGesture(BUTTON_TIME_DECREMENT, GESTURE_REPEAT);
+        }
+        stackProfileGesture(BUTTON_TIME_EDIT_ENABLE, GESTURE_LONG_PRESS);
+      }else if(screenStatusCfx.screenCurrentIndex == SCREEN_STEPS){
+        stackProfileGesture(BUTTON_SCREEN_CHANGE, GESTURE_LONG_PRESS);
+      }
+    }
+
+    xTaskNotifyGive(openWeatherTask_handle);
+    vTaskDelay(pdMS_TO_TICKS(STACK_PROFILE_STEP * 4));
+
+    // what the 'b' and 't' console commands do
+    telemetryStreamEnable(true);
+    logSetOutput(telemetryStreamLogOutput());
+    xTaskNotifyGive(readPulseSensor_handle);
+    vTaskDelay(pdMS_TO_TICKS(STACK_PROFILE_STREAM));
+    logSetOutput(Serial);
+    telemetryStreamEnable(false);
+  }
+
+  stackProfileReport();
+  vTaskDelete(NULL);
+}
+#endif
 
 void setup(){
   Serial.begin(115200);
+  // lowest priority on core 0: sampling tasks on core 1 never wait for the UART
+  logInit(Serial, &logStorage, 0, 0);
+  // above the log drain, so raw samples win the UART over text
+  telemetryStreamInit(Serial, &telemetryStreamStorage, 1, 0);
+
+  // flash writes are rare and slow, lowest priority next to the log drain
+  if(!seriesRecorderBegin(seriesConfigs, SERIES_COUNT, &seriesRecorderStorage, 0, 0)){
+    LOG_E("Series", "LittleFS mount failed, no history this boot");
+  }
+
+  // before anything reads the cached values
+  configBegin(appConfig, APP_CONFIG_COUNT);
+  for(uint8_t button = 0; button < BUTTON_COUNT; button++){
+    buttonGestureConfigs[button].debounceMs = buttonDebounceMs;
+  }
+  configOnChange(appConfigChanged, NULL);
 
   delay(1000);
   
@@ -696,32 +1733,46 @@ void setup(){
   pinMode(TIME_INCREMENT_BUTTON, INPUT_PULLUP);
   pinMode(TIME_DECREMENT_BUTTON, INPUT_PULLUP);
 
-  attachInterrupt(digitalPinToInterrupt(SCREEN_CHANGE_BUTTON),  screenChangeButtonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(TIME_EDIT_ENABLE_BUTTON), screenTimeDateEditEnableButtonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(TIME_INCREMENT_BUTTON), screenTimeIncrementButtonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(TIME_DECREMENT_BUTTON), screenTimeDecremntButtonISR, FALLING); 
+  inputEventRingInit(&inputEventRing);
+  for(uint8_t button = 0; button < BUTTON_COUNT; button++){
+    buttonGestureInit(&buttonGestures[button], &buttonGestureConfigs[button]);
+  }
+
+  esp_timer_create_args_t buttonSampleTimerArgs = {};
+  buttonSampleTimerArgs.callback = buttonSampleCallback;
+  buttonSampleTimerArgs.name = "button sampler";
+  esp_timer_create(&buttonSampleTimerArgs, &buttonSampleTimer_handle);
+
+  for(uint8_t button = 0; button < BUTTON_COUNT; button++){
+    attachInterruptArg(digitalPinToInterrupt(buttonPins[button]), inputButtonISR, (void *)(uintptr_t)button, CHANGE);
+  }
   
-  screenDisplaySemaphore_handle = xSemaphoreCreateBinary();
-  timeIncerementSemaphore_handle = xSemaphoreCreateBinary();
-  timeDecrementSemaphore_handle = xSemaphoreCreateBinary();
-  resetSemaphore_handle = xSemaphoreCreateBinary();
-
-  screenRTCQueue_handle = xQueueCreate(1, sizeof(timeStrings));
-  screenDHTQueue_handle = xQueueCreate(SCREEN_DHT_QUEUE_SIZE, sizeof(DHT_sensor_data));
-  screenPulseQueue_handle = xQueueCreate(SCREEN_PULSE_QUEUE_SIZE, sizeof(uint16_t));
-  screenOpenWeather_handle = xQueueCreate(SCREEN_WEATHER_API_QUEUE_SIZE, sizeof(openWeatherJSONParsed));
-  mpuDataQueue_handle = xQueueCreate(10, sizeof(float) * 3);
-  stepDataQueue_handle = xQueueCreate(1, sizeof(StepData));
-  displayQueue_handle = xQueueCreate(1, sizeof(StepData));
+  resetSemaphore_handle = xSemaphoreCreateBinaryStatic(&resetSemaphoreBuffer);
+
+  if(staticQueuesCreate(appQueues, APP_QUEUE_COUNT) > 0){
+    LOG_E("RTOS", "queue table has a bad entry");
+  }
+  for(uint8_t queue = 0; queue < APP_QUEUE_COUNT; queue++){
+    healthRegisterQueue(appQueues[queue].name, *appQueues[queue].handle);
+  }
+  LOG_I("RTOS", "static tasks %u B | queues %u B | other %u B | libraries %u B | total %u B of %u B budget",
+        (unsigned)APP_TASK_BYTES, (unsigned)APP_QUEUE_BYTES, (unsigned)APP_OTHER_RTOS_BYTES,
+        (unsigned)APP_LIBRARY_RTOS_BYTES, (unsigned)APP_RTOS_BYTES, (unsigned)APP_RTOS_BUDGET);
+
+  i2cClientInit(&mpuI2CClient, "MPU6050", I2C_PRIORITY_HIGH);
+  i2cClientInit(&screenI2CClient, "SH1106", I2C_PRIORITY_LOW);
 
   Wire.begin();
+  Wire.setClock(I2C_BUS_CLOCK);
+  // U8g2 re-applies its own clock on every transfer, keep it at the same speed
+  screen.setBusClock(I2C_BUS_CLOCK);
   screen.begin();
 
-  Serial.println("Initializing MPU-6050...");
+  LOG_I("MPU", "initializing MPU-6050...");
   mpu.initialize();
   
   if (!mpu.testConnection()) {
-    Serial.println("MPU-6050 connection failed!");
+    LOG_E("MPU", "MPU-6050 connection failed!");
     screen.clearBuffer();
     screen.drawStr(5, 20, "MPU-6050 Error!");
     screen.setFont(u8g2_font_5x7_tr);
@@ -732,104 +1783,313 @@ void setup(){
     while (1) delay(1000);
   }
   
-  Serial.println(" MPU-6050 connected!");
+  LOG_I("MPU", "MPU-6050 connected");
 
   mpu.setFullScaleAccelRange(MPU6050_ACCEL_FS_16);
   mpu.setFullScaleGyroRange(MPU6050_GYRO_FS_250);
 
   WiFi.mode(WIFI_STA); // Set to station mode
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  Serial.printf("Connecting to %s", WIFI_SSID);
+  // reconnects are wifiTask's job, with backoff
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent(wifiEvent, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+  WiFi.onEvent(wifiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  wifiCacheValid = wifiCacheLoad(&wifiCache, WIFI_SSID);
+  wifiLinkInit(&wifiLink, &wifiLinkConfig);
+  netSchedulerInit(&netScheduler, &netSchedulerConfig, millis());
+  netWindowEvents_handle = xEventGroupCreateStatic(&netWindowEventsBuffer);
+  // listens on every interface, serves as soon as wifiTask brings the link up.
+  // The push task sits on core 0 next to the WiFi stack, away from the sensor tasks
+  dashboardBegin(&dashboardStorage, 1, 0);
+#ifdef MQTT_BROKER_URI
+  // the client keeps retrying until the link is up, batches wait in the offline buffer
+  mqttTelemetryBegin(&mqttTelemetryConfig, &mqttTelemetryStorage, 1, 0);
+#endif
+
+  // SNTP keeps retrying on its own until the link comes up
+  configTime(gmOffset, dayLightSaving, ntpServer1, ntpServer2);
+  sntp_set_time_sync_notification_cb(timeSyncCallback);
+
+  // boot frames went out with sendBuffer(), so the first flush has to be a full one
+  frameDiffInit(&screenFrameDiff);
+
+  // from here on the Wire bus belongs to the manager task, it outranks every client
+  i2cBusInit(&i2cBusStorage, 3, 1);
+
+  if(staticTasksCreate(appTasks, APP_TASK_COUNT) > 0){
+    LOG_E("RTOS", "task table has a bad entry");
+  }
+
+  blinkTimer_handle = xTimerCreateStatic("Blink Timer", pdMS_TO_TICKS(BLINK_PERIOD), pdTRUE, NULL, blinkTimerCallback,
+                                         &blinkTimerBuffer);
+  xTimerStart(blinkTimer_handle, 0);
+
+#ifdef STACK_PROFILE_ENABLE
+  // profiling builds only, so it stays out of the static table and its budget
+  xTaskCreatePinnedToCore(stackProfileTask, "STACK PROFILE TASK", 3072, NULL, 1, NULL, 1);
+#endif
+
+  // last, so its first sample already sees every task
+  healthBegin(HEALTH_PERIOD, healthSampled, &healthStorage, 0, 0);
+
+  // first frame, everything after this is event driven
+  displayNotify(DISPLAY_EVENT_DATA);
 
-  String StartScreenFrames[] = {"Connecting", "Connecting.", "Connecting..","Connecting..."};
   
-  while(WiFi.status() != WL_CONNECTED){
-    for(int i=0; i<4; i++){
-      screen.clearBuffer();
-      screen.setFont(u8g2_font_helvB12_te);
-      screen.drawStr(20,40, StartScreenFrames[i].c_str());
-      screen.sendBuffer();
+}
+
+/*  Serial console commands  */
+#define CMD_DUMP_FRAME 'p'    // dump the next frame of the current screen as PBM
+#define CMD_STREAM_BINARY 'b' // switch the UART to framed binary telemetry, see tools/telemetry_decode.py
+#define CMD_STREAM_TEXT 't'   // back to plain log text
+#define CMD_HISTORY 'h'       // summary of the last 24 h of every recorded series
+#define CMD_TRACE_DUMP 'd'    // dump the trace rings, see tools/trace_to_chrome.py
+#define CMD_CONFIG 'c'        // "c" lists the settings, "c key=value" changes one, "c key=" resets it
+#define CONFIG_LINE_LENGTH 64
+
+typedef struct{
+  SeriesKind kind;
+  uint32_t count;
+  float min;
+  float max;
+  float last;
+}SeriesSummary;
+
+bool seriesSummaryVisit(const SeriesSample *sample, void *context){
+  SeriesSummary *summary = (SeriesSummary *)context;
+  float value = summary->kind == SERIES_FLOAT ? sample->value.f : (float)sample->value.i;
+  if(summary->count == 0 || value < summary->min){
+    summary->min = value;
+  }
+  if(summary->count == 0 || value > summary->max){
+    summary->max = value;
+  }
+  summary->last = value;
+  summary->count++;
+  return true;
+}
+
+void configCommand(char *line){
+  while(*line == ' '){
+    line++;
+  }
+  if(*line == '\0'){
+    char text[CONFIG_TEXT_LENGTH];
+    for(uint8_t i = 0; i < configCount(); i++){
+      const ConfigEntry *entry = configEntry(i);
+      configFormat(entry, text, sizeof(text));
+      if(entry->type == CONFIG_STRING){
+        LOG_I("Config", "%s = %s (default %s) | %s", entry->key, text, entry->defaultText, entry->help);
+      }else{
+        LOG_I("Config", "%s = %s (default %g, %g to %g) | %s", entry->key, text, entry->defaultNumber,
+              entry->minimum, entry->maximum, entry->help);
+      }
     }
-    Serial.print(".");
-    delay(100);
+    return;
   }
 
-  configTime(gmOffset, dayLightSaving, ntpServer1, ntpServer2);
+  char *value = strchr(line, '=');
+  if(value == NULL){
+    LOG_W("Config", "expected key=value, got \"%s\"", line);
+    return;
+  }
+  *value++ = '\0';
+  ConfigResult result = *value == '\0' ? configReset(line) : configSet(line, value);
+  if(result != CONFIG_OK){
+    LOG_W("Config", "%s: %s", line, configResultText(result));
+  }
+}
 
-  xTaskCreatePinnedToCore(
-    readDHT,
-    "DHT SENSOR READING TASK",
-    2000,
-    NULL,
-    1,
-    &readDHT_handle,
-    1    
-  );
-
-  xTaskCreatePinnedToCore(
-    readPulseSensor,
-    "READ PULSE SENSOR TASK",
-    3000,
-    NULL,
-    1,
-    &readPulseSensor_handle,
-    1
-  );
-
-  xTaskCreatePinnedToCore(
-    readRTC,
-    "READ INTERNAL RTC TASK",
-    3000,
-    NULL,
-    1,
-    &readRTC_handle,
-    1
-  );
-
-  xTaskCreatePinnedToCore(
-    openWeatherGet, 
-    "OpenWeatherAPI Task",
-    4000,
-    NULL,
-    1,
-    &openWeatherTask_handle,
-    1
-  );
-
-
-  xTaskCreatePinnedToCore(
-    readMPU,
-    "MPU6050 Reading Task",
-    3000,
-    NULL,
-    2,
-    &readMPU_handle,
-    1
-  );
-  
-  xTaskCreatePinnedToCore(
-    stepDetection,
-    "Step Detection Task",
-    4000,
-    NULL,
-    2,
-    &stepDetection_handle,
-    1
-  );
-
-  xTaskCreatePinnedToCore(
-    screenDisplay,
-    "OLED DISPLAY TASK",
-    5000,
-    NULL,
-    1,
-    &screenDisplay_handle,
-    1
-  );
+void printHistory(){
+  uint32_t now;
+  if(!seriesNow(&now)){
+    LOG_I("Series", "clock not set, no history to show");
+    return;
+  }
+  for(uint8_t series = 0; series < SERIES_COUNT; series++){
+    SeriesSummary summary = {seriesConfigs[series].kind, 0, 0, 0, 0};
+    uint32_t startUs = micros();
+    seriesRecorderQuery(series, now - 24 * 3600, now, seriesSummaryVisit, &summary);
+    LOG_I("Series", "%s, last 24 h: %u samples | min %.1f | max %.1f | last %.1f | query %u us",
+          seriesConfigs[series].name, (unsigned)summary.count, summary.min, summary.max, summary.last,
+          (unsigned)(micros() - startUs));
+  }
+}
 
-  
+#define STATS_REPORT_PERIOD 10000
+#define ALLOC_REPORT_TOP 8
+
+#ifdef ALLOC_TRACK_ENABLE
+// one window per stats report, the hottest sites at INFO, the per task sums at DEBUG
+void printAllocations(){
+  static AllocSiteStats sites[ALLOC_TRACK_MAX_SITES];
+  static AllocTaskStats tasks[ALLOC_TRACK_MAX_SITES];
+  AllocTrackTotals totals;
+  uint8_t siteCount = allocTrackSnapshot(sites, ALLOC_TRACK_MAX_SITES, &totals, true);
+  uint32_t seconds = totals.windowMs / 1000 ? totals.windowMs / 1000 : 1;
+
+  LOG_I("Alloc", "%u allocs (%u/s) | %u B (%u B/s) | frees %u | failed %u | overflow %u | window %u s",
+        (unsigned)totals.allocations, (unsigned)(totals.allocations / seconds), (unsigned)totals.bytes,
+        (unsigned)(totals.bytes / seconds), (unsigned)totals.frees, (unsigned)totals.failed,
+        (unsigned)totals.overflow, (unsigned)seconds);
+  for(uint8_t i = 0; i < siteCount; i++){
+    const AllocSiteStats *site = &sites[i];
+    if(site->site != NULL){
+      LOG_AT(i < ALLOC_REPORT_TOP ? LOG_LEVEL_INFO : LOG_LEVEL_DEBUG, "Alloc", "#%u %s | task %s | %u allocs | %u B",
+             i + 1, site->site, site->task, (unsigned)site->allocations, (unsigned)site->bytes);
+    }else{
+      // untagged: addr2line -e .pio/build/alloctrack/firmware.elf <pc>
+      LOG_AT(i < ALLOC_REPORT_TOP ? LOG_LEVEL_INFO : LOG_LEVEL_DEBUG, "Alloc", "#%u pc %p | task %s | %u allocs | %u B",
+             i + 1, site->caller, site->task, (unsigned)site->allocations, (unsigned)site->bytes);
+    }
+  }
+
+  uint8_t taskCount = allocTrackByTask(sites, siteCount, tasks, ALLOC_TRACK_MAX_SITES);
+  for(uint8_t i = 0; i < taskCount; i++){
+    LOG_D("Alloc", "task %s | %u allocs | %u B", tasks[i].task, (unsigned)tasks[i].allocations, (unsigned)tasks[i].bytes);
+  }
 }
+#endif
 
 void loop(){
+  static uint32_t lastStatsReport = 0;
+
+  while(Serial.available() > 0){
+    char command = Serial.read();
+    // the PBM dump writes plain text, it would break the framing
+    if(command == CMD_DUMP_FRAME && !telemetryStreamActive()){
+      displayNotify(DISPLAY_EVENT_DUMP);
+    }else if(command == CMD_STREAM_BINARY && !telemetryStreamActive()){
+      telemetryStreamEnable(true);
+      logSetOutput(telemetryStreamLogOutput());
+      xTaskNotifyGive(readPulseSensor_handle);
+    }else if(command == CMD_STREAM_TEXT && telemetryStreamActive()){
+      logSetOutput(Serial);
+      telemetryStreamEnable(false);
+    }else if(command == CMD_HISTORY){
+      printHistory();
+    }else if(command == CMD_CONFIG && !telemetryStreamActive()){
+      char line[CONFIG_LINE_LENGTH];
+      size_t length = Serial.readBytesUntil('\n', line, sizeof(line) - 1);
+      line[length] = '\0';
+      if(length > 0 && line[length - 1] == '\r'){
+        line[length - 1] = '\0';
+      }
+      configCommand(line);
+    }else if(command == CMD_TRACE_DUMP && !telemetryStreamActive()){
+#ifdef TRACE_ENABLE
+      traceDump(Serial);
+#else
+      LOG_I("Trace", "built without -DTRACE_ENABLE");
+#endif
+    }
+  }
+
+  if(millis() - lastStatsReport >= STATS_REPORT_PERIOD){
+    lastStatsReport = millis();
+    if(!telemetryStreamActive()){
+      i2cBusPrintStats(Serial, i2cClients, sizeof(i2cClients) / sizeof(i2cClients[0]));
+    }
+
+    uint32_t stableEdges = 0;
+    for(uint8_t button = 0; button < BUTTON_COUNT; button++){
+      stableEdges += buttonGestures[button].transitions;
+    }
+    LogStats logStats;
+    logGetStats(&logStats);
+    LOG_I("Log", "written %u | dropped %u | max depth %u / %u",
+          (unsigned)logStats.written, (unsigned)logStats.dropped, (unsigned)logStats.maxDepth, LOG_RING_SIZE);
+
+    SampleJitter jitter = mpuJitter;
+    mpuJitterReset = true;
+    if(jitter.samples > 0){
+      LOG_I("MPU", "period avg %u us | min %u us | max %u us",
+            (unsigned)(jitter.totalUs / jitter.samples), (unsigned)jitter.minUs, (unsigned)jitter.maxUs);
+    }
+
+    LOG_I("Input", "pushed %u | dropped %u | raw edges %u | debounced edges %u | gestures %u",
+          (unsigned)inputEventRing.pushed.load(), (unsigned)inputEventRing.dropped.load(),
+          (unsigned)inputStats.edges, (unsigned)stableEdges, (unsigned)inputStats.gestures);
+
+    TelemetryStreamStats streamStats;
+    telemetryStreamGetStats(&streamStats);
+    LOG_I("Stream", "%s | records %u | dropped %u | %u B",
+          telemetryStreamActive() ? "binary" : "off", (unsigned)streamStats.records,
+          (unsigned)streamStats.dropped, (unsigned)streamStats.bytes);
+
+    // the monitor samples on its own schedule, the report prints the latest one
+    static HealthSnapshot health;
+    healthGetSnapshot(&health);
+    // share of the free heap that no single allocation can use
+    uint32_t fragmentation = health.heapFree ? 100 - (uint64_t)health.heapLargestBlock * 100 / health.heapFree : 0;
+    LOG_I("Health", "heap free %u | min %u | largest block %u | fragmentation %u%%",
+          (unsigned)health.heapFree, (unsigned)health.heapMinFree, (unsigned)health.heapLargestBlock,
+          (unsigned)fragmentation);
+    if(health.cpuLoad[0] != HEALTH_CPU_UNKNOWN){
+      LOG_I("Health", "cpu %u%% / %u%%", health.cpuLoad[0], health.cpuLoad[1]);
+    }
+    for(uint8_t i = 0; i < health.taskCount; i++){
+      const HealthTask *task = &health.tasks[i];
+      if(task->cpuPercent == HEALTH_CPU_UNKNOWN){
+        LOG_D("Health", "task %s | stack free %u B | prio %u | core %d", task->name, (unsigned)task->stackFree,
+              task->priority, task->core);
+      }else{
+        LOG_D("Health", "task %s | stack free %u B | prio %u | core %d | cpu %u%%", task->name, (unsigned)task->stackFree,
+              task->priority, task->core, task->cpuPercent);
+      }
+    }
+    for(uint8_t i = 0; i < health.queueCount; i++){
+      const HealthQueue *queue = &health.queues[i];
+      LOG_D("Health", "queue %s | %u / %u | max %u", queue->name, queue->waiting, queue->length, queue->maxWaiting);
+    }
+    if(health.taskCount > 0){
+      LOG_I("Health", "tasks %u | tightest stack %s %u B", health.taskCount, health.tasks[0].name,
+            (unsigned)health.tasks[0].stackFree);
+    }
+
+#ifdef ALLOC_TRACK_ENABLE
+    printAllocations();
+#endif
+
+    SeriesRecorderStats seriesStats;
+    seriesRecorderGetStats(&seriesStats);
+    LOG_I("Series", "appended %u | rejected %u | dropped %u | block writes %u | blocks %u/%u/%u/%u of %u",
+          (unsigned)seriesStats.store.appended, (unsigned)seriesStats.store.rejected, (unsigned)seriesStats.dropped,
+          (unsigned)seriesStats.store.blockWrites, (unsigned)seriesStats.blocks[SERIES_STEPS],
+          (unsigned)seriesStats.blocks[SERIES_BPM], (unsigned)seriesStats.blocks[SERIES_TEMPERATURE],
+          (unsigned)seriesStats.blocks[SERIES_HUMIDITY], SERIES_STORE_BLOCKS);
+
+    DashboardStats dashboardStats;
+    dashboardGetStats(&dashboardStats);
+    LOG_I("Dashboard", "clients %u | page %u | state %u | health %u | pushes %u | coalesced %u",
+          (unsigned)dashboardStats.clients, (unsigned)dashboardStats.pageRequests, (unsigned)dashboardStats.stateRequests,
+          (unsigned)dashboardStats.healthRequests, (unsigned)dashboardStats.pushes, (unsigned)dashboardStats.coalesced);
+
+    portENTER_CRITICAL(&netSchedulerLock);
+    NetScheduler netStats = netScheduler;
+    portEXIT_CRITICAL(&netSchedulerLock);
+    uint32_t radioOnMs = (uint32_t)netStats.radioOnMs;
+    if(netStats.state == NET_SCHED_WINDOW){
+      radioOnMs += millis() - netStats.windowStartMs;
+    }
+    LOG_I("Net", "windows %u | overruns %u | radio awake %u s (%.1f%%) | last window %u ms of %u ms",
+          (unsigned)netStats.windows, (unsigned)netStats.overruns, (unsigned)(radioOnMs / 1000),
+          radioOnMs * 100.0f / millis(), (unsigned)netStats.lastWindowMs, (unsigned)netSchedulerConfig.windowBudgetMs);
+
+#ifdef MQTT_BROKER_URI
+    static uint32_t lastMqttAcked = 0;
+    MqttTelemetryStats mqttStats;
+    mqttTelemetryGetStats(&mqttStats);
+    uint32_t ackedSinceReport = mqttStats.acked - lastMqttAcked;
+    lastMqttAcked = mqttStats.acked;
+    LOG_I("MQTT", "%s | %.2f msg/s | %u B/msg | batches %u | published %u | acked %u | retransmits %u | queued %u | in flight %u | dropped %u",
+          mqttStats.connected ? "connected" : "offline",
+          ackedSinceReport * 1000.0f / STATS_REPORT_PERIOD,
+          mqttStats.acked ? (unsigned)(mqttStats.bytesAcked / mqttStats.acked) : 0,
+          (unsigned)mqttStats.batches, (unsigned)mqttStats.published, (unsigned)mqttStats.acked,
+          (unsigned)mqttStats.retransmits, (unsigned)mqttStats.queued, (unsigned)mqttStats.inFlight,
+          (unsigned)mqttStats.dropped);
+#endif
+  }
 
+  vTaskDelay(pdMS_TO_TICKS(100));
 }
\ No newline at end of file
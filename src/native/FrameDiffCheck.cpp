@@ -0,0 +1,103 @@
+/*  FrameDiff against a model of the panel: every area it emits is copied from the frame into the model,
+ *  like updateDisplayArea() does on the SH1106. After each of a run of random frames the model has to
+ *  equal the full buffer, and with the diff valid nothing clean may have been sent  */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <FrameDiff.h>
+
+#include "Runner.h"
+
+#define FRAMES 5000
+
+typedef struct{
+  const uint8_t *frame;
+  uint8_t panel[FRAME_BUFFER_BYTES];
+  uint8_t before[FRAME_BUFFER_BYTES];   // panel at the start of the flush
+  uint32_t cleanTilesSent;
+}PanelModel;
+
+static void sendToPanel(uint8_t tileX, uint8_t tileY, uint8_t tileWidth, void *context){
+  PanelModel *model = (PanelModel *)context;
+  for(uint8_t tile = tileX; tile < tileX + tileWidth; tile++){
+    uint16_t offset = tileY * FRAME_PAGE_BYTES + tile * FRAME_TILE_BYTES;
+    if(memcmp(model->before + offset, model->frame + offset, FRAME_TILE_BYTES) == 0){
+      model->cleanTilesSent++;
+    }
+    memcpy(model->panel + offset, model->frame + offset, FRAME_TILE_BYTES);
+  }
+}
+
+// what a screen change does to the buffer: a few boxes, pixels or a whole new page content
+static void mutate(uint8_t *frame, uint32_t *seed){
+  switch(randomBelow(seed, 4)){
+  case 0:
+    for(uint32_t flips = randomBelow(seed, 8) + 1; flips > 0; flips--){
+      frame[randomBelow(seed, FRAME_BUFFER_BYTES)] ^= 1 << randomBelow(seed, 8);
+    }
+    break;
+  case 1:{
+    uint16_t start = randomBelow(seed, FRAME_BUFFER_BYTES);
+    uint16_t length = randomBelow(seed, FRAME_PAGE_BYTES) + 1;
+    uint8_t value = randomBelow(seed, 256);
+    for(uint16_t i = start; i < start + length && i < FRAME_BUFFER_BYTES; i++){
+      frame[i] = value;
+    }
+    break;
+  }
+  case 2:
+    memset(frame + randomBelow(seed, FRAME_TILE_HEIGHT) * FRAME_PAGE_BYTES, 0, FRAME_PAGE_BYTES);
+    break;
+  default:
+    break;    // an unchanged frame, nothing may be sent
+  }
+}
+
+// buffers at offset 0 take the word compare, at 1 the byte fallback
+static void runFrames(uint8_t offset, uint32_t seed){
+  static uint8_t storage[FRAME_BUFFER_BYTES + 4] __attribute__((aligned(4)));
+  uint8_t *frame = storage + offset;
+  memset(storage, 0, sizeof(storage));
+
+  FrameDiff frameDiff;
+  frameDiffInit(&frameDiff);
+  static PanelModel model;
+  memset(&model, 0, sizeof(model));
+  memset(model.panel, 0xA5, sizeof(model.panel));   // whatever the panel held before boot
+  model.frame = frame;
+
+  uint32_t mismatches = 0;
+  uint32_t extraFullFrames = 0;
+  uint64_t bytesSent = 0;
+  for(uint32_t i = 0; i < FRAMES; i++){
+    mutate(frame, &seed);
+    if(randomBelow(&seed, 500) == 0){
+      frameDiffInvalidate(&frameDiff);
+      extraFullFrames++;
+    }
+    bool fullFrame = !frameDiff.valid;
+    memcpy(model.before, model.panel, sizeof(model.panel));
+    uint32_t cleanBefore = model.cleanTilesSent;
+
+    bytesSent += frameDiffFlush(&frameDiff, frame, sendToPanel, &model);
+
+    mismatches += memcmp(model.panel, frame, FRAME_BUFFER_BYTES) != 0;
+    mismatches += !frameDiffVerify(&frameDiff, frame);
+    if(fullFrame){
+      model.cleanTilesSent = cleanBefore;   // a full frame resends clean tiles on purpose
+    }
+  }
+
+  printf("framediff %s buffer, %u frames: %u mismatches, %u clean tiles sent, %.0f B/frame (full %u)\n",
+         offset == 0 ? "aligned" : "unaligned", FRAMES, mismatches, model.cleanTilesSent,
+         (double)bytesSent / FRAMES, FRAME_FULL_REDRAW_BYTES);
+  check(mismatches == 0, "panel model equals the full buffer after every flush");
+  check(model.cleanTilesSent == 0, "only dirty tiles sent");
+  check(frameDiff.stats.frames == FRAMES && extraFullFrames > 0, "frames counted, invalidations exercised");
+}
+
+void runFrameDiff(){
+  runFrames(0, 7);
+  runFrames(1, 7);
+}
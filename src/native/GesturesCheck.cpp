@@ -0,0 +1,133 @@
+/*  Button gestures from scripted press sequences: the level is sampled every SAMPLE_PERIOD ms like the
+ *  firmware's esp_timer does, and the gestures that come out, with the time of the sample that produced
+ *  them, have to be exactly the expected ones. The configs are the firmware's, see buttonGestureConfigs,
+ *  plus a double press one that no button uses but the library still offers  */
+
+#include <stdio.h>
+
+#include <ButtonGestures.h>
+
+#include "Runner.h"
+
+#define SAMPLE_PERIOD 5     // ms, BUTTON_SAMPLE_PERIOD
+#define DEBOUNCE 20         // ms, DEBOUNCE_TIME
+#define MAX_GESTURES 32
+#define COUNT(array) (sizeof(array) / sizeof(array[0]))
+
+static const GestureConfig longPress = {DEBOUNCE, 1000, 0, 0, 0, 0, 0};      // SCREEN_CHANGE, TIME_EDIT_ENABLE
+static const GestureConfig doublePress = {DEBOUNCE, 0, 300, 0, 0, 0, 0};
+static const GestureConfig repeat = {DEBOUNCE, 0, 0, 400, 120, 40, 10};      // TIME_INCREMENT / DECREMENT
+
+typedef struct{
+  bool pressed;
+  uint16_t ms;
+}Segment;
+
+typedef struct{
+  GestureType gesture;
+  uint32_t atMs;
+}Gesture;
+
+/*  A press is seen DEBOUNCE after the level settled, so a clean press at t gives its edge at t + 20  */
+
+// bounces shorter than the debounce restart it, the press counts from its last settle at 70
+static const Segment bouncyShort[] = {{false, 50}, {true, 5}, {false, 5}, {true, 5}, {false, 5}, {true, 120}, {false, 200}};
+static const Gesture bouncyShortOut[] = {{GESTURE_PRESS, 210}};
+
+static const Segment held[] = {{false, 20}, {true, 1500}, {false, 100}};
+static const Gesture heldOut[] = {{GESTURE_LONG_PRESS, 1040}};
+
+// second press 100 ms after the first release, inside the 300 ms window
+static const Segment twice[] = {{false, 20}, {true, 80}, {false, 100}, {true, 80}, {false, 400}};
+static const Gesture twiceOut[] = {{GESTURE_DOUBLE_PRESS, 220}};
+
+// a single press is only reported once the double press window closed
+static const Segment once[] = {{false, 20}, {true, 80}, {false, 500}};
+static const Gesture onceOut[] = {{GESTURE_PRESS, 420}};
+
+// without a double press window two quick presses are two presses, each on its release edge
+static const Gesture twiceQuickOut[] = {{GESTURE_PRESS, 120}, {GESTURE_PRESS, 300}};
+
+// two presses 400 ms apart are two single presses
+static const Segment twiceSlow[] = {{false, 20}, {true, 80}, {false, 400}, {true, 80}, {false, 500}};
+static const Gesture twiceSlowOut[] = {{GESTURE_PRESS, 420}, {GESTURE_PRESS, 900}};
+
+// press on the down edge, repeats from 400 ms after it every 120 ms
+static const Segment scroll[] = {{false, 20}, {true, 1200}, {false, 100}};
+static const Gesture scrollOut[] = {
+  {GESTURE_PRESS, 40}, {GESTURE_REPEAT, 440}, {GESTURE_REPEAT, 560}, {GESTURE_REPEAT, 680}, {GESTURE_REPEAT, 800},
+  {GESTURE_REPEAT, 920}, {GESTURE_REPEAT, 1040}, {GESTURE_REPEAT, 1160}
+};
+
+// after the 10th repeat the interval drops to 40 ms, until the release edge at 2040
+static const Segment scrollFast[] = {{false, 20}, {true, 2000}, {false, 100}};
+static const Gesture scrollFastOut[] = {
+  {GESTURE_PRESS, 40}, {GESTURE_REPEAT, 440}, {GESTURE_REPEAT, 560}, {GESTURE_REPEAT, 680}, {GESTURE_REPEAT, 800},
+  {GESTURE_REPEAT, 920}, {GESTURE_REPEAT, 1040}, {GESTURE_REPEAT, 1160}, {GESTURE_REPEAT, 1280},
+  {GESTURE_REPEAT, 1400}, {GESTURE_REPEAT, 1520}, {GESTURE_REPEAT, 1560}, {GESTURE_REPEAT, 1600},
+  {GESTURE_REPEAT, 1640}, {GESTURE_REPEAT, 1680}, {GESTURE_REPEAT, 1720}, {GESTURE_REPEAT, 1760},
+  {GESTURE_REPEAT, 1800}, {GESTURE_REPEAT, 1840}, {GESTURE_REPEAT, 1880}, {GESTURE_REPEAT, 1920},
+  {GESTURE_REPEAT, 1960}, {GESTURE_REPEAT, 2000}
+};
+
+// a glitch shorter than the debounce is no press at all
+static const Segment glitch[] = {{false, 50}, {true, 10}, {false, 100}};
+
+static const struct{
+  const char *name;
+  const GestureConfig *config;
+  const Segment *segments;
+  uint8_t segmentCount;
+  const Gesture *expected;
+  uint8_t expectedCount;
+}scripts[] = {
+  {"bouncy short press", &longPress, bouncyShort, COUNT(bouncyShort), bouncyShortOut, COUNT(bouncyShortOut)},
+  {"long press", &longPress, held, COUNT(held), heldOut, COUNT(heldOut)},
+  {"double press", &doublePress, twice, COUNT(twice), twiceOut, COUNT(twiceOut)},
+  {"single press, double armed", &doublePress, once, COUNT(once), onceOut, COUNT(onceOut)},
+  {"two quick presses, long armed", &longPress, twice, COUNT(twice), twiceQuickOut, COUNT(twiceQuickOut)},
+  {"two slow presses", &doublePress, twiceSlow, COUNT(twiceSlow), twiceSlowOut, COUNT(twiceSlowOut)},
+  {"hold to scroll", &repeat, scroll, COUNT(scroll), scrollOut, COUNT(scrollOut)},
+  {"hold to scroll fast", &repeat, scrollFast, COUNT(scrollFast), scrollFastOut, COUNT(scrollFastOut)},
+  {"glitch", &longPress, glitch, COUNT(glitch), NULL, 0},
+};
+
+static const char *gestureName(GestureType gesture){
+  static const char *names[] = {"none", "press", "long", "double", "repeat"};
+  return gesture < COUNT(names) ? names[gesture] : "?";
+}
+
+void runGestures(){
+  uint8_t passed = 0;
+  for(const auto &script : scripts){
+    ButtonGesture button;
+    buttonGestureInit(&button, script.config);
+    Gesture out[MAX_GESTURES];
+    uint8_t outCount = 0;
+
+    uint32_t nowMs = 0;
+    for(uint8_t i = 0; i < script.segmentCount; i++){
+      for(uint32_t end = nowMs + script.segments[i].ms; nowMs < end; nowMs += SAMPLE_PERIOD){
+        GestureType gesture = buttonGestureUpdate(&button, script.segments[i].pressed, nowMs);
+        if(gesture != GESTURE_NONE && outCount < MAX_GESTURES){
+          out[outCount++] = {gesture, nowMs};
+        }
+      }
+    }
+
+    bool same = outCount == script.expectedCount && buttonGestureIdle(&button);
+    for(uint8_t i = 0; same && i < outCount; i++){
+      same = out[i].gesture == script.expected[i].gesture && out[i].atMs == script.expected[i].atMs;
+    }
+    if(!same){
+      printf("  %s gave", script.name);
+      for(uint8_t i = 0; i < outCount; i++){
+        printf(" %s@%u", gestureName(out[i].gesture), out[i].atMs);
+      }
+      printf("%s\n", buttonGestureIdle(&button) ? "" : ", not idle after");
+    }
+    check(same, script.name);
+    passed += same;
+  }
+  printf("gestures  %u of %u scripted sequences as expected\n", passed, (unsigned)COUNT(scripts));
+}
@@ -0,0 +1,115 @@
+/*  The input event ring under concurrent producers: threads stand in for the button ISRs on both cores,
+ *  each pushing a numbered stream, while one consumer drains. Every producer's events have to come out
+ *  complete, once each and in its order, and the push and drop counters have to add up  */
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+#include <InputEvents.h>
+
+#include "Runner.h"
+
+#define PRODUCERS 4
+#define EVENTS_PER_PRODUCER 50000
+
+static InputEventRing ring;
+static std::atomic<bool> start(false);
+static std::atomic<uint8_t> finished(0);
+static uint32_t producerDrops[PRODUCERS];
+
+// retries a full ring like nothing on the watch does, so every number gets through
+static void produce(uint8_t producer){
+  while(!start.load()){
+    std::this_thread::yield();
+  }
+  for(uint32_t number = 0; number < EVENTS_PER_PRODUCER; number++){
+    InputEvent event = {number, producer, INPUT_EDGE_PRESS, 0};
+    while(!inputEventPush(&ring, &event)){
+      producerDrops[producer]++;
+      std::this_thread::yield();
+    }
+  }
+  finished.fetch_add(1);
+}
+
+static void runConcurrent(){
+  inputEventRingInit(&ring);
+  memset(producerDrops, 0, sizeof(producerDrops));
+  finished.store(0);
+  std::thread producers[PRODUCERS];
+  for(uint8_t i = 0; i < PRODUCERS; i++){
+    producers[i] = std::thread(produce, i);
+  }
+
+  uint32_t next[PRODUCERS] = {};
+  uint32_t outOfOrder = 0;
+  uint32_t foreign = 0;
+  uint32_t received = 0;
+  double begin = nowNs();
+  start.store(true);
+  // ends at the expected count, or once the producers are done and the ring is drained: a lost event
+  // fails the check instead of hanging the run
+  while(received < PRODUCERS * EVENTS_PER_PRODUCER){
+    InputEvent event;
+    bool producersDone = finished.load() == PRODUCERS;   // taken before the pop, nothing can follow a miss then
+    if(!inputEventPop(&ring, &event)){
+      if(producersDone){
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    received++;
+    if(event.button >= PRODUCERS || event.type != INPUT_EDGE_PRESS){
+      foreign++;
+      continue;
+    }
+    // a repeat, a gap or a swap all show up as a number other than the next one
+    outOfOrder += event.timestampUs != next[event.button];
+    next[event.button] = event.timestampUs + 1;
+  }
+  double ns = (nowNs() - begin) / received;
+  for(uint8_t i = 0; i < PRODUCERS; i++){
+    producers[i].join();
+  }
+
+  uint32_t drops = 0;
+  bool complete = true;
+  for(uint8_t i = 0; i < PRODUCERS; i++){
+    drops += producerDrops[i];
+    complete &= next[i] == EVENTS_PER_PRODUCER;
+  }
+  InputEvent leftover;
+  bool empty = !inputEventPop(&ring, &leftover);
+
+  printf("ring      %u producers x %u events: %u out of order, %u full-ring retries, %.0f ns/event\n", PRODUCERS,
+         EVENTS_PER_PRODUCER, outOfOrder, drops, ns);
+  check(outOfOrder == 0 && foreign == 0 && complete && empty, "every producer's events once each, in order");
+  check(ring.pushed.load() == PRODUCERS * EVENTS_PER_PRODUCER && ring.dropped.load() == drops, "ring counters");
+}
+
+// a full ring refuses the newest events and keeps the oldest ones intact
+static void runOverflow(){
+  inputEventRingInit(&ring);
+  uint32_t accepted = 0;
+  for(uint32_t number = 0; number < INPUT_EVENT_RING_SIZE + 8; number++){
+    InputEvent event = {number, 0, INPUT_EDGE_RELEASE, 0};
+    accepted += inputEventPush(&ring, &event);
+  }
+  uint32_t popped = 0;
+  bool ordered = true;
+  InputEvent event;
+  while(inputEventPop(&ring, &event)){
+    ordered &= event.timestampUs == popped;
+    popped++;
+  }
+  check(accepted == INPUT_EVENT_RING_SIZE && popped == INPUT_EVENT_RING_SIZE && ordered && ring.dropped.load() == 8,
+        "full ring drops the newest");
+}
+
+void runInputEvents(){
+  runOverflow();
+  runConcurrent();
+}
@@ -0,0 +1,154 @@
+/*  Sampling jitter with the log ring and with LOG_DIRECT, the host side of readMPU's period stats.
+ *  A 10 ms loop runs the step and beat pipelines and logs what the tasks used to print per sample, two
+ *  stack lines and three pulse lines, into a model of the 115200 baud UART. That is more than the UART
+ *  carries. LOG_DIRECT formats and writes in the loop, so a full FIFO blocks the sampling. Through the
+ *  ring the loop only stores the record and a drain thread, like the drain task, writes the lines.
+ *  The wake-to-wake periods of both are printed, the ring's have to stay on the 10 ms  */
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <Log.h>
+#include <SensorPipelines.h>
+
+#include "Runner.h"
+
+#define SAMPLE_PERIOD 10            // ms, readMPU's, slept after each sample like its vTaskDelay
+#define LOG_SAMPLES 100
+#define LINES_PER_SAMPLE 5
+#define REPLAY_SAMPLES 64
+#define UART_BYTES_PER_S 11520      // 115200 baud, 10 bits a byte
+#define UART_FIFO 128               // bytes the ESP32 UART takes before a write blocks
+#define RING_TOLERANCE_US 1000      // the ring's 95th percentile period may exceed SAMPLE_PERIOD by this
+
+/*  Serial.write() without a TX buffer: returns once what is left of the line fits in the FIFO  */
+class UartModel{
+public:
+  void write(size_t length){
+    double now = nowNs();
+    emptyAtNs = std::max(emptyAtNs, now) + length * 1e9 / UART_BYTES_PER_S;
+    double fitsAtNs = emptyAtNs - UART_FIFO * 1e9 / UART_BYTES_PER_S;
+    if(fitsAtNs > now){
+      std::this_thread::sleep_for(std::chrono::nanoseconds((int64_t)(fitsAtNs - now)));
+    }
+  }
+
+private:
+  double emptyAtNs = 0;     // when the FIFO will have sent everything written so far
+};
+
+typedef struct{
+  double avgUs;
+  double minUs;
+  double p95Us;
+  double maxUs;
+}Periods;
+
+static UartModel uart;
+static std::atomic<bool> draining(false);
+
+static void writeLine(const LogRecord *record){
+  char line[LOG_LINE_MAX];
+  uart.write(logFormat(record, line, sizeof(line)));
+}
+
+// what logWrite() does in either build, both in one binary
+template<typename... Args>
+static void logLine(bool direct, const char *tag, const char *format, Args... args){
+  if(direct){
+    LogRecord record;
+    logFill(&record, LOG_LEVEL_VERBOSE, tag, format, args...);
+    writeLine(&record);
+    return;
+  }
+  uint32_t position;
+  LogRecord *record = logClaim(&position);
+  if(record != NULL){
+    logFill(record, LOG_LEVEL_VERBOSE, tag, format, args...);
+    logCommit(position);
+  }
+}
+
+// the drain task, it stops with what is left in the ring
+static void drain(){
+  LogRecord record;
+  while(draining.load()){
+    if(logNext(&record)){
+      writeLine(&record);
+    }else{
+      std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_PERIOD));
+    }
+  }
+}
+
+static Periods sampleLoop(bool direct){
+  static int16_t accelSamples[REPLAY_SAMPLES][3];
+  static uint16_t pulseSamples[REPLAY_SAMPLES];
+  uint32_t seed = 7;
+  for(uint8_t i = 0; i < REPLAY_SAMPLES; i++){
+    accelSamples[i][0] = noise(&seed) * 2000;
+    accelSamples[i][1] = noise(&seed) * 2000;
+    accelSamples[i][2] = MPU6050_ACCEL_LSB_PER_G + noise(&seed) * 4000;
+    pulseSamples[i] = 2048 + noise(&seed) * 800;
+  }
+
+  const StepDetectorConfig stepConfig = STEP_DETECTOR_DEFAULTS;
+  const BeatDetectorConfig beatConfig = BEAT_DETECTOR_DEFAULTS;
+  ReplayAccelDriver accel(accelSamples, REPLAY_SAMPLES);
+  ReplayPulseDriver pulse(pulseSamples, REPLAY_SAMPLES);
+  StepPipeline<ReplayAccelDriver> steps(accel, &stepConfig);
+  BeatPipeline<ReplayPulseDriver> beats(pulse, &beatConfig);
+
+  double periods[LOG_SAMPLES];
+  double lastWakeNs = 0;
+  for(uint32_t i = 0; i <= LOG_SAMPLES; i++){
+    double wakeNs = nowNs();
+    if(i > 0){
+      periods[i - 1] = (wakeNs - lastWakeNs) / 1000;
+    }
+    lastWakeNs = wakeNs;
+
+    uint32_t nowMs = i * SAMPLE_PERIOD;
+    steps.sample(nowMs);
+    beats.sample(nowMs);
+    logLine(direct, "MPU", "free stack %u B", 1412);
+    logLine(direct, "Steps", "free stack %u B", 1688);
+    logLine(direct, "Pulse", "raw signal %u", beats.signal);
+    logLine(direct, "Pulse", "BPM %u", beats.detector.bpm);
+    logLine(direct, "Pulse", "raw %u | BPM %u", beats.signal, beats.detector.bpm);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(SAMPLE_PERIOD));
+  }
+
+  std::sort(periods, periods + LOG_SAMPLES);
+  Periods result = {0, periods[0], periods[LOG_SAMPLES * 95 / 100], periods[LOG_SAMPLES - 1]};
+  for(uint32_t i = 0; i < LOG_SAMPLES; i++){
+    result.avgUs += periods[i] / LOG_SAMPLES;
+  }
+  return result;
+}
+
+void runLog(){
+  Periods direct = sampleLoop(true);
+
+  uart = UartModel();
+  logRingInit();
+  draining.store(true);
+  std::thread drainer(drain);
+  Periods ring = sampleLoop(false);
+  draining.store(false);
+  drainer.join();
+
+  LogStats stats;
+  logGetStats(&stats);
+  printf("log       direct period avg %.0f us | min %.0f | p95 %.0f | max %.0f\n", direct.avgUs, direct.minUs,
+         direct.p95Us, direct.maxUs);
+  printf("log       ring   period avg %.0f us | min %.0f | p95 %.0f | max %.0f, %u lines written, %u dropped\n",
+         ring.avgUs, ring.minUs, ring.p95Us, ring.maxUs, (unsigned)stats.written, (unsigned)stats.dropped);
+  check(stats.written + stats.dropped == (LOG_SAMPLES + 1) * LINES_PER_SAMPLE, "every ring line written or counted as dropped");
+  check(ring.p95Us <= SAMPLE_PERIOD * 1000 + RING_TOLERANCE_US, "ring keeps the sample period");
+  check(ring.avgUs < direct.avgUs, "ring samples closer to the period than direct writes");
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include <stdint.h>
+
+/*  Shared by the native runner's checks, see main.cpp  */
+
+/*  Counts a failure and prints what failed when ok is false  */
+void check(bool ok, const char *what);
+
+double nowNs();
+
+/*  Deterministic noise in [-1, 1]  */
+float noise(uint32_t *state);
+
+/*  Deterministic integer in [0, bound)  */
+uint32_t randomBelow(uint32_t *state, uint32_t bound);
+
+void runFrameDiff();
+void runInputEvents();
+void runGestures();
+void runSeries();
+void runTelemetry();
+void runLog();
+
+#endif
@@ -0,0 +1,202 @@
+/*  The flash history over simulated weeks and months of the firmware's sampling: steps once a minute
+ *  while walking, BPM every 5 s during pulse sessions, temperature and humidity once a minute, with a
+ *  reboot half way. The files live in a temporary directory, stdio like LittleFS's VFS on the watch.
+ *  Every sample the ring still holds has to read back bit for bit, and the ring has to hold all of them
+ *  until it wrapped. Prints bytes per sample, append time and 1-day range query time  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <SeriesStore.h>
+
+#include "Runner.h"
+
+#define SERIES 4
+#define MAX_DAYS 90
+#define MAX_SAMPLES (MAX_DAYS * 1440)   // a sample a minute, BPM sessions stay below that too
+#define START 1700000000                // SERIES_VALID_TIME
+#define DAY 86400
+#define QUERIES 200
+
+enum{
+  STEPS,
+  BPM,
+  TEMPERATURE,
+  HUMIDITY
+};
+
+static const SeriesConfig configs[SERIES] = {
+  {"steps", SERIES_INT},
+  {"bpm",   SERIES_INT},
+  {"temp",  SERIES_FLOAT},
+  {"rh",    SERIES_FLOAT}
+};
+
+static SeriesSample expected[SERIES][MAX_SAMPLES];
+static uint32_t expectedCount[SERIES];
+static SeriesSample readBack[MAX_SAMPLES];
+
+typedef struct{
+  SeriesSample *samples;
+  uint32_t count;
+}Collector;
+
+static bool collect(const SeriesSample *sample, void *context){
+  Collector *collector = (Collector *)context;
+  if(collector->count < MAX_SAMPLES){
+    collector->samples[collector->count] = *sample;
+  }
+  collector->count++;
+  return true;
+}
+
+static double appendNs;
+static uint32_t appends;
+
+static void append(SeriesStore *store, uint8_t series, uint32_t timestamp, SeriesValue value, uint32_t nowMs){
+  double start = nowNs();
+  bool appended = seriesStoreAppend(store, series, timestamp, value, nowMs);
+  appendNs += nowNs() - start;
+  appends++;
+  if(appended && expectedCount[series] < MAX_SAMPLES){
+    expected[series][expectedCount[series]++] = {timestamp, value};
+  }
+}
+
+// a DHT22 reading, 0.1 resolution
+static SeriesValue reading(float value){
+  SeriesValue sample;
+  sample.f = roundf(value * 10) / 10;
+  return sample;
+}
+
+static bool inPulseSession(uint32_t secondOfDay){
+  return (secondOfDay >= 7 * 3600 && secondOfDay < 7 * 3600 + 1800) ||
+         (secondOfDay >= 13 * 3600 && secondOfDay < 13 * 3600 + 1800) ||
+         (secondOfDay >= 20 * 3600 && secondOfDay < 20 * 3600 + 1800);
+}
+
+static bool simulate(SeriesStore *store, const char *directory, uint32_t days, uint32_t *seed){
+  memset(expectedCount, 0, sizeof(expectedCount));
+  appendNs = 0;
+  appends = 0;
+  int32_t steps = 0;
+  int32_t lastRecordedSteps = 0;
+  int32_t bpm = 72;
+
+  for(uint32_t elapsed = 0; elapsed < days * DAY; elapsed += 5){
+    uint32_t now = START + elapsed;
+    uint32_t nowMs = elapsed * 1000;
+    uint32_t secondOfDay = elapsed % DAY;
+
+    if(elapsed == days * DAY / 2){
+      // a reboot: the store is closed, reopened from the block headers and carries on
+      seriesStoreClose(store);
+      if(!seriesStoreOpen(store, directory, configs, SERIES)){
+        return false;
+      }
+    }
+
+    if(secondOfDay >= 8 * 3600 && secondOfDay < 22 * 3600 && randomBelow(seed, 20) == 0){
+      steps += randomBelow(seed, 12);   // now and then a few steps while awake
+    }
+    if(inPulseSession(secondOfDay)){
+      bpm += (int32_t)randomBelow(seed, 5) - 2;
+      bpm = bpm < 55 ? 55 : bpm > 120 ? 120 : bpm;
+      SeriesValue value;
+      value.i = bpm;
+      append(store, BPM, now, value, nowMs);
+    }
+
+    if(elapsed % 60 == 0){
+      if(steps != lastRecordedSteps){
+        SeriesValue value;
+        value.i = lastRecordedSteps = steps;
+        append(store, STEPS, now, value, nowMs);
+      }
+      float daily = sinf(secondOfDay * 2 * (float)M_PI / DAY);
+      append(store, TEMPERATURE, now, reading(23 + 2 * daily + 0.3f * noise(seed)), nowMs);
+      append(store, HUMIDITY, now, reading(50 - 8 * daily + 1.5f * noise(seed)), nowMs);
+      seriesStoreTick(store, nowMs);
+    }
+  }
+  return true;
+}
+
+// the first expected sample at or after timestamp
+static uint32_t lowerBound(uint8_t series, uint32_t timestamp){
+  uint32_t low = 0, high = expectedCount[series];
+  while(low < high){
+    uint32_t middle = low + (high - low) / 2;
+    if(expected[series][middle].timestamp < timestamp){
+      low = middle + 1;
+    }else{
+      high = middle;
+    }
+  }
+  return low;
+}
+
+static void runDays(uint32_t days, uint32_t seed){
+  char directory[] = "/tmp/seriesXXXXXX";
+  if(mkdtemp(directory) == NULL){
+    check(false, "series temporary directory");
+    return;
+  }
+
+  static SeriesStore store;
+  bool ok = seriesStoreOpen(&store, directory, configs, SERIES) && simulate(&store, directory, days, &seed);
+  check(ok, "series store open");
+
+  printf("series    %2u days, %.2f us/append:", days, appendNs / appends / 1000);
+  double queryUs = 0;
+  uint32_t queries = 0;
+  for(uint8_t series = 0; ok && series < SERIES; series++){
+    // everything still in the ring, which is a suffix of what was appended
+    Collector collector = {readBack, 0};
+    seriesStoreQuery(&store, series, 0, UINT32_MAX, collect, &collector);
+    uint32_t count = expectedCount[series];
+    uint32_t first = count - (collector.count <= count ? collector.count : count);
+    uint32_t mismatches = collector.count > count ? 1 : 0;
+    for(uint32_t i = 0; i < collector.count && i < count; i++){
+      mismatches += readBack[i].timestamp != expected[series][first + i].timestamp ||
+                    readBack[i].value.bits != expected[series][first + i].value.bits;
+    }
+    uint32_t blocks = seriesStoreBlocks(&store, series);
+    bool wrapped = blocks >= SERIES_STORE_BLOCKS;
+    double bytesPerSample = (double)blocks * SERIES_BLOCK_SIZE / collector.count;
+    printf(" %s %.2f B/sample (%.0fx, %u of %u kept)", configs[series].name, bytesPerSample,
+           sizeof(SeriesSample) / bytesPerSample, collector.count, count);
+    check(mismatches == 0, "series read back bit for bit");
+    check(wrapped || collector.count == count, "series keeps everything until the ring wraps");
+
+    // 1-day ranges across what is kept, counted against the expected samples
+    for(uint32_t i = 0; collector.count > 1 && i < QUERIES / SERIES; i++){
+      uint32_t from = readBack[0].timestamp + randomBelow(&seed, readBack[collector.count - 1].timestamp - readBack[0].timestamp);
+      Collector range = {readBack, 0};
+      double start = nowNs();
+      seriesStoreQuery(&store, series, from, from + DAY, collect, &range);
+      queryUs += (nowNs() - start) / 1000;
+      queries++;
+      uint32_t to = from + DAY < from ? UINT32_MAX : from + DAY;
+      check(range.count == lowerBound(series, to + 1) - lowerBound(series, from), "series 1-day range count");
+    }
+  }
+  printf(", %.0f us/1-day query\n", queries ? queryUs / queries : 0);
+
+  seriesStoreClose(&store);
+  for(uint8_t series = 0; series < SERIES; series++){
+    char path[SERIES_STORE_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s.ts", directory, configs[series].name);
+    unlink(path);
+  }
+  rmdir(directory);
+}
+
+void runSeries(){
+  runDays(7, 11);
+  runDays(90, 13);
+}
@@ -0,0 +1,233 @@
+/*  The /api/state payload: telemetryToJson() into the TELEMETRY_JSON_MAX_LENGTH buffer the dashboard
+ *  serves it from. Checks the exact document for fields not produced yet, for every field, and for a
+ *  description that needs escaping, that any snapshot fits, that a short buffer gives an empty document
+ *  and never a cut one, and that random snapshots are always valid JSON with the same keys in order  */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <Telemetry.h>
+
+#include "Runner.h"
+
+/*  Minimal strict JSON reader, just enough to tell valid from invalid. Object keys are appended to
+ *  `keys` separated by commas, so the shape can be compared too  */
+typedef struct{
+  const char *at;
+  char keys[256];
+}JsonCursor;
+
+static bool parseValue(JsonCursor *cursor);
+
+static bool parseString(JsonCursor *cursor, char *copy, size_t copySize){
+  if(*cursor->at++ != '"'){
+    return false;
+  }
+  size_t length = 0;
+  for(;;){
+    unsigned char c = *cursor->at++;
+    if(c == '"'){
+      break;
+    }
+    if(c < 0x20){
+      return false;     // raw control characters have to be escaped
+    }
+    if(c == '\\'){
+      c = *cursor->at++;
+      if(c == 'u'){
+        for(uint8_t i = 0; i < 4; i++, cursor->at++){
+          if(!isxdigit((unsigned char)*cursor->at)){
+            return false;
+          }
+        }
+      }else if(strchr("\"\\/bfnrt", c) == NULL || c == '\0'){
+        return false;
+      }
+    }
+    if(copy != NULL && length + 1 < copySize){
+      copy[length++] = c;
+    }
+  }
+  if(copy != NULL){
+    copy[length] = '\0';
+  }
+  return true;
+}
+
+static bool parseNumber(JsonCursor *cursor){
+  const char *start = cursor->at;
+  if(*cursor->at == '-'){
+    cursor->at++;
+  }
+  if(!isdigit((unsigned char)*cursor->at)){
+    return false;
+  }
+  if(*cursor->at == '0' && isdigit((unsigned char)cursor->at[1])){
+    return false;
+  }
+  while(isdigit((unsigned char)*cursor->at)){
+    cursor->at++;
+  }
+  if(*cursor->at == '.'){
+    cursor->at++;
+    if(!isdigit((unsigned char)*cursor->at)){
+      return false;
+    }
+    while(isdigit((unsigned char)*cursor->at)){
+      cursor->at++;
+    }
+  }
+  return cursor->at > start;
+}
+
+static bool parseObject(JsonCursor *cursor){
+  cursor->at++;
+  if(*cursor->at == '}'){
+    cursor->at++;
+    return true;
+  }
+  for(;;){
+    char key[32];
+    if(!parseString(cursor, key, sizeof(key)) || *cursor->at++ != ':'){
+      return false;
+    }
+    strncat(cursor->keys, key, sizeof(cursor->keys) - strlen(cursor->keys) - 2);
+    strcat(cursor->keys, ",");
+    if(!parseValue(cursor)){
+      return false;
+    }
+    char c = *cursor->at++;
+    if(c == '}'){
+      return true;
+    }
+    if(c != ','){
+      return false;
+    }
+  }
+}
+
+static bool parseValue(JsonCursor *cursor){
+  switch(*cursor->at){
+  case '{':
+    return parseObject(cursor);
+  case '"':
+    return parseString(cursor, NULL, 0);
+  case 'n':
+    return strncmp(cursor->at, "null", 4) == 0 && (cursor->at += 4);
+  default:
+    return parseNumber(cursor);
+  }
+}
+
+// valid JSON with nothing after the document, its keys in `keys`
+static bool jsonValid(const char *json, char *keys, size_t keysSize){
+  JsonCursor cursor;
+  cursor.at = json;
+  cursor.keys[0] = '\0';
+  bool valid = *json == '{' && parseValue(&cursor) && *cursor.at == '\0';
+  snprintf(keys, keysSize, "%s", cursor.keys);
+  return valid;
+}
+
+static void expectJson(const TelemetrySnapshot *snapshot, const char *expected, const char *what){
+  char json[TELEMETRY_JSON_MAX_LENGTH];
+  size_t length = telemetryToJson(snapshot, json, sizeof(json));
+  bool same = length == strlen(expected) && strcmp(json, expected) == 0;
+  if(!same){
+    printf("  %s gave %s\n", what, json);
+  }
+  check(same, what);
+}
+
+static const char *allKeys = "seq,uptime,steps,bpm,temp,rh,weather,feels,rh,wind,desc,";
+static const char *nullKeys = "seq,uptime,steps,bpm,temp,rh,weather,";
+
+void runTelemetry(){
+  TelemetrySnapshot snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.sequence = 7;
+  snapshot.uptimeS = 42;
+  expectJson(&snapshot, "{\"seq\":7,\"uptime\":42,\"steps\":null,\"bpm\":null,\"temp\":null,\"rh\":null,\"weather\":null}",
+             "nothing produced yet is null");
+
+  snapshot.valid = TELEMETRY_VALID_STEPS | TELEMETRY_VALID_PULSE | TELEMETRY_VALID_ENV | TELEMETRY_VALID_WEATHER;
+  snapshot.steps = 1234;
+  snapshot.bpm = 72;
+  snapshot.temperature = 23.46f;
+  snapshot.humidity = 51.2f;
+  snapshot.weatherFeelsLike = 29.16f;
+  snapshot.weatherHumidity = 51;
+  snapshot.windSpeed = 4.63f;
+  strcpy(snapshot.weatherDescription, "broken clouds");
+  expectJson(&snapshot, "{\"seq\":7,\"uptime\":42,\"steps\":1234,\"bpm\":72,\"temp\":23.5,\"rh\":51,"
+             "\"weather\":{\"feels\":29.2,\"rh\":51,\"wind\":4.6,\"desc\":\"broken clouds\"}}", "every field");
+
+  strcpy(snapshot.weatherDescription, "a \"b\" c\\d\n\t\x01");
+  expectJson(&snapshot, "{\"seq\":7,\"uptime\":42,\"steps\":1234,\"bpm\":72,\"temp\":23.5,\"rh\":51,"
+             "\"weather\":{\"feels\":29.2,\"rh\":51,\"wind\":4.6,\"desc\":\"a \\\"b\\\" c\\\\d\\u000a\\u0009\\u0001\"}}",
+             "description escaped");
+
+  snapshot.temperature = NAN;
+  snapshot.humidity = INFINITY;
+  snapshot.windSpeed = 3e30f;
+  strcpy(snapshot.weatherDescription, "");
+  expectJson(&snapshot, "{\"seq\":7,\"uptime\":42,\"steps\":1234,\"bpm\":72,\"temp\":null,\"rh\":null,"
+             "\"weather\":{\"feels\":29.2,\"rh\":51,\"wind\":null,\"desc\":\"\"}}", "garbage readings are null");
+
+  // the longest document there is: every number at its longest, the description all escapes
+  TelemetrySnapshot longest;
+  memset(&longest, 0, sizeof(longest));
+  longest.sequence = UINT32_MAX;
+  longest.uptimeS = UINT32_MAX;
+  longest.valid = snapshot.valid;
+  longest.steps = INT32_MIN;
+  longest.bpm = UINT16_MAX;
+  longest.temperature = longest.humidity = longest.weatherFeelsLike = longest.weatherHumidity = longest.windSpeed =
+    -999999999.9f;
+  memset(longest.weatherDescription, '\x1f', sizeof(longest.weatherDescription) - 1);
+  char json[TELEMETRY_JSON_MAX_LENGTH];
+  char keys[256];
+  size_t longestLength = telemetryToJson(&longest, json, sizeof(json));
+  check(longestLength > 0 && jsonValid(json, keys, sizeof(keys)) && strcmp(keys, allKeys) == 0,
+        "longest snapshot fits TELEMETRY_JSON_MAX_LENGTH");
+
+  // too small a buffer gives an empty document, never a cut one
+  uint32_t cut = 0;
+  for(size_t size = 1; size <= longestLength; size++){
+    char small[TELEMETRY_JSON_MAX_LENGTH];
+    memset(small, 'x', sizeof(small));
+    cut += telemetryToJson(&longest, small, size) != 0 || small[0] != '\0';
+  }
+  check(cut == 0 && telemetryToJson(&longest, json, 0) == 0, "short buffer gives an empty document");
+
+  // random snapshots, random validity, printable and control characters, odd floats
+  uint32_t seed = 5;
+  uint32_t invalid = 0;
+  const float odd[] = {NAN, INFINITY, -INFINITY, 1e20f, -0.0f, 1e-20f};
+  for(uint32_t i = 0; i < 20000; i++){
+    TelemetrySnapshot random;
+    memset(&random, 0, sizeof(random));
+    random.sequence = seed;
+    random.valid = randomBelow(&seed, 16);
+    random.steps = (int32_t)(seed * 2654435761u);
+    random.bpm = randomBelow(&seed, 65536);
+    float *floats[] = {&random.temperature, &random.humidity, &random.weatherFeelsLike, &random.weatherHumidity,
+                       &random.windSpeed};
+    for(float *value : floats){
+      *value = randomBelow(&seed, 8) == 0 ? odd[randomBelow(&seed, 6)] : 200 * noise(&seed);
+    }
+    uint8_t length = randomBelow(&seed, sizeof(random.weatherDescription));
+    for(uint8_t c = 0; c < length; c++){
+      random.weatherDescription[c] = 1 + randomBelow(&seed, 127);
+    }
+    size_t written = telemetryToJson(&random, json, sizeof(json));
+    bool valid = written > 0 && jsonValid(json, keys, sizeof(keys));
+    const char *expectedKeys = (random.valid & TELEMETRY_VALID_WEATHER) ? allKeys : nullKeys;
+    invalid += !valid || strcmp(keys, expectedKeys) != 0;
+  }
+  printf("telemetry /api/state %u B at most (buffer %u), 20000 random snapshots: %u not valid JSON of the shape\n",
+         (unsigned)longestLength, TELEMETRY_JSON_MAX_LENGTH, invalid);
+  check(invalid == 0, "random snapshots are valid JSON");
+}
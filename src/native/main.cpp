@@ -0,0 +1,592 @@
+/*  Host build of the watch's sensor, algorithm and screen code against the fakes in lib/Hal:
+ *
+ *    pio run -e native && .pio/build/native/program [--record] [reference directory]
+ *
+ *  Replays synthetic input through the accelerometer read and step detector, the beat detector,
+ *  the time formatting, the weather parser and every screen. The screens are drawn by U8g2 itself
+ *  and compared pixel for pixel against the PBMs in src/native/screens, the same format as the
+ *  firmware's 'p' dump. --record writes those, first and after an intended change to a screen; a
+ *  screen with none yet is reported as not recorded instead of failing. The other
+ *  files here check libraries with no hardware below them:
+ *
+ *    FrameDiffCheck.cpp      emitted areas applied to a panel model over random frames
+ *    InputEventsCheck.cpp    the button event ring under concurrent producer threads
+ *    GesturesCheck.cpp       press, long, double and repeat timing from scripted press sequences
+ *    SeriesCheck.cpp         the flash history over simulated 7 and 90 days, read back and timed
+ *    TelemetryCheck.cpp      the /api/state JSON: nulls, escaping, truncation and shape
+ *    LogCheck.cpp            sampling jitter with the log ring against LOG_DIRECT, into a modelled UART
+ *
+ *  Prints what came out and the cost per call, and exits non-zero when a result is off  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <sys/stat.h>
+
+#include <HalFake.h>
+#include <AccelSensor.h>
+#include <SensorPipelines.h>
+#include <StepDetector.h>
+#include <BeatDetector.h>
+#include <TimeFormat.h>
+#include <WeatherParse.h>
+#include <Screens.h>
+#include <StepHistory.h>
+#include <HealthSnapshot.h>
+#include <FrameDiff.h>
+
+#include "Runner.h"
+
+#define MPU_PERIOD 10             // ms, readMPU's period
+#define PULSE_PERIOD 10           // ms, readPulseSensor's period on the pulse screen
+#define WALK_SECONDS 60
+#define WALK_STEP_PERIOD 500      // ms, 2 steps/s
+#define PULSE_SECONDS 30
+#define PULSE_BPM 72
+#define REPEATS 1000              // calls per timed measurement of the cheap stages
+#define DRIVER_PASSES 10          // passes over the replay buffers per timed run
+#define DRIVER_RUNS 21            // timed runs per driver path, the fastest one is printed
+#define DRIVER_TOLERANCE 0.25     // the template may cost this much of the direct loop's time more,
+#define DRIVER_TOLERANCE_NS 2.0   // or this many ns per sample if that is more, the timer's noise on cheap loops
+#define REFERENCE_DIRECTORY "src/native/screens"   // relative to the project, where pio runs it from
+
+/*  Trimmed OpenWeather current weather response  */
+static const char *weatherResponse =
+  "{\"coord\":{\"lon\":31,\"lat\":30.79},\"weather\":[{\"id\":803,\"main\":\"Clouds\","
+  "\"description\":\"broken clouds\",\"icon\":\"04d\"}],\"base\":\"stations\",\"main\":{\"temp\":301.2,"
+  "\"feels_like\":302.41,\"temp_min\":301.2,\"temp_max\":301.2,\"pressure\":1012,\"humidity\":51,"
+  "\"sea_level\":1012,\"grnd_level\":1010},\"visibility\":10000,\"wind\":{\"speed\":4.63,\"deg\":345,"
+  "\"gust\":5.1},\"clouds\":{\"all\":75},\"dt\":1719924000,\"sys\":{\"country\":\"EG\"},\"timezone\":10800,"
+  "\"id\":347497,\"name\":\"Tanta\",\"cod\":200}";
+
+static uint8_t failures = 0;
+
+void check(bool ok, const char *what){
+  if(!ok){
+    printf("  FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+double nowNs(){
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+float noise(uint32_t *state){
+  *state = *state * 1664525 + 1013904223;
+  return (int32_t)*state / 2147483648.0f;
+}
+
+uint32_t randomBelow(uint32_t *state, uint32_t bound){
+  *state = *state * 1664525 + 1013904223;
+  return (uint32_t)(((uint64_t)(*state >> 8) * bound) >> 24);
+}
+
+static void putAccel(FakeI2c *i2c, const int16_t raw[3]){
+  for(uint8_t axis = 0; axis < 3; axis++){
+    i2c->registers[MPU6050_ACCEL_XOUT_H + axis * 2] = (uint16_t)raw[axis] >> 8;
+    i2c->registers[MPU6050_ACCEL_XOUT_H + axis * 2 + 1] = raw[axis] & 0xFF;
+  }
+}
+
+// 1 g at rest on z, each step a 100 ms half sine of 2 g
+static void walkSample(uint32_t t, uint32_t *seed, int16_t raw[3]){
+  uint32_t phase = t % WALK_STEP_PERIOD;
+  float z = 1.0f + (phase < 100 ? 2.0f * sinf(phase * (float)M_PI / 100) : 0) + 0.05f * noise(seed);
+  raw[0] = (int16_t)(0.05f * noise(seed) * MPU6050_ACCEL_LSB_PER_G);
+  raw[1] = (int16_t)(0.05f * noise(seed) * MPU6050_ACCEL_LSB_PER_G);
+  raw[2] = (int16_t)(z * MPU6050_ACCEL_LSB_PER_G);
+}
+
+static void runSteps(){
+  FakeClock clock;
+  FakeI2c i2c(MPU6050_ADDRESS);
+  const StepDetectorConfig config = STEP_DETECTOR_DEFAULTS;
+  StepDetector detector;
+  stepDetectorInit(&detector, &config);
+  uint32_t seed = 1;
+  uint32_t steps = 0;
+  uint32_t samples = 0;
+  double detectNs = 0;
+
+  for(uint32_t t = 0; t < WALK_SECONDS * 1000; t += MPU_PERIOD, clock.advanceMs(MPU_PERIOD)){
+    int16_t raw[3];
+    walkSample(t, &seed, raw);
+    putAccel(&i2c, raw);
+
+    int16_t read[3];
+    if(!accelSensorRead(i2c, read)){
+      check(false, "accel read");
+      return;
+    }
+    float acceleration[3] = {read[0] / MPU6050_ACCEL_LSB_PER_G, read[1] / MPU6050_ACCEL_LSB_PER_G,
+                             read[2] / MPU6050_ACCEL_LSB_PER_G};
+
+    double start = nowNs();
+    steps += stepDetectorUpdate(&detector, acceleration, clock.millis());
+    detectNs += nowNs() - start;
+    samples++;
+  }
+
+  uint32_t expected = WALK_SECONDS * 1000 / WALK_STEP_PERIOD;
+  printf("steps     %u of %u over %u samples, %.0f ns/sample, %u I2C reads\n", steps, expected, samples,
+         detectNs / samples, i2c.transactions);
+  check(steps >= expected - 1 && steps <= expected, "step count");
+}
+
+typedef struct{
+  FakeClock *clock;
+  uint32_t periodMs;
+}PulseWave;
+
+// 1800 counts between beats, a 150 ms bump to 2800 on each
+static uint16_t pulseSignal(uint8_t, void *context){
+  PulseWave *wave = (PulseWave *)context;
+  uint32_t phase = wave->clock->millis() % wave->periodMs;
+  return phase < 150 ? 1800 + 1000 * sinf(phase * (float)M_PI / 150) : 1800;
+}
+
+static void runBeats(){
+  FakeClock clock;
+  FakeAdc adc;
+  PulseWave wave = {&clock, 60000 / PULSE_BPM};
+  adc.source = pulseSignal;
+  adc.context = &wave;
+  const BeatDetectorConfig config = BEAT_DETECTOR_DEFAULTS;
+  BeatDetector detector;
+  beatDetectorInit(&detector, &config);
+  uint32_t updates = 0;
+  double detectNs = 0;
+
+  // the first beat only sets the reference, start half a period in like a real finger would
+  clock.advanceMs(wave.periodMs / 2);
+  for(uint32_t t = 0; t < PULSE_SECONDS * 1000; t += PULSE_PERIOD, clock.advanceMs(PULSE_PERIOD)){
+    uint16_t signal = adc.read(33);
+    double start = nowNs();
+    updates += beatDetectorUpdate(&detector, signal, clock.millis());
+    detectNs += nowNs() - start;
+  }
+
+  printf("beats     %u bpm (%u), %u updates, %.0f ns/sample\n", detector.bpm, PULSE_BPM, updates,
+         detectNs / adc.reads);
+  check(abs((int)detector.bpm - PULSE_BPM) <= 2, "bpm");
+}
+
+static void runTimeFormat(){
+  char frames[TIME_FRAME_COUNT][TIME_FRAME_LENGTH];
+  double start = nowNs();
+  for(uint32_t i = 0; i < REPEATS; i++){
+    timeFormatFrames(frames, "09:41:07", "Sun, Jan 17 2021", true);
+  }
+  double ns = (nowNs() - start) / REPEATS;
+
+  printf("time      %.0f ns/call:", ns);
+  for(uint8_t i = 0; i < TIME_FRAME_COUNT; i++){
+    printf(" \"%s\"", frames[i]);
+  }
+  printf("\n");
+  check(strcmp(frames[TIME_FRAME_TIME], "09:41") == 0, "time frame");
+  check(strcmp(frames[TIME_FRAME_NO_MINUTES], "09:--") == 0, "no minutes frame");
+  check(strcmp(frames[TIME_FRAME_NO_HOURS], "--:41") == 0, "no hours frame");
+  check(strcmp(frames[TIME_FRAME_NO_DAY], "Sun, Jan -- 2021") == 0, "no day frame");
+  check(strcmp(frames[TIME_FRAME_NO_MONTH], "Sun, --- 17 2021") == 0, "no month frame");
+  check(strcmp(frames[TIME_FRAME_NO_YEAR], "Sun, Jan 17 ----") == 0, "no year frame");
+}
+
+static bool runWeather(WeatherReport *report){
+  FakeHttp http;
+  http.response = weatherResponse;
+  char body[1024];
+  size_t length;
+
+  int status = http.get("http://api.openweathermap.org/data/2.5/weather?q=Tanta,EG", body, sizeof(body), &length);
+  double start = nowNs();
+  bool parsed = false;
+  for(uint32_t i = 0; i < REPEATS; i++){
+    parsed = weatherParse(body, report);
+  }
+  double ns = (nowNs() - start) / REPEATS;
+
+  printf("weather   HTTP %d, %u B, %.0f ns/parse: \"%s\" feels %.2f K, %.0f %%, %.2f m/s\n", status, (unsigned)length,
+         ns, report->description, report->tempFeelLike, report->humidity, report->windSpeed);
+  check(parsed && strcmp(report->description, "broken clouds") == 0, "weather description");
+  check(fabsf(report->tempFeelLike - 302.41f) < 0.01f && report->humidity == 51 &&
+        fabsf(report->windSpeed - 4.63f) < 0.01f, "weather values");
+
+  WeatherReport missing;
+  check(!weatherParse("{\"cod\":401,\"message\":\"Invalid API key\"}", &missing), "error response rejected");
+
+  char url[96];
+  check(weatherUrl(url, sizeof(url), "Tanta", "EG", "0f3a") &&
+        strcmp(url, "http://api.openweathermap.org/data/2.5/weather?q=Tanta,EG&APPID=0f3a") == 0, "weather url");
+  check(weatherUrl(url, sizeof(url), "New York&x=1", "US", "k") &&
+        strcmp(url, "http://api.openweathermap.org/data/2.5/weather?q=New%20York%26x%3D1,US&APPID=k") == 0,
+        "weather url encoded");
+  check(weatherUrl(url, sizeof(url), "S\xC3\xA3o Paulo", "BR", "k") &&
+        strcmp(url, "http://api.openweathermap.org/data/2.5/weather?q=S%C3%A3o%20Paulo,BR&APPID=k") == 0,
+        "weather url utf-8");
+  check(!weatherUrl(url, 60, "Tanta", "EG", "0f3a") && url[0] == '\0', "weather url too long");
+  return parsed;
+}
+
+/*  What the drivers replace: the same read through a virtual interface, as Hal.h does it  */
+class VirtualAccel{
+public:
+  virtual bool readRaw(int16_t raw[3]) = 0;
+};
+
+class VirtualPulse{
+public:
+  virtual uint16_t read() = 0;
+};
+
+class VirtualReplayAccel : public VirtualAccel{
+public:
+  explicit VirtualReplayAccel(ReplayAccelDriver &replay) : replay(replay){}
+  bool readRaw(int16_t raw[3]) override{ return replay.readRaw(raw); }
+  ReplayAccelDriver &replay;
+};
+
+class VirtualReplayPulse : public VirtualPulse{
+public:
+  explicit VirtualReplayPulse(ReplayPulseDriver &replay) : replay(replay){}
+  uint16_t read() override{ return replay.read(); }
+  ReplayPulseDriver &replay;
+};
+
+#define WALK_SAMPLES (WALK_SECONDS * 1000 / MPU_PERIOD)
+#define PULSE_SAMPLES (PULSE_SECONDS * 1000 / PULSE_PERIOD)
+
+static int16_t walkSamples[WALK_SAMPLES][3];
+static uint16_t pulseSamples[PULSE_SAMPLES];
+
+// volatile, so the compiler can't see which object the virtual calls go to and devirtualize them
+static VirtualAccel *volatile virtualAccel;
+static VirtualPulse *volatile virtualPulse;
+
+// the direct loops reach their drivers through globals, as the watch does. With a local one the compiler
+// proves the out-of-line detector call can't touch it and keeps its state in registers, which the
+// pipelines can't: their driver is reachable from the detector they pass. That, not the template, cost ~1 ns
+static ReplayAccelDriver *directAccel;
+static ReplayPulseDriver *directPulse;
+
+template<class Pass>
+static double nsPerSample(uint32_t samples, Pass &pass){
+  double start = nowNs();
+  pass();
+  return (nowNs() - start) / samples;
+}
+
+/*  ns per sample of the fastest of DRIVER_RUNS calls to each pass. The runs of the three take turns, so
+ *  a slow stretch of the host hits all of them and not just one. Returns the median over the runs of
+ *  template minus direct ns per sample, which a run slowed down on one side only can't move  */
+template<class Direct, class Templated, class Virtual>
+static double fastestNsPerSample(uint32_t samples, Direct direct, Templated templated, Virtual virtualRead, double ns[3]){
+  double overheads[DRIVER_RUNS];
+  for(uint8_t run = 0; run < DRIVER_RUNS; run++){
+    double runNs[3] = {nsPerSample(samples, direct), nsPerSample(samples, templated), nsPerSample(samples, virtualRead)};
+    for(uint8_t path = 0; path < 3; path++){
+      ns[path] = run == 0 ? runNs[path] : fmin(ns[path], runNs[path]);
+    }
+    overheads[run] = runNs[1] - runNs[0];
+  }
+  std::sort(overheads, overheads + DRIVER_RUNS);
+  return overheads[DRIVER_RUNS / 2];
+}
+
+/*  The step and beat pipelines fed three ways: the replay driver and the detector called by hand
+ *  (direct), the templates on the replay drivers, and a virtual read. The counts have to match, the times show what
+ *  the driver layer costs, and a template slower than the direct loop by more than the tolerance fails  */
+static void runDrivers(){
+  uint32_t seed = 1;
+  for(uint32_t i = 0; i < WALK_SAMPLES; i++){
+    walkSample(i * MPU_PERIOD, &seed, walkSamples[i]);
+  }
+  FakeClock clock;
+  PulseWave wave = {&clock, 60000 / PULSE_BPM};
+  clock.advanceMs(wave.periodMs / 2);
+  for(uint32_t i = 0; i < PULSE_SAMPLES; i++, clock.advanceMs(PULSE_PERIOD)){
+    pulseSamples[i] = pulseSignal(33, &wave);
+  }
+
+  const StepDetectorConfig stepConfig = STEP_DETECTOR_DEFAULTS;
+  const BeatDetectorConfig beatConfig = BEAT_DETECTOR_DEFAULTS;
+  const uint32_t stepSamples = WALK_SAMPLES * DRIVER_PASSES;
+  const uint32_t beatSamples = PULSE_SAMPLES * DRIVER_PASSES;
+  uint32_t steps[3] = {0, 0, 0};
+  uint32_t beats[3] = {0, 0, 0};
+  double stepNs[3];
+  double beatNs[3];
+
+  ReplayAccelDriver directAccelReplay(walkSamples, WALK_SAMPLES);
+  directAccel = &directAccelReplay;
+  ReplayAccelDriver accel(walkSamples, WALK_SAMPLES);
+  ReplayAccelDriver virtualReplay(walkSamples, WALK_SAMPLES);
+  VirtualReplayAccel virtualDriver(virtualReplay);
+  virtualAccel = &virtualDriver;
+  ReplayPulseDriver directPulseReplay(pulseSamples, PULSE_SAMPLES);
+  directPulse = &directPulseReplay;
+  ReplayPulseDriver pulse(pulseSamples, PULSE_SAMPLES);
+  ReplayPulseDriver virtualPulseReplay(pulseSamples, PULSE_SAMPLES);
+  VirtualReplayPulse virtualPulseDriver(virtualPulseReplay);
+  virtualPulse = &virtualPulseDriver;
+
+  // every pass starts a fresh detector, the replay drivers are back at the start of their buffer by then
+  double stepOverhead = fastestNsPerSample(stepSamples, [&]{
+    StepDetector direct;
+    stepDetectorInit(&direct, &stepConfig);
+    steps[0] = 0;
+    for(uint32_t i = 0; i < stepSamples; i++){
+      int16_t raw[3];
+      if(directAccel->readRaw(raw)){
+        float acceleration[3] = {raw[0] / MPU6050_ACCEL_LSB_PER_G, raw[1] / MPU6050_ACCEL_LSB_PER_G,
+                                 raw[2] / MPU6050_ACCEL_LSB_PER_G};
+        steps[0] += stepDetectorUpdate(&direct, acceleration, i * MPU_PERIOD);
+      }
+    }
+  }, [&]{
+    StepPipeline<ReplayAccelDriver> templated(accel, &stepConfig);
+    steps[1] = 0;
+    for(uint32_t i = 0; i < stepSamples; i++){
+      steps[1] += templated.sample(i * MPU_PERIOD) == STEP_SAMPLE_STEP;
+    }
+  }, [&]{
+    StepDetector dynamic;
+    stepDetectorInit(&dynamic, &stepConfig);
+    steps[2] = 0;
+    for(uint32_t i = 0; i < stepSamples; i++){
+      int16_t raw[3];
+      if(virtualAccel->readRaw(raw)){
+        float acceleration[3] = {raw[0] / MPU6050_ACCEL_LSB_PER_G, raw[1] / MPU6050_ACCEL_LSB_PER_G,
+                                 raw[2] / MPU6050_ACCEL_LSB_PER_G};
+        steps[2] += stepDetectorUpdate(&dynamic, acceleration, i * MPU_PERIOD);
+      }
+    }
+  }, stepNs);
+
+  double beatOverhead = fastestNsPerSample(beatSamples, [&]{
+    BeatDetector directBeat;
+    beatDetectorInit(&directBeat, &beatConfig);
+    beats[0] = 0;
+    for(uint32_t i = 0; i < beatSamples; i++){
+      beats[0] += beatDetectorUpdate(&directBeat, directPulse->read(), i * PULSE_PERIOD);
+    }
+  }, [&]{
+    BeatPipeline<ReplayPulseDriver> templatedBeat(pulse, &beatConfig);
+    beats[1] = 0;
+    for(uint32_t i = 0; i < beatSamples; i++){
+      beats[1] += templatedBeat.sample(i * PULSE_PERIOD);
+    }
+  }, [&]{
+    BeatDetector dynamicBeat;
+    beatDetectorInit(&dynamicBeat, &beatConfig);
+    beats[2] = 0;
+    for(uint32_t i = 0; i < beatSamples; i++){
+      beats[2] += beatDetectorUpdate(&dynamicBeat, virtualPulse->read(), i * PULSE_PERIOD);
+    }
+  }, beatNs);
+
+  printf("drivers   steps %.1f ns direct | %.1f ns template (%+.1f) | %.1f ns virtual, %u steps each over %u samples\n",
+         stepNs[0], stepNs[1], stepOverhead, stepNs[2], steps[0], stepSamples);
+  printf("drivers   beats %.1f ns direct | %.1f ns template (%+.1f) | %.1f ns virtual, %u updates each over %u samples\n",
+         beatNs[0], beatNs[1], beatOverhead, beatNs[2], beats[0], beatSamples);
+  check(steps[0] == steps[1] && steps[0] == steps[2], "same steps through every driver path");
+  check(beats[0] == beats[1] && beats[0] == beats[2], "same beats through every driver path");
+  check(stepOverhead <= fmax(stepNs[0] * DRIVER_TOLERANCE, DRIVER_TOLERANCE_NS), "step template as fast as the direct loop");
+  check(beatOverhead <= fmax(beatNs[0] * DRIVER_TOLERANCE, DRIVER_TOLERANCE_NS), "beat template as fast as the direct loop");
+
+  // a failed value keeps the last good one
+  const float envSamples[3][2] = {{23.5f, 51}, {NAN, 52}, {24.0f, NAN}};
+  ReplayEnvDriver env(envSamples, 3);
+  EnvCache<ReplayEnvDriver> cache(env);
+  uint8_t fresh[3];
+  for(uint8_t i = 0; i < 3; i++){
+    fresh[i] = cache.update();
+  }
+  check(fresh[0] == (ENV_FRESH_TEMPERATURE | ENV_FRESH_HUMIDITY) && fresh[1] == ENV_FRESH_HUMIDITY &&
+        fresh[2] == ENV_FRESH_TEMPERATURE && cache.temperature == 24.0f && cache.humidity == 52, "env cache");
+}
+
+#define PBM_BYTES (HAL_DISPLAY_WIDTH * HAL_DISPLAY_HEIGHT / 8)
+
+static bool writePbm(const char *path, const uint8_t *buffer){
+  FILE *file = fopen(path, "w");
+  if(file == NULL){
+    return false;
+  }
+  fprintf(file, "P1\n%u %u\n", HAL_DISPLAY_WIDTH, HAL_DISPLAY_HEIGHT);
+  for(uint8_t y = 0; y < HAL_DISPLAY_HEIGHT; y++){
+    for(uint8_t x = 0; x < HAL_DISPLAY_WIDTH; x++){
+      fputc(frameGetPixel(buffer, x, y) ? '1' : '0', file);
+    }
+    fputc('\n', file);
+  }
+  return fclose(file) == 0;
+}
+
+/*  Reads a 128x64 P1 image back into U8g2's tile layout, false when there is none or it doesn't parse  */
+static bool readPbm(const char *path, uint8_t *buffer){
+  FILE *file = fopen(path, "r");
+  if(file == NULL){
+    return false;
+  }
+  unsigned width = 0;
+  unsigned height = 0;
+  bool ok = fscanf(file, "P1 %u %u", &width, &height) == 2 && width == HAL_DISPLAY_WIDTH &&
+            height == HAL_DISPLAY_HEIGHT;
+  memset(buffer, 0, PBM_BYTES);
+  for(uint16_t i = 0; ok && i < HAL_DISPLAY_WIDTH * HAL_DISPLAY_HEIGHT; i++){
+    int pixel = ' ';
+    while(pixel == ' ' || pixel == '\n' || pixel == '\r' || pixel == '\t'){
+      pixel = fgetc(file);
+    }
+    ok = pixel == '0' || pixel == '1';
+    uint8_t x = i % HAL_DISPLAY_WIDTH;
+    uint8_t y = i / HAL_DISPLAY_WIDTH;
+    if(pixel == '1'){
+      buffer[(y / 8) * HAL_DISPLAY_WIDTH + x] |= 1 << (y % 8);
+    }
+  }
+  fclose(file);
+  return ok;
+}
+
+/*  Compares a render against its reference and says where they differ, a mismatch is also written
+ *  as <name>.actual.pbm next to the reference to look at. A screen without a reference yet is only
+ *  reported, recording one needs the real U8g2 package; one that is there but doesn't parse fails  */
+static void compareWithReference(const char *directory, const char *name, const uint8_t *buffer){
+  char path[256];
+  uint8_t reference[PBM_BYTES];
+  struct stat info;
+  snprintf(path, sizeof(path), "%s/%s.pbm", directory, name);
+  if(stat(path, &info) != 0){
+    printf("  not recorded: %s, record it with --record\n", path);
+    return;
+  }
+  if(!readPbm(path, reference)){
+    printf("  unreadable reference %s\n", path);
+    check(false, name);
+    return;
+  }
+
+  uint16_t differing = 0;
+  uint8_t left = HAL_DISPLAY_WIDTH, top = HAL_DISPLAY_HEIGHT, right = 0, bottom = 0;
+  for(uint8_t y = 0; y < HAL_DISPLAY_HEIGHT; y++){
+    for(uint8_t x = 0; x < HAL_DISPLAY_WIDTH; x++){
+      if(frameGetPixel(buffer, x, y) != frameGetPixel(reference, x, y)){
+        differing++;
+        left = x < left ? x : left;
+        right = x > right ? x : right;
+        top = y < top ? y : top;
+        bottom = y > bottom ? y : bottom;
+      }
+    }
+  }
+  if(differing > 0){
+    snprintf(path, sizeof(path), "%s/%s.actual.pbm", directory, name);
+    writePbm(path, buffer);
+    printf("  %u px differ in (%u,%u)-(%u,%u), see %s\n", differing, left, top, right, bottom, path);
+  }
+  check(differing == 0, name);
+}
+
+static FakePanel panel;
+static U8g2Display display(&panel.u8g2);
+static TimeText sampleTime = {"Sun, Jan 17 2021", "09:41:07", "AM"};
+static WeatherReport weather;
+static StepHistory history;
+static HealthSnapshot health;
+
+static void renderTime(){ screenRenderTime(display, &sampleTime, 0, false); }
+static void renderTimeEdit(){ screenRenderTime(display, &sampleTime, 3, true); }
+static void renderEnv(){ screenRenderEnv(display, 23.5f, 51); }
+static void renderPulse(){ screenRenderPulse(display, PULSE_BPM); }
+static void renderWeather(){ screenRenderWeather(display, &weather); }
+static void renderSteps(){ screenRenderSteps(display, 1234, "192.168.1.42"); }
+static void renderHistory(){ screenRenderHistory(display, &history); }
+static void renderHealth(){ screenRenderHealth(display, &health); }
+static void renderNoData(){ screenDrawNoDataYet(display, "Weather", "Waiting for WiFi..."); }
+
+static const struct{
+  const char *name;
+  void (*render)();
+}screens[] = {
+  {"time", renderTime},
+  {"time-edit-day", renderTimeEdit},
+  {"env", renderEnv},
+  {"pulse", renderPulse},
+  {"weather", renderWeather},
+  {"steps", renderSteps},
+  {"history", renderHistory},
+  {"health", renderHealth},
+  {"no-data", renderNoData},
+};
+
+/*  Renders every screen with U8g2 and diffs it against the reference image in `directory`,
+ *  or with `record` writes the references instead  */
+static void runScreens(const char *directory, bool record){
+  // a day of walking a little every hour
+  stepHistoryInit(&history, 0);
+  for(uint32_t minute = 0; minute < 24 * 60; minute += 10){
+    stepHistoryAdvance(&history, minute);
+    stepHistoryAddSteps(&history, minute, (minute / 60) % 7 * 40);
+  }
+
+  health.uptimeS = 3725;
+  health.heapFree = 182344;
+  health.heapMinFree = 171220;
+  health.heapLargestBlock = 110592;
+  health.cpuLoad[0] = 12;
+  health.cpuLoad[1] = 31;
+  health.taskCount = 1;
+  strcpy(health.tasks[0].name, "screenDisplay");
+  health.tasks[0].stackFree = 412;
+  health.queueCount = 1;
+  health.queues[0] = {"mpuData", 3, 4, 10};
+
+  uint8_t frames[sizeof(screens) / sizeof(screens[0])][PBM_BYTES];
+  for(uint8_t i = 0; i < sizeof(screens) / sizeof(screens[0]); i++){
+    double start = nowNs();
+    for(uint32_t repeat = 0; repeat < REPEATS; repeat++){
+      screens[i].render();
+    }
+    double ns = (nowNs() - start) / REPEATS;
+    memcpy(frames[i], display.buffer(), PBM_BYTES);
+    printf("screen    %-14s %6.0f ns/render\n", screens[i].name, ns);
+
+    if(record){
+      mkdir(directory, 0755);
+      char path[256];
+      snprintf(path, sizeof(path), "%s/%s.pbm", directory, screens[i].name);
+      check(writePbm(path, frames[i]), path);
+    }else{
+      compareWithReference(directory, screens[i].name, frames[i]);
+    }
+  }
+  // what only blinks has to show up even against a stale reference
+  check(memcmp(frames[0], frames[1], PBM_BYTES) != 0, "edited field blanked");
+}
+
+int main(int argc, char **argv){
+  bool record = argc > 1 && strcmp(argv[1], "--record") == 0;
+  const char *references = argc > 1 + record ? argv[1 + record] : REFERENCE_DIRECTORY;
+
+  runSteps();
+  runBeats();
+  runDrivers();
+  runTimeFormat();
+  runWeather(&weather);
+  runScreens(references, record);
+  runFrameDiff();
+  runInputEvents();
+  runGestures();
+  runSeries();
+  runTelemetry();
+  runLog();
+
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Gzips web/dashboard.html into lib/Dashboard/DashboardPage.h.
+
+The firmware serves the page straight from flash with Content-Encoding: gzip,
+rerun this after editing the page:
+
+    python3 tools/embed_web.py
+"""
+
+import gzip
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "web", "dashboard.html")
+TARGET = os.path.join(ROOT, "lib", "Dashboard", "DashboardPage.h")
+BYTES_PER_LINE = 16
+
+
+def main():
+    with open(SOURCE, "rb") as f:
+        page = f.read()
+
+    # mtime=0 keeps the output byte identical between runs
+    compressed = gzip.compress(page, compresslevel=9, mtime=0)
+
+    lines = []
+    for offset in range(0, len(compressed), BYTES_PER_LINE):
+        chunk = compressed[offset:offset + BYTES_PER_LINE]
+        lines.append("  " + ", ".join("0x%02x" % b for b in chunk) + ",")
+
+    header = (
+        "#pragma once\n"
+        "\n"
+        "#ifndef DASHBOARD_PAGE_H\n"
+        "#define DASHBOARD_PAGE_H\n"
+        "\n"
+        "/*  Generated by tools/embed_web.py from web/dashboard.html, do not edit  */\n"
+        "\n"
+        "#include <stdint.h>\n"
+        "#include <stddef.h>\n"
+        "\n"
+        "#define DASHBOARD_PAGE_RAW_LENGTH %d\n"
+        "\n"
+        "static const uint8_t dashboardPageGz[] = {\n"
+        "%s\n"
+        "};\n"
+        "\n"
+        "#endif\n"
+    ) % (len(page), "\n".join(lines))
+
+    with open(TARGET, "w") as f:
+        f.write(header)
+
+    print("%s: %d -> %d bytes" % (os.path.relpath(TARGET, ROOT), len(page), len(compressed)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
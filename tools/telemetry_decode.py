@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""Decodes the watch's binary telemetry stream into per-record-type files.
+
+The firmware switches its UART to COBS framed records when it receives 'b'
+(see lib/TelemetryStream/TelemetryFrame.h for the layout) and back to text on
+'t'. Capture straight from the board, stop with Ctrl-C:
+
+    python3 tools/telemetry_decode.py /dev/ttyUSB0 -o capture/
+
+or decode a raw capture taken some other way:
+
+    python3 tools/telemetry_decode.py capture.bin -o capture/
+
+Writes accel.csv, pulse.csv, dht.csv, events.csv and log.txt into the output
+directory, plus one .parquet per table with --parquet (needs pyarrow).
+Timestamps are the device's micros() unwrapped to 64 bits, in microseconds.
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+import time
+
+RECORD_ACCEL = 1
+RECORD_PULSE = 2
+RECORD_DHT = 3
+RECORD_EVENT = 4
+RECORD_LOG = 5
+RECORD_DROPPED = 6
+
+EVENT_NAMES = {1: "step", 2: "gesture", 3: "bpm"}
+
+HEADER = struct.Struct("<BI")
+ACCEL = struct.Struct("<hhh")
+PULSE = struct.Struct("<H")
+DHT = struct.Struct("<hH")
+EVENT = struct.Struct("<BH")
+DROPPED = struct.Struct("<I")
+
+ACCEL_LSB_PER_G = 2048.0
+MAX_FRAME = 512     # anything longer is line noise between two delimiters
+
+TABLES = {
+    "accel": ["t_us", "ax_g", "ay_g", "az_g"],
+    "pulse": ["t_us", "adc"],
+    "dht": ["t_us", "temp_c", "rh"],
+    "events": ["t_us", "kind", "value"],
+}
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, same as telemetryCrc16()."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        if code == 0 or index + code > len(data) + 1:
+            return None
+        out += data[index + 1:index + code]
+        index += code
+        if code < 0xFF and index < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Timebase:
+    """Unwraps the 32-bit microsecond counter, which wraps every ~71 minutes."""
+
+    def __init__(self):
+        self.last = None
+        self.high = 0
+
+    def unwrap(self, stamp):
+        # records from different tasks arrive slightly out of order, only a big jump back is a wrap
+        if self.last is not None and stamp < self.last and self.last - stamp > 0x80000000:
+            self.high += 1 << 32
+        elif self.last is not None and stamp > self.last and stamp - self.last > 0x80000000 and self.high:
+            return (self.high - (1 << 32)) + stamp
+        self.last = stamp
+        return self.high + stamp
+
+
+class Decoder:
+    def __init__(self, out_dir):
+        self.out_dir = out_dir
+        self.rows = {name: [] for name in TABLES}
+        self.logs = []
+        self.timebase = Timebase()
+        self.pending = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.framing_errors = 0
+        self.device_dropped = 0
+        self.first_us = None
+        self.last_us = None
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(b"\x00")
+            if end < 0:
+                if len(self.pending) > MAX_FRAME:
+                    self.framing_errors += 1
+                    self.pending.clear()
+                return
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if frame:
+                self.frame(frame)
+
+    def frame(self, encoded):
+        raw = cobs_decode(encoded) if len(encoded) <= MAX_FRAME else None
+        # text still in flight when the stream started is not an error
+        if raw is None or len(raw) < HEADER.size + 2:
+            self.framing_errors += self.frames > 0
+            return
+        body, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+        if crc16(body) != crc:
+            self.crc_errors += self.frames > 0
+            return
+
+        kind, stamp = HEADER.unpack_from(body)
+        payload = body[HEADER.size:]
+        t_us = self.timebase.unwrap(stamp)
+        self.frames += 1
+        if self.first_us is None:
+            self.first_us = t_us
+        self.last_us = t_us
+
+        try:
+            if kind == RECORD_ACCEL:
+                ax, ay, az = ACCEL.unpack(payload)
+                self.rows["accel"].append((t_us, ax / ACCEL_LSB_PER_G, ay / ACCEL_LSB_PER_G, az / ACCEL_LSB_PER_G))
+            elif kind == RECORD_PULSE:
+                self.rows["pulse"].append((t_us, PULSE.unpack(payload)[0]))
+            elif kind == RECORD_DHT:
+                temp, rh = DHT.unpack(payload)
+                self.rows["dht"].append((t_us, temp / 10.0, rh / 10.0))
+            elif kind == RECORD_EVENT:
+                event, value = EVENT.unpack(payload)
+                self.rows["events"].append((t_us, EVENT_NAMES.get(event, str(event)), value))
+            elif kind == RECORD_LOG:
+                self.logs.append("%d %s" % (t_us, payload.decode("utf-8", "replace")))
+            elif kind == RECORD_DROPPED:
+                self.device_dropped = DROPPED.unpack(payload)[0]
+        except struct.error:
+            self.framing_errors += 1
+
+    def write(self, parquet):
+        os.makedirs(self.out_dir, exist_ok=True)
+        for name, columns in TABLES.items():
+            with open(os.path.join(self.out_dir, name + ".csv"), "w", newline="") as f:
+                writer = csv.writer(f)
+                writer.writerow(columns)
+                writer.writerows(self.rows[name])
+        with open(os.path.join(self.out_dir, "log.txt"), "w") as f:
+            f.writelines(line + "\n" for line in self.logs)
+
+        if parquet:
+            import pyarrow
+            import pyarrow.parquet
+            for name, columns in TABLES.items():
+                data = list(zip(*self.rows[name])) or [[] for _ in columns]
+                table = pyarrow.table({column: list(values) for column, values in zip(columns, data)})
+                pyarrow.parquet.write_table(table, os.path.join(self.out_dir, name + ".parquet"))
+
+    def summary(self):
+        seconds = (self.last_us - self.first_us) / 1e6 if self.frames > 1 else 0.0
+        print("%d frames over %.1f s, %d CRC errors, %d framing errors, %d records dropped on the device"
+              % (self.frames, seconds, self.crc_errors, self.framing_errors, self.device_dropped), file=sys.stderr)
+        for name in TABLES:
+            count = len(self.rows[name])
+            rate = count / seconds if seconds > 0 else 0.0
+            print("  %-7s %8d  %7.1f /s" % (name, count, rate), file=sys.stderr)
+        print("  %-7s %8d" % ("log", len(self.logs)), file=sys.stderr)
+
+
+def open_tty(path, baud):
+    import termios
+    import tty
+
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attributes = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud)
+    attributes[4] = attributes[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attributes)
+    termios.tcflush(fd, termios.TCIFLUSH)
+    return fd
+
+
+def capture_tty(decoder, path, baud, duration):
+    fd = open_tty(path, baud)
+    os.write(fd, b"b")
+    deadline = time.monotonic() + duration if duration else None
+    try:
+        while deadline is None or time.monotonic() < deadline:
+            data = os.read(fd, 4096)
+            if data:
+                decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.write(fd, b"t")
+        os.close(fd)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("source", help="serial device, raw capture file, or - for stdin")
+    parser.add_argument("-o", "--out", default="telemetry", help="output directory (default: telemetry)")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("-d", "--duration", type=float, default=0, help="seconds to capture from a device, 0 until Ctrl-C")
+    parser.add_argument("--parquet", action="store_true", help="also write .parquet files (needs pyarrow)")
+    args = parser.parse_args()
+
+    decoder = Decoder(args.out)
+    if args.source == "-":
+        decoder.feed(sys.stdin.buffer.read())
+    elif os.path.exists(args.source) and not os.path.isfile(args.source):
+        capture_tty(decoder, args.source, args.baud, args.duration)
+    else:
+        with open(args.source, "rb") as f:
+            decoder.feed(f.read())
+
+    decoder.write(args.parquet)
+    decoder.summary()
+    return 0 if decoder.frames else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""Converts a trace dump from the watch into Chrome trace JSON.
+
+Build the firmware with -DTRACE_ENABLE (see platformio.ini), then either let
+the tool ask for a dump itself:
+
+    python3 tools/trace_to_chrome.py /dev/ttyUSB0 -o trace.json
+
+or cut it out of a saved serial log, after pressing 'd' in the monitor:
+
+    python3 tools/trace_to_chrome.py monitor.log -o trace.json
+
+Open the result in chrome://tracing or https://ui.perfetto.dev. The tool also
+prints the duration of every begin/end pair and the period of every instant
+event. For example, mpu.wake shows how late readMPU runs.
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+BEGIN_MARKER = "-----BEGIN TRACE-----"
+END_MARKER = "-----END TRACE-----"
+DUMP_COMMAND = b"d"
+WRAP = 1 << 32
+
+
+def read_tty(path, baud, timeout):
+    import termios
+    import tty
+
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    try:
+        tty.setraw(fd)
+        attributes = termios.tcgetattr(fd)
+        attributes[4] = attributes[5] = getattr(termios, "B%d" % baud)
+        termios.tcsetattr(fd, termios.TCSANOW, attributes)
+        termios.tcflush(fd, termios.TCIFLUSH)
+        os.write(fd, DUMP_COMMAND)
+
+        data = bytearray()
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            data += os.read(fd, 4096)
+            if END_MARKER.encode() in data:
+                break
+        return data.decode("utf-8", "replace")
+    finally:
+        os.close(fd)
+
+
+def last_dump(text):
+    """Lines of the last complete dump, log lines that slipped in between are skipped."""
+    dumps = []
+    current = None
+    for line in text.splitlines():
+        line = line.strip()
+        if line == BEGIN_MARKER:
+            current = []
+        elif line == END_MARKER and current is not None:
+            dumps.append(current)
+            current = None
+        elif current is not None and line[:2] in ("T ", "E "):
+            current.append(line)
+    return dumps[-1] if dumps else None
+
+
+def parse(lines):
+    tasks = {}
+    events = []
+    for line in lines:
+        fields = line.split(" ", 5)
+        if fields[0] == "T" and len(fields) >= 3:
+            tasks[fields[1]] = " ".join(fields[2:])
+        elif fields[0] == "E" and len(fields) == 6:
+            _, stamp, phase, core, task, name = fields
+            events.append({"ts": int(stamp), "ph": phase, "core": int(core), "task": task, "name": name})
+
+    # 32-bit microseconds wrap every ~71 minutes, a dump spans far less
+    if events:
+        newest = max(event["ts"] for event in events)
+        for event in events:
+            if newest - event["ts"] > WRAP // 2:
+                event["ts"] += WRAP
+        events.sort(key=lambda event: event["ts"])
+        start = events[0]["ts"]
+        for event in events:
+            event["ts"] -= start
+    return tasks, events
+
+
+def pair(events):
+    """Matches begin/end per task and name, ends whose begin was overwritten in the ring are dropped."""
+    open_slices = {}
+    slices = []
+    kept = []
+    for event in events:
+        key = (event["task"], event["name"])
+        if event["ph"] == "B":
+            open_slices.setdefault(key, []).append(event)
+            kept.append(event)
+        elif event["ph"] == "E":
+            if open_slices.get(key):
+                begin = open_slices[key].pop()
+                slices.append((event["name"], event["ts"] - begin["ts"]))
+                kept.append(event)
+        else:
+            kept.append(event)
+
+    # still open when the dump was taken: close them at the last event
+    end = events[-1]["ts"] if events else 0
+    for key, stack in open_slices.items():
+        for begin in stack:
+            kept.append({"ts": end, "ph": "E", "core": begin["core"], "task": key[0], "name": key[1]})
+    return kept, slices
+
+
+def chrome_json(tasks, events):
+    trace = [{"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "ESP32"}}]
+    tids = {}
+    for event in events:
+        if event["task"] not in tids:
+            tid = len(tids) + 1
+            tids[event["task"]] = tid
+            name = tasks.get(event["task"], event["task"])
+            trace.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}})
+
+    for event in events:
+        entry = {"name": event["name"], "ph": event["ph"], "ts": event["ts"], "pid": 1,
+                 "tid": tids[event["task"]], "args": {"core": event["core"]}}
+        if event["ph"] == "i":
+            entry["s"] = "t"
+        trace.append(entry)
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def summary(events, slices):
+    durations = {}
+    for name, duration in slices:
+        durations.setdefault(name, []).append(duration)
+    instants = {}
+    for event in events:
+        if event["ph"] == "i":
+            instants.setdefault(event["name"], []).append(event["ts"])
+
+    span = events[-1]["ts"] / 1e3 if events else 0
+    print("%d events over %.1f ms" % (len(events), span), file=sys.stderr)
+    print("  %-20s %6s %10s %10s %10s" % ("slice", "count", "avg us", "max us", "total us"), file=sys.stderr)
+    for name in sorted(durations):
+        values = durations[name]
+        print("  %-20s %6d %10.0f %10d %10d" % (name, len(values), sum(values) / len(values), max(values), sum(values)),
+              file=sys.stderr)
+    print("  %-20s %6s %10s %10s %10s" % ("instant", "count", "avg us", "min us", "max us"), file=sys.stderr)
+    for name in sorted(instants):
+        stamps = instants[name]
+        periods = [b - a for a, b in zip(stamps, stamps[1:])]
+        if periods:
+            print("  %-20s %6d %10.0f %10d %10d" % (name, len(stamps), sum(periods) / len(periods), min(periods),
+                  max(periods)), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("source", help="serial device, saved serial log, or - for stdin")
+    parser.add_argument("-o", "--out", default="trace.json")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("-t", "--timeout", type=float, default=30, help="seconds to wait for a dump from a device")
+    args = parser.parse_args()
+
+    if args.source == "-":
+        text = sys.stdin.read()
+    elif os.path.exists(args.source) and not os.path.isfile(args.source):
+        text = read_tty(args.source, args.baud, args.timeout)
+    else:
+        with open(args.source, errors="replace") as f:
+            text = f.read()
+
+    lines = last_dump(text)
+    if lines is None:
+        print("no complete %s ... %s block found" % (BEGIN_MARKER, END_MARKER), file=sys.stderr)
+        return 1
+
+    tasks, events = parse(lines)
+    events, slices = pair(events)
+    events.sort(key=lambda event: event["ts"])
+    with open(args.out, "w") as f:
+        json.dump(chrome_json(tasks, events), f)
+    summary(events, slices)
+    print("wrote %s" % args.out, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())